@@ -0,0 +1,26 @@
+#ifndef PHYSICS_ALLOCATION_COUNTER_H
+#define PHYSICS_ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+namespace physics
+{
+
+/**
+ * @return Number of heap allocations made by the whole program so far.
+ *
+ * @note Counting replaces the global operator new,
+ *       so it is only enabled when built with PHYSICS_COUNT_ALLOCATIONS.
+ *       Otherwise, this always returns 0.
+ */
+std::size_t HeapAllocationCount();
+
+/**
+ * @return True if built with PHYSICS_COUNT_ALLOCATIONS,
+ *         so that a count of 0 actually means no allocation.
+ */
+bool IsCountingHeapAllocations();
+
+} // namespace physics
+
+#endif // PHYSICS_ALLOCATION_COUNTER_H
@@ -22,6 +22,21 @@ inline Degree rad2deg(Radian angle)
     return angle * 180.0f / pi;
 }
 
+struct SinCos
+{
+    float sin;
+    float cos;
+};
+
+/**
+ * @return Sine and cosine of @p angle, which are bit-identical on every platform and compiler.
+ *
+ * @note The standard library leaves the precision of std::sin() and std::cos() to the platform,
+ *       so the same rotation could end up on slightly different positions.
+ *       This one only uses basic arithmetic, which is exact to the last bit under IEEE 754.
+ */
+SinCos DeterministicSinCos(Radian angle);
+
 } // namespace physics
 
 
@@ -0,0 +1,139 @@
+#ifndef PHYSICS_BENCH_REPORT_H
+#define PHYSICS_BENCH_REPORT_H
+
+#include "Profiler.h"
+#include "World.h"
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief Everything that decides how the stress scenes are run.
+ *        Two reports can only be compared if their settings are equal.
+ */
+struct BenchSettings
+{
+    int num_bodies = 1000;
+    int num_frames = 600;
+    int num_warmup_frames = 60;
+    int num_threads = 1;
+
+    // The sequential solver is a single pass of impulses, which can't hold a stack together,
+    // so the scenes are measured on the substepped solver unless asked otherwise.
+    bool use_substepping = true;
+    int num_substeps = 4;
+    PositionalCorrectionMode correction_mode = PositionalCorrectionMode::Direct;
+    int num_correction_iterations = 4;
+    int num_joint_iterations = 8;
+    bool deterministic = false;
+
+    bool operator==(const BenchSettings& other) const = default;
+};
+
+/**
+ * @brief Statistics of a time in milliseconds over every measured frame.
+ */
+struct TimeSummary
+{
+    double average_ms = 0.0;
+    double median_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+/**
+ * @brief The measurements of a single stress scene.
+ */
+struct SceneResult
+{
+    std::string name;
+    int num_objects = 0;
+    int num_springs = 0;
+    double seconds = 0.0;
+    double steps_per_second = 0.0;
+
+    // The whole World::Step(), measured by the benchmark itself.
+    TimeSummary step;
+
+    // Indexed by StepPhase. Only filled when World::Stats() is enabled.
+    bool has_phases = false;
+    std::array<TimeSummary, num_step_phases> phases{};
+
+    // Counters of the last frame.
+    StepCounters counters;
+
+    // Heap allocations of every measured frame, if BenchReport::counts_allocations.
+    std::uint64_t heap_allocations = 0;
+
+    // Heap allocations of despawning every object and spawning it again after the measured frames,
+    // if BenchReport::counts_allocations.
+    std::uint64_t respawn_heap_allocations = 0;
+
+    // High-water mark of the process, or 0 if the platform doesn't report it.
+    std::uint64_t peak_memory_bytes = 0;
+
+    // World::StateHash() after the last frame, which only matches between runs of deterministic worlds.
+    std::uint64_t state_hash = 0;
+};
+
+struct BenchReport
+{
+    BenchSettings settings;
+
+    // False if the library was built without PHYSICS_COUNT_ALLOCATIONS.
+    bool counts_allocations = false;
+
+    std::vector<SceneResult> scenes;
+};
+
+/**
+ * @return The statistics of @p samples, which are reordered.
+ *
+ * @note Uses the same percentile as StepProfiler::Stats().
+ */
+TimeSummary Summarize(std::vector<float>& samples);
+
+/**
+ * @brief Write @p report as JSON, which can be read back by ReadBenchReport().
+ */
+void WriteBenchReport(std::ostream& out, const BenchReport& report);
+
+/**
+ * @return The report written by WriteBenchReport(), or nothing if @p in isn't one.
+ */
+std::optional<BenchReport> ReadBenchReport(std::istream& in);
+
+/**
+ * @brief Thresholds of CompareBenchReports().
+ */
+struct RegressionLimits
+{
+    // A median may grow by this fraction before it counts as a regression, e.g., 0.1 for 10%.
+    double tolerance = 0.1;
+
+    // Differences below this are noise, however large the fraction.
+    // Phases of a small scene take a few microseconds, which is below the resolution of a busy machine.
+    double min_difference_ms = 0.02;
+};
+
+/**
+ * @brief Compare the median step and phase times and the heap allocations of each scene
+ *        in @p current against @p baseline, and print the differences to @p out.
+ *
+ * @return The number of regressions, which are medians slower than the limits allow
+ *         and allocations above the baseline.
+ *
+ * @warning Both reports must have the same settings.
+ */
+int CompareBenchReports(const BenchReport& baseline, const BenchReport& current, const RegressionLimits& limits, std::ostream& out);
+
+} // namespace physics
+
+#endif // PHYSICS_BENCH_REPORT_H
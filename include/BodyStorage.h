@@ -0,0 +1,153 @@
+#ifndef PHYSICS_BODY_STORAGE_H
+#define PHYSICS_BODY_STORAGE_H
+
+#include "Transform.h"
+#include <limits>
+#include <vector>
+
+namespace physics
+{
+
+// Forward declaration for the owner list.
+class Rigidbody;
+
+/**
+ * @brief Parameters of the bulk integration in BodyStorage.
+ *
+ * @see World::ConfigureGravity(), World::ConfigureDamping(), World::ConfigureMaxVelocity()
+ */
+struct IntegrationParameters
+{
+    Vec3 gravity;
+    float linear_damping = 0.0f;
+    float angular_damping = 0.0f;
+    float max_linear_speed = std::numeric_limits<float>::infinity();
+    float max_angular_speed = std::numeric_limits<float>::infinity();
+};
+
+/**
+ * @brief A single row of BodyStorage as plain data,
+ *        kept by a Rigidbody while it doesn't belong to any World.
+ */
+struct BodyRow
+{
+    physics::Transform transform;
+
+    // Angular quantities only use the z-axis.
+    // @see DoF
+    Vec3 linear_velocity;
+    Vec3 angular_velocity;
+    Vec3 linear_acceleration;
+    Vec3 angular_acceleration;
+    Vec3 linear_pseudo_velocity;
+    Vec3 angular_pseudo_velocity;
+
+    float inv_mass = 0.0f;
+    float inv_inertia = 0.0f;
+};
+
+/**
+ * @brief BodyStorage keeps the dynamic state of rigidbodies
+ *        as a structure of arrays, indexed by a dense body index.
+ *
+ * @note Integration only touches a few of these arrays,
+ *       so keeping each property contiguous lets the loops stream through memory
+ *       instead of visiting every Rigidbody and its collider.
+ *
+ * @note Position and rotation are kept together as a Transform,
+ *       since every reader of one needs the other as well.
+ *
+ * @see Rigidbody, World
+ */
+struct BodyStorage
+{
+    /**
+     * @brief Append @p row, which is viewed by @p owner.
+     * @return The index of the new row.
+     */
+    int Append(Rigidbody* owner, const BodyRow& row);
+
+    /**
+     * @brief Remove the row at @p index by moving the last row into it.
+     * @return The owner of the row moved into @p index,
+     *         or nullptr if the removed row was the last one.
+     */
+    Rigidbody* SwapRemove(int index);
+
+    /**
+     * @return A copy of the row at @p index, except for the owner.
+     */
+    BodyRow Row(int index) const;
+
+    int Size() const;
+
+    /**
+     * @brief Allocate every array for @p capacity rows at once.
+     */
+    void Reserve(int capacity);
+
+    /**
+     * @brief Exchange the rows at @p first and @p second, including the owners.
+     */
+    void SwapRows(int first, int second);
+
+    /**
+     * @return True if the row at @p index has infinite mass and inertia.
+     * @see Rigidbody::IsStatic()
+     */
+    bool IsStaticRow(int index) const;
+
+    /**
+     * @brief Explicit Euler integration of velocity and position, which also consumes the pseudo velocity,
+     *        applied to the rows in range [@p begin, @p end).
+     *
+     * @note Static rows are expected to be partitioned out of the range by the caller,
+     *       so the loops never branch on the mass.
+     *       Gravity is masked by the inverse mass instead, for rows that only lock the position.
+     */
+    void IntegrateVelocities(int begin, int end, const Vec3& gravity, float delta_time);
+    void IntegratePositions(int begin, int end, float delta_time);
+
+    /**
+     * @brief Clear the accelerations, then damp and clamp the velocities.
+     *
+     * @note The whole update of a row is fused into a single loop,
+     *       which updates four rows at once with SSE2 on x86-64.
+     *       Other targets run the same operations one row at a time, which gives bit-identical results.
+     */
+    void FinishVelocities(int begin, int end, const IntegrationParameters& params);
+
+    /**
+     * @brief Same as IntegratePositions() followed by IntegrateVelocities() and FinishVelocities(),
+     *        but streams through the velocities only once.
+     */
+    void Integrate(int begin, int end, const IntegrationParameters& params, float delta_time);
+
+    /**
+     * @brief Same as Rigidbody::GlobalVelocity() and Rigidbody::ApplyInstantImpulse(),
+     *        for solvers that work on body indices instead of Rigidbody.
+     */
+    Vec3 GlobalVelocity(int index, const Vec3& rel_pos) const;
+    void ApplyInstantImpulse(int index, const Vec3& rel_impact_pos, const Vec3& impulse);
+
+    std::vector<physics::Transform> transforms;
+
+    // Angular quantities only use the z-axis.
+    // @see DoF
+    std::vector<Vec3> linear_velocities;
+    std::vector<Vec3> angular_velocities;
+    std::vector<Vec3> linear_accelerations;
+    std::vector<Vec3> angular_accelerations;
+    std::vector<Vec3> linear_pseudo_velocities;
+    std::vector<Vec3> angular_pseudo_velocities;
+
+    std::vector<float> inv_masses;
+    std::vector<float> inv_inertias;
+
+    // The Rigidbody viewing each row.
+    std::vector<Rigidbody*> owners;
+};
+
+} // namespace physics
+
+#endif // PHYSICS_BODY_STORAGE_H
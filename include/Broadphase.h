@@ -0,0 +1,50 @@
+#ifndef PHYSICS_BROADPHASE_H
+#define PHYSICS_BROADPHASE_H
+
+#include "FrameArena.h"
+#include "Transform.h"
+#include <cstdint>
+#include <span>
+
+namespace physics
+{
+
+/**
+ * @brief BodyPair is a candidate for collision detection,
+ *        identified by the indices of two bodies in BodyStorage.
+ *
+ * @note 'first' is always smaller than 'second'.
+ */
+struct BodyPair
+{
+    int first;
+    int second;
+
+    /**
+     * @return A key which orders pairs the same way as a nested loop over (first, second).
+     */
+    std::uint64_t Key() const
+    {
+        return (std::uint64_t(first) << 32) | std::uint32_t(second);
+    }
+};
+
+/**
+ * @brief Find every pair of bodies whose bounding circles overlap
+ *        along both axes, using sort and sweep on the x-axis.
+ *
+ * @param transforms Position of each body.
+ * @param radii Boundary radius of each body's collider, in the same order.
+ * @param arena Memory of the result. It stays valid until the arena is reset.
+ *
+ * @return Candidate pairs sorted by BodyPair::Key().
+ *
+ * @note A pair missing here would have been rejected by
+ *       Rigidbody::IsOutOfBoundaryRadius() anyway,
+ *       so the narrowphase gives the same result as testing every pair.
+ */
+std::span<BodyPair> FindCandidatePairs(std::span<const physics::Transform> transforms, std::span<const float> radii, FrameArena& arena);
+
+} // namespace physics
+
+#endif // PHYSICS_BROADPHASE_H
@@ -2,7 +2,6 @@
 #define PHYSICS_CIRCLE_H
 
 #include "ICollider.h"
-#include "SFML/Graphics/CircleShape.hpp"
 
 namespace physics
 {
@@ -19,16 +18,14 @@ public:
     virtual bool IsPointInside(const Vec3& local_point) const override;
     virtual float Area() const override;
     virtual Vec3 CenterOfMass() const override;
-
-    virtual sf::Shape& SFMLShape() override;
-    virtual const sf::Shape& SFMLShape() const override;
+    virtual std::shared_ptr<ICollider> Clone() const override;
 
     virtual std::optional<CollisionInfo> CheckCollision(const ICollider* other) const override;
     virtual std::optional<CollisionInfo> CheckCollisionAccept(const Circle* other) const override;
     virtual std::optional<CollisionInfo> CheckCollisionAccept(const ConvexPolygon* other) const override;
     
 private:
-    sf::CircleShape m_shape;
+    float m_radius;
 };
 
 } // namespace physics
@@ -0,0 +1,65 @@
+#ifndef PHYSICS_COMMAND_QUEUE_H
+#define PHYSICS_COMMAND_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace physics
+{
+
+class World;
+
+/**
+ * @brief CommandQueue passes edits of a World, such as spawning an object,
+ *        from the thread handling input to the thread simulating the world.
+ *
+ * @note A bounded ring buffer for a single producer and a single consumer.
+ *       Neither side ever takes a lock:
+ *       the producer only writes the tail, and the consumer only writes the head.
+ *
+ * @see SimulationThread::Submit()
+ */
+class CommandQueue
+{
+public:
+    using Command = std::function<void(World&)>;
+
+    /**
+     * @param capacity The maximum number of commands waiting to be run, which must be positive.
+     */
+    explicit CommandQueue(std::size_t capacity = 1024);
+
+    /**
+     * @brief Append @p command, waiting for the consumer while the queue is full.
+     * @warning Only a single thread may push at a time.
+     */
+    void Push(Command command);
+
+    /**
+     * @brief Same as above, but gives up instead of waiting.
+     * @return False if the queue was full, in which case @p command is left untouched.
+     */
+    bool TryPush(Command& command);
+
+    /**
+     * @brief Run every command pushed so far on @p world, in the order they were pushed.
+     * @return The number of commands run.
+     *
+     * @warning Only a single thread may drain at a time.
+     */
+    int Drain(World& world);
+
+private:
+    std::vector<Command> m_commands;
+
+    // Both count every command ever pushed or popped, and wrap around the capacity on access.
+    // Kept on separate cache lines, since each is written by a different thread.
+    alignas(64) std::atomic<std::size_t> m_head = 0;
+    alignas(64) std::atomic<std::size_t> m_tail = 0;
+};
+
+} // namespace physics
+
+#endif // PHYSICS_COMMAND_QUEUE_H
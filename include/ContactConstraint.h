@@ -0,0 +1,205 @@
+#ifndef PHYSICS_CONTACT_CONSTRAINT_H
+#define PHYSICS_CONTACT_CONSTRAINT_H
+
+#include "FrameArena.h"
+#include "Rigidbody.h"
+#include "Softness.h"
+#include <array>
+#include <optional>
+#include <span>
+
+namespace physics
+{
+
+/**
+ * @brief Solver state of a single contact point.
+ */
+struct ContactPointConstraint
+{
+    // The contact point expressed in each object's local coordinate system.
+    // Since these move along with the objects, we can recompute
+    // the separation after each substep without running collision detection again.
+    Vec3 local_anchor1;
+    Vec3 local_anchor2;
+
+    // Displacement of the contact point from each object's center,
+    // in global coordinate, at the moment the collision was detected.
+    Vec3 rel_anchor1;
+    Vec3 rel_anchor2;
+
+    // Signed distance along the normal at the moment of detection.
+    // Negative value means that the objects are overlapping.
+    float base_separation;
+
+    // Effective mass along the normal and tangent direction,
+    // which is the amount of impulse required to change the relative velocity by 1.
+    float normal_mass;
+    float tangent_mass;
+
+    // Accumulated impulses over all iterations of the current time step.
+    float normal_impulse = 0.0f;
+    float tangent_impulse = 0.0f;
+
+    // Relative normal velocity before the collision was resolved.
+    // Used for restitution.
+    float relative_velocity;
+
+    // Accumulated impulse of positional correction.
+    // @see ContactConstraint::SolvePseudoVelocity()
+    float pseudo_impulse = 0.0f;
+};
+
+/**
+ * @brief ContactBlockMatrix couples the normal impulses of a two-point contact.
+ *        Element kij is the change of relative normal velocity
+ *        on point i caused by a unit impulse on point j.
+ *
+ * @note Solving two points one after another makes the second point undo
+ *       the rotation caused by the first one, which is visible as rocking.
+ *       Solving both at once gives the exact answer in a single pass.
+ */
+struct ContactBlockMatrix
+{
+    ContactBlockMatrix(
+        const Rigidbody* object1,
+        const Rigidbody* object2,
+        const std::array<Vec3, 2>& rel_anchors1,
+        const std::array<Vec3, 2>& rel_anchors2,
+        const Vec3& normal
+    );
+
+    /**
+     * @return False if the two points are nearly redundant (e.g., almost on the same spot),
+     *         in which case the inverse matrix is numerically unreliable.
+     */
+    bool IsWellConditioned() const;
+
+    /**
+     * @brief Solve the linear complementarity problem
+     *        "find x >= 0 such that w = K * x + c >= 0 and x_i * w_i = 0",
+     *        which describes two impulses that can only push
+     *        and become zero on a separating point.
+     *
+     * @return Empty if the problem had no solution,
+     *         which only happens when the matrix is ill-conditioned.
+     */
+    std::optional<std::array<float, 2>> Solve(float c1, float c2) const;
+
+    float k11;
+    float k12;
+    float k22;
+};
+
+/**
+ * @brief ContactConstraint is the solver representation of a CollisionPair
+ *        used by the substepped solver.
+ *
+ * @see World::UpdateSubstepped()
+ */
+struct ContactConstraint
+{
+    ContactConstraint(const CollisionPair& collision);
+
+    /**
+     * @brief Apply the impulses accumulated so far, so that
+     *        the next substep starts from the previous solution.
+     */
+    void WarmStart();
+
+    /**
+     * @brief Perform a single iteration of non-penetration and friction constraints.
+     *
+     * @param softness Softness used to push overlapping objects apart.
+     * @param inv_time_step Inverse of the substep size.
+     * @param penetration_allowance The overlap allowed for simulation stability.
+     * @param max_push_velocity Upper limit of the separating velocity caused by position error.
+     * @param use_bias False when relaxing the velocity after position integration.
+     *                 In this case, position error is ignored and
+     *                 no velocity remains to push the objects apart.
+     */
+    void Solve(const Softness& softness, float inv_time_step, float penetration_allowance, float max_push_velocity, bool use_bias);
+
+    /**
+     * @brief Apply Newton's law of restitution on contact points
+     *        that were approaching faster than @p threshold.
+     *
+     * @note This should be called once after all substeps are finished.
+     */
+    void ApplyRestitution(float threshold);
+
+    /**
+     * @brief Perform a single iteration of positional correction using pseudo velocities.
+     *
+     * @param inv_time_step Inverse of the time step used to integrate the pseudo velocities.
+     * @param penetration_allowance The overlap allowed for simulation stability.
+     * @param correction_ratio The amount of overlap to be removed in this time step.
+     *
+     * @note Only non-static objects are written, so constraints that do not
+     *       share a non-static object can be solved concurrently.
+     *
+     * @see Rigidbody::ApplyPseudoImpulse(), PartitionIntoBatches()
+     */
+    void SolvePseudoVelocity(float inv_time_step, float penetration_allowance, float correction_ratio);
+
+    Rigidbody* object1;
+    Rigidbody* object2;
+
+    // Direction from object1 to object2.
+    Vec3 normal;
+
+    // Average material of the two objects.
+    MaterialProperties material;
+
+    FixedVector<ContactPointConstraint, max_contact_points> points;
+
+    // Only used for contacts with exactly two points.
+    std::optional<ContactBlockMatrix> block;
+
+private:
+    /**
+     * @brief Solve the non-penetration constraint of both points at once.
+     *
+     * @return False if the block solver failed,
+     *         in which case nothing is applied and the caller should fall back
+     *         to solving the points one after another.
+     */
+    bool SolveNormalBlock(const std::array<float, 2>& biases, const std::array<float, 2>& mass_scales, const std::array<float, 2>& impulse_scales);
+};
+
+/**
+ * @brief ContactBatches lists the constraints of each batch in a single flat array.
+ *
+ * @see PartitionIntoBatches()
+ */
+struct ContactBatches
+{
+    int Count() const;
+
+    /**
+     * @return Indices of the constraints in the batch @p batch.
+     */
+    std::span<const int> Batch(int batch) const;
+
+    // Indices of the constraints, grouped by batch.
+    std::span<int> indices;
+
+    // Batch i consists of 'indices' in range [offsets[i], offsets[i + 1]).
+    std::span<int> offsets;
+};
+
+/**
+ * @brief Group the constraints into batches where no two constraints
+ *        of the same batch share a non-static object.
+ *        Constraints within a batch can then be solved in parallel without any lock.
+ *
+ * @param num_bodies Number of rows of the BodyStorage the objects belong to.
+ * @param arena Memory of the result. It stays valid until the arena is reset.
+ *
+ * @note Batches are filled greedily in the order of @p constraints,
+ *       so the result is deterministic.
+ */
+ContactBatches PartitionIntoBatches(std::span<const ContactConstraint> constraints, int num_bodies, FrameArena& arena);
+
+} // namespace physics
+
+#endif // PHYSICS_CONTACT_CONSTRAINT_H
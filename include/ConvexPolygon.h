@@ -2,8 +2,8 @@
 #define PHYSICS_CONVEX_POLYGON_H
 
 #include "ICollider.h"
-#include "LineSegment.h"
-#include "SFML/Graphics/ConvexShape.hpp"
+#include "PolygonGeometry.h"
+#include <memory>
 #include <vector>
 
 namespace physics
@@ -70,7 +70,10 @@ struct Penetration
  * @warning Constructor can fail if given vertices do not represent
  *          a convex polygon, or the order of them was not counter-clockwise.
  * 
- * @note Due to the fact that SFML uses (0, 0) as the top-left corner,
+ * @note The shape itself is a PolygonGeometry shared among identical polygons,
+ *       while each instance only owns its transform.
+ * 
+ * @note Due to the fact that the screen uses (0, 0) as the top-left corner,
  *       a ConvexPolygon will appear as if it has a clockwise ordering of vertices.
  */
 class ConvexPolygon : public ICollider
@@ -82,20 +85,25 @@ public:
      */
     ConvexPolygon(const std::vector<Vec3>& vertices);
 
+    /**
+     * @brief Share the @p geometry with other polygons.
+     * @see ShapeCache::Polygon()
+     */
+    ConvexPolygon(std::shared_ptr<const PolygonGeometry> geometry);
+
     virtual float BoundaryRadius() const override;
     virtual bool IsPointInside(const Vec3& local_point) const override;
     virtual float Area() const override;
     virtual Vec3 CenterOfMass() const override;
-
-    virtual sf::Shape& SFMLShape() override;
-    virtual const sf::Shape& SFMLShape() const override;
+    virtual std::shared_ptr<ICollider> Clone() const override;
 
     virtual std::optional<CollisionInfo> CheckCollision(const ICollider* other) const override;
     virtual std::optional<CollisionInfo> CheckCollisionAccept(const Circle* other) const override;
     virtual std::optional<CollisionInfo> CheckCollisionAccept(const ConvexPolygon* other) const override;
 
-    const std::vector<Vec3>& Vertices() const;
-    const std::vector<LineSegment>& Edges() const;
+    const PooledVector<Vec3>& Vertices() const;
+    const PooledVector<LineSegment>& Edges() const;
+    const std::shared_ptr<const PolygonGeometry>& Geometry() const;
 
     /**
      * @brief Find the vertices that give maximum or minumum projection
@@ -127,19 +135,7 @@ public:
     LineSegment FindMostParallelCollisionEdge(const Vec3& global_dir, int involved_vertex_index) const;
     
 private:
-    /**
-     * @brief Throw exception if the order of vertices is not counter-clockwise.
-     */
-    void ValidateCounterClockwiseOrder() const;
-
-    std::vector<Vec3> m_vertices;
-    std::vector<LineSegment> m_edges;
-
-    // SFML representation.
-    sf::ConvexShape m_shape;
-
-    float m_boundary_radius = 0.0f;
-    Vec3 m_center_of_mass = {};
+    std::shared_ptr<const PolygonGeometry> m_geometry;
 };
 
 } // namespace physics
@@ -0,0 +1,83 @@
+#ifndef PHYSICS_FIXED_VECTOR_H
+#define PHYSICS_FIXED_VECTOR_H
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+namespace physics
+{
+
+/**
+ * @brief FixedVector is a vector with inline storage of @p Capacity elements.
+ *
+ * @note Used for small lists created on every time step, such as contact points,
+ *       so that creating them never touches the heap.
+ */
+template<typename T, std::size_t Capacity>
+class FixedVector
+{
+public:
+    void push_back(const T& value)
+    {
+        assert(m_size < Capacity);
+        m_values[m_size++] = value;
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        assert(m_size < Capacity);
+        return m_values[m_size++] = T{std::forward<Args>(args)...};
+    }
+
+    void clear()
+    {
+        m_size = 0;
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    T& operator[](std::size_t index)
+    {
+        assert(index < m_size);
+        return m_values[index];
+    }
+
+    const T& operator[](std::size_t index) const
+    {
+        assert(index < m_size);
+        return m_values[index];
+    }
+
+    T& back()
+    {
+        return (*this)[m_size - 1];
+    }
+
+    const T& back() const
+    {
+        return (*this)[m_size - 1];
+    }
+
+    T* begin() { return m_values.data(); }
+    T* end() { return m_values.data() + m_size; }
+    const T* begin() const { return m_values.data(); }
+    const T* end() const { return m_values.data() + m_size; }
+
+private:
+    std::array<T, Capacity> m_values{};
+    std::size_t m_size = 0;
+};
+
+} // namespace physics
+
+#endif // PHYSICS_FIXED_VECTOR_H
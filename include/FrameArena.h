@@ -0,0 +1,94 @@
+#ifndef PHYSICS_FRAME_ARENA_H
+#define PHYSICS_FRAME_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief FrameArena is a linear allocator for data that lives
+ *        only during a single time step, such as solver constraints.
+ *
+ * @note Allocation is a pointer bump, and everything is released at once by Reset().
+ *       Destructors are never called, so only trivially destructible types are allowed.
+ *
+ * @note When a step needed more than one block, the blocks are merged
+ *       into a single larger block on Reset().
+ *       Therefore, a simulation in steady state stops allocating after a few steps.
+ */
+class FrameArena
+{
+public:
+    /**
+     * @note The first block is small, so that a small world stays small.
+     *       Larger worlds grow it within their first few steps.
+     */
+    explicit FrameArena(std::size_t initial_capacity = 4 * 1024);
+
+    /**
+     * @return Uninitialized memory of @p size bytes aligned to @p alignment.
+     */
+    void* Allocate(std::size_t size, std::size_t alignment);
+
+    /**
+     * @return Uninitialized storage for @p count elements of type @p T.
+     *         The elements must be constructed before use, e.g., with std::construct_at().
+     */
+    template<typename T>
+    std::span<T> AllocateArray(std::size_t count);
+
+    /**
+     * @brief Release everything allocated since the last Reset().
+     */
+    void Reset();
+
+    /**
+     * @return The number of bytes allocated since the last Reset().
+     */
+    std::size_t BytesUsed() const;
+
+    /**
+     * @return The total size of all blocks.
+     */
+    std::size_t Capacity() const;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> memory;
+        std::size_t size;
+    };
+
+    void AddBlock(std::size_t min_size);
+
+    std::vector<Block> m_blocks;
+
+    // Offset of the next allocation inside m_blocks.back().
+    std::size_t m_offset = 0;
+
+    // Bytes used by the blocks other than m_blocks.back().
+    std::size_t m_bytes_in_previous_blocks = 0;
+};
+
+template<typename T>
+std::span<T> FrameArena::AllocateArray(std::size_t count)
+{
+    static_assert(std::is_trivially_destructible_v<T>, "FrameArena never calls destructors");
+
+    if (count == 0)
+    {
+        return {};
+    }
+
+    auto* memory = Allocate(sizeof(T) * count, alignof(T));
+    return {static_cast<T*>(memory), count};
+}
+
+} // namespace physics
+
+#endif // PHYSICS_FRAME_ARENA_H
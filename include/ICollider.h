@@ -1,17 +1,24 @@
 #ifndef PHYSICS_I_COLLIDER_H
 #define PHYSICS_I_COLLIDER_H
 
-#include "SFML/Graphics/Shape.hpp"
 #include "Transform.h"
+#include "FixedVector.h"
+#include <cstddef>
+#include <memory>
 #include <optional>
 
 namespace physics
 {
 
+/**
+ * @brief Two convex shapes in 2D touch each other on at most two points.
+ */
+constexpr std::size_t max_contact_points = 2;
+
 struct CollisionInfo
 {
     // Global coordinate of points where collision occurred.
-    std::vector<Vec3> contacts;
+    FixedVector<Vec3, max_contact_points> contacts;
 
     // Normalized vector perpendicular to the collision edge.
     // This is the direction where "this" object must move
@@ -22,6 +29,11 @@ struct CollisionInfo
 
     // Minimal distance required to separate two objects.
     float penetration_depth;
+
+    // Penetration depth measured at each point of 'contacts' (same order).
+    // Unlike 'penetration_depth', which is shared by the whole collision,
+    // this tells how deep each individual point is inside the other object.
+    FixedVector<float, max_contact_points> contact_depths;
 };
 
 // Forward declarations for ICollider::CheckCollisionAccept().
@@ -31,7 +43,7 @@ class ConvexPolygon;
 /**
  * @brief ICollider is an interface for all colliders.
  *        It provides transform, collision detection,
- *        an SFML shape for rendering, and some utility functions
+ *        and some utility functions
  *        for transforming vectors and edges between
  *        global and local coordinate system.
  * 
@@ -75,10 +87,10 @@ public:
     virtual Vec3 CenterOfMass() const = 0;
 
     /**
-     * @return The SFML representation of this collider.
+     * @return A copy of this collider with its own transform.
+     * @note Immutable shape data, such as PolygonGeometry, is shared with the copy.
      */
-    virtual sf::Shape& SFMLShape() = 0;
-    virtual const sf::Shape& SFMLShape() const = 0;
+    virtual std::shared_ptr<ICollider> Clone() const = 0;
 
     /**
      * @brief Return collision information if any.
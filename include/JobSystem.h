@@ -0,0 +1,203 @@
+#ifndef PHYSICS_JOB_SYSTEM_H
+#define PHYSICS_JOB_SYSTEM_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief JobSystem runs jobs on a fixed pool of threads with work stealing.
+ *
+ * @note Every thread has its own queue.
+ *       A thread takes the newest job of its own queue first,
+ *       and steals the oldest job of another queue when its own is empty.
+ *       A thread waiting for jobs to finish runs other jobs in the meantime,
+ *       so jobs can wait for jobs without blocking a thread.
+ *
+ * @note Threads outside the pool, such as the one that created it,
+ *       share the queue of thread index 0.
+ *
+ * @note Scheduling a parallel loop never touches the heap.
+ *
+ * @see World::ConfigureJobSystem()
+ */
+class JobSystem
+{
+public:
+    /**
+     * @brief A job submitted with Submit(), which other jobs can depend on.
+     */
+    struct Task;
+    using TaskHandle = std::shared_ptr<Task>;
+
+    /**
+     * @param num_threads The number of threads running jobs, including the caller.
+     *                    1 spawns no thread and runs everything on the caller.
+     */
+    explicit JobSystem(int num_threads);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * @return A single-threaded instance shared by every user,
+     *         which runs everything on the calling thread.
+     *
+     * @note The default of World, so that a small world owns neither threads nor queues.
+     */
+    static std::shared_ptr<JobSystem> Serial();
+
+    int ThreadCount() const;
+
+    /**
+     * @return The index of the calling thread in range [0, ThreadCount()).
+     *         Threads outside the pool get 0.
+     *
+     * @note Used to pick per-thread scratch memory, such as World's thread arenas.
+     *
+     * @warning Several threads outside the pool may run jobs at the same time, e.g., while waiting in Wait(),
+     *          so scratch memory of index 0 must be guarded against concurrent use.
+     */
+    int ThreadIndex() const;
+
+    /**
+     * @brief Invoke @p func(i) for every i in range [0, @p count),
+     *        split into @p num_chunks contiguous jobs, and wait for all of them.
+     *
+     * @note The caller runs jobs while waiting, starting with the first chunk.
+     *
+     * @warning @p func must be safe to run concurrently for different indices.
+     */
+    template<typename Func>
+    void ParallelFor(int count, int num_chunks, Func&& func);
+
+    /**
+     * @brief Run @p function as a job once every task in @p dependencies has finished.
+     *
+     * @note Useful to run World::Step() next to other jobs of the caller,
+     *       while the parallel loops inside the step share the same threads.
+     */
+    TaskHandle Submit(std::function<void()> function, std::span<const TaskHandle> dependencies = {});
+
+    /**
+     * @brief Run jobs until @p task has finished.
+     */
+    void Wait(const TaskHandle& task);
+
+private:
+    struct Job
+    {
+        void (*function)(void* context, int index);
+        void* context;
+        int index;
+    };
+
+    /**
+     * @brief Bounded double-ended queue of a single thread.
+     *        The owner works on the back, and thieves on the front.
+     */
+    struct WorkQueue
+    {
+        static constexpr std::size_t capacity = 4096;
+
+        std::mutex mutex;
+        std::array<Job, capacity> jobs;
+        std::size_t front = 0;
+        std::size_t size = 0;
+    };
+
+    /**
+     * @brief Put @p job on the queue of the calling thread,
+     *        or run it right away if the queue is full.
+     */
+    void Schedule(const Job& job);
+
+    /**
+     * @brief Run a single job, either from the calling thread's queue or stolen from another.
+     * @return False if every queue was empty.
+     */
+    bool TryRunJob();
+
+    /**
+     * @brief Run jobs until @p remaining drops to zero.
+     */
+    void WaitForZero(const std::atomic<int>& remaining);
+
+    void WorkerLoop(std::stop_token stop_token, int thread_index);
+
+    static void RunTask(void* context, int index);
+    void ReleaseDependency(const TaskHandle& task);
+
+    // One queue per thread, including the one shared by threads outside the pool.
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+    // The number of jobs in all queues, so that idle workers know when to wake up.
+    std::atomic<int> m_num_queued = 0;
+    std::mutex m_sleep_mutex;
+    std::condition_variable_any m_wake;
+
+    // Declared last, so that workers are joined before anything else is destroyed.
+    std::vector<std::jthread> m_workers;
+};
+
+template<typename Func>
+void JobSystem::ParallelFor(int count, int num_chunks, Func&& func)
+{
+    num_chunks = std::clamp(num_chunks, 1, std::max(count, 1));
+    if (num_chunks == 1 || ThreadCount() == 1)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            func(i);
+        }
+        return;
+    }
+
+    // Lives on the stack of the caller, who waits until every chunk is done.
+    struct Context
+    {
+        std::remove_reference_t<Func>* func;
+        int count;
+        int chunk_size;
+        std::atomic<int> remaining;
+    };
+    const auto chunk_size = (count + num_chunks - 1) / num_chunks;
+    num_chunks = (count + chunk_size - 1) / chunk_size;
+    auto context = Context{&func, count, chunk_size, num_chunks};
+
+    const auto run_chunk = [](void* context_ptr, int chunk) {
+        auto& context = *static_cast<Context*>(context_ptr);
+        const auto begin = chunk * context.chunk_size;
+        const auto end = std::min(begin + context.chunk_size, context.count);
+        for (int i = begin; i < end; ++i)
+        {
+            (*context.func)(i);
+        }
+        context.remaining.fetch_sub(1, std::memory_order_acq_rel);
+    };
+
+    // Pushed in reverse, so that the caller continues with the second chunk
+    // while thieves take the last ones.
+    for (int chunk = num_chunks - 1; chunk > 0; --chunk)
+    {
+        Schedule(Job{run_chunk, &context, chunk});
+    }
+    run_chunk(&context, 0);
+    WaitForZero(context.remaining);
+}
+
+} // namespace physics
+
+#endif // PHYSICS_JOB_SYSTEM_H
@@ -0,0 +1,184 @@
+#ifndef PHYSICS_JOINT_H
+#define PHYSICS_JOINT_H
+
+#include "Spring.h"
+#include "Softness.h"
+
+namespace physics
+{
+
+/**
+ * @brief Identifier returned by World::AddJoint(),
+ *        used to modify or remove the joint later.
+ */
+using JointId = int;
+
+/**
+ * @brief Time step information shared by all joints during a (sub)step.
+ */
+struct JointSolverContext
+{
+    float time_step;
+    float inv_time_step;
+
+    // Softness used to remove position error of rigid joints.
+    Softness softness;
+};
+
+/**
+ * @brief Restricts a joint coordinate (distance, angle, or translation)
+ *        within the range [lower, upper].
+ */
+struct JointLimit
+{
+    bool enabled = false;
+    float lower = 0.0f;
+    float upper = 0.0f;
+
+    // Accumulated impulses of each bound.
+    float lower_impulse = 0.0f;
+    float upper_impulse = 0.0f;
+};
+
+/**
+ * @brief Drives a joint coordinate with constant speed
+ *        using force (or torque) up to max_force.
+ */
+struct JointMotor
+{
+    bool enabled = false;
+    float speed = 0.0f;
+    float max_force = 0.0f;
+
+    // Accumulated impulse.
+    float impulse = 0.0f;
+};
+
+/**
+ * @brief DistanceJoint keeps the distance between two anchor points.
+ *
+ * @note With positive @p hertz, it behaves like a spring
+ *       whose stiffness is folded into the effective mass of the constraint,
+ *       which stays stable regardless of the stiffness.
+ *       The limit still applies as a rigid constraint.
+ */
+struct DistanceJoint
+{
+    AnchorPoint start;
+    AnchorPoint end;
+    float length;
+
+    // Zero means a rigid rod.
+    float hertz = 0.0f;
+    float damping_ratio = 0.0f;
+
+    // Limit and motor along the line connecting the anchors.
+    JointLimit limit;
+    JointMotor motor;
+
+    void WarmStart();
+    void Solve(const JointSolverContext& context, bool use_bias);
+
+    JointId id = -1;
+    float impulse = 0.0f;
+};
+
+/**
+ * @brief RevoluteJoint pins two anchor points together,
+ *        allowing relative rotation only.
+ */
+struct RevoluteJoint
+{
+    AnchorPoint start;
+    AnchorPoint end;
+
+    // The relative rotation (end - start) considered as zero angle.
+    Radian reference_angle = 0.0f;
+
+    // Limit and motor on the relative rotation.
+    JointLimit limit;
+    JointMotor motor;
+
+    void WarmStart();
+    void Solve(const JointSolverContext& context, bool use_bias);
+
+    JointId id = -1;
+    Vec3 linear_impulse;
+};
+
+/**
+ * @brief WeldJoint glues two objects together.
+ *
+ * @note Zero frequency means a rigid weld.
+ *       Positive values make the weld flexible.
+ */
+struct WeldJoint
+{
+    AnchorPoint start;
+    AnchorPoint end;
+    Radian reference_angle = 0.0f;
+
+    float linear_hertz = 0.0f;
+    float linear_damping_ratio = 0.0f;
+    float angular_hertz = 0.0f;
+    float angular_damping_ratio = 0.0f;
+
+    void WarmStart();
+    void Solve(const JointSolverContext& context, bool use_bias);
+
+    JointId id = -1;
+    Vec3 linear_impulse;
+    float angular_impulse = 0.0f;
+};
+
+/**
+ * @brief PrismaticJoint allows relative translation along an axis only,
+ *        like a piston in a cylinder.
+ */
+struct PrismaticJoint
+{
+    AnchorPoint start;
+    AnchorPoint end;
+
+    // Direction of translation, in the local coordinate system of start.object.
+    Vec3 local_axis;
+    Radian reference_angle = 0.0f;
+
+    // Limit and motor on the translation along the axis.
+    JointLimit limit;
+    JointMotor motor;
+
+    void WarmStart();
+    void Solve(const JointSolverContext& context, bool use_bias);
+
+    JointId id = -1;
+
+    // x: perpendicular to the axis, y: angular.
+    Vec3 impulse;
+};
+
+/**
+ * @brief MouseJoint pulls a point on an object towards the target
+ *        like a damped spring, with limited force.
+ *
+ * @see ObjectDragger
+ */
+struct MouseJoint
+{
+    AnchorPoint anchor;
+    Vec3 target;
+
+    float hertz = 5.0f;
+    float damping_ratio = 0.7f;
+    float max_force = 0.0f;
+
+    void WarmStart();
+    void Solve(const JointSolverContext& context);
+
+    JointId id = -1;
+    Vec3 impulse;
+};
+
+} // namespace physics
+
+#endif // PHYSICS_JOINT_H
@@ -0,0 +1,176 @@
+#ifndef PHYSICS_JOINT_STORAGE_H
+#define PHYSICS_JOINT_STORAGE_H
+
+#include "Joint.h"
+#include <unordered_map>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief JointStorage keeps every joint of a World,
+ *        with one contiguous array per joint type.
+ *
+ * @note Joints of the same type are solved together in a tight loop
+ *       without any virtual dispatch, which is the reason
+ *       we don't have a common base class for joints.
+ *
+ * @note Like SpringStorage, every body knows the joints connected to it by its index in BodyStorage,
+ *       so removing a body only visits its own joints.
+ *       Removing a joint moves the last joint of the same type into its place.
+ *
+ * @note Unlike springs, a joint stays a single struct which is solved through its Rigidbody anchors.
+ *       Each solve reads and writes almost every field of one joint,
+ *       and there are few joints compared to springs, so splitting the fields wouldn't save any memory traffic.
+ *       The body indices only serve the bookkeeping, so they are kept with the identifier of the joint.
+ */
+class JointStorage
+{
+public:
+    /**
+     * @brief Add a joint and assign a new identifier to it.
+     * @return The identifier used to find or remove the joint later.
+     *
+     * @note The anchors must be objects of the World, whose BodyIndex() is up to date.
+     */
+    JointId Add(DistanceJoint joint);
+    JointId Add(RevoluteJoint joint);
+    JointId Add(WeldJoint joint);
+    JointId Add(PrismaticJoint joint);
+    JointId Add(MouseJoint joint);
+
+    /**
+     * @brief Remove the joint with the specified identifier, if it exists.
+     */
+    void Remove(JointId id);
+
+    /**
+     * @brief Remove every joint connected to @p body.
+     */
+    void RemoveJointsOnBody(int body);
+
+    /**
+     * @brief Let the joints of the body at @p from know it moved to @p to,
+     *        which must not have any joint.
+     *
+     * @see BodyStorage::SwapRemove()
+     */
+    void MoveBody(int from, int to);
+
+    /**
+     * @brief Let the joints of two bodies know they swapped their indices.
+     */
+    void SwapBodies(int first, int second);
+
+    /**
+     * @return The joint with the specified identifier,
+     *         or nullptr if there is no such joint of type @p T.
+     */
+    template<typename T>
+    T* Find(JointId id);
+
+    /**
+     * @brief Apply the accumulated impulses of all joints.
+     */
+    void WarmStart();
+
+    /**
+     * @brief Perform a single iteration over all joints.
+     *
+     * @param use_bias False when relaxing the velocity after position integration.
+     *
+     * @see ContactConstraint::Solve()
+     */
+    void Solve(const JointSolverContext& context, bool use_bias);
+
+    /**
+     * @brief Reset the accumulated impulses of all joints, so that nothing is warm started.
+     */
+    void ClearImpulses();
+
+    bool IsEmpty() const;
+
+    const std::vector<DistanceJoint>& DistanceJoints() const;
+    const std::vector<RevoluteJoint>& RevoluteJoints() const;
+    const std::vector<WeldJoint>& WeldJoints() const;
+    const std::vector<PrismaticJoint>& PrismaticJoints() const;
+    const std::vector<MouseJoint>& MouseJoints() const;
+
+private:
+    enum class JointType
+    {
+        distance,
+        revolute,
+        weld,
+        prismatic,
+        mouse
+    };
+
+    /**
+     * @brief Where a joint is stored, and the indices of its bodies.
+     *
+     * @note body2 is -1 for mouse joints, which are attached to a single body.
+     */
+    struct JointSlot
+    {
+        JointType type;
+        int index;
+        int body1;
+        int body2;
+    };
+
+    template<typename T>
+    std::vector<T>& Array();
+
+    template<typename T>
+    static constexpr JointType TypeOf();
+
+    template<typename T>
+    JointId Append(T& joint, int body1, int body2);
+
+    /**
+     * @brief Move the last joint of type @p T into @p index,
+     *        and detach the removed one from its bodies.
+     */
+    template<typename T>
+    void SwapRemove(int index);
+
+    std::vector<DistanceJoint> m_distance_joints;
+    std::vector<RevoluteJoint> m_revolute_joints;
+    std::vector<WeldJoint> m_weld_joints;
+    std::vector<PrismaticJoint> m_prismatic_joints;
+    std::vector<MouseJoint> m_mouse_joints;
+
+    std::unordered_map<JointId, JointSlot> m_slots;
+    std::vector<std::vector<JointId>> m_joints_of_body;
+
+    JointId m_next_id = 0;
+};
+
+template<typename T>
+T* JointStorage::Find(JointId id)
+{
+    const auto it = m_slots.find(id);
+    if (it == m_slots.end() || it->second.type != TypeOf<T>())
+    {
+        return nullptr;
+    }
+    return &Array<T>()[it->second.index];
+}
+
+template<> inline std::vector<DistanceJoint>& JointStorage::Array() { return m_distance_joints; }
+template<> inline std::vector<RevoluteJoint>& JointStorage::Array() { return m_revolute_joints; }
+template<> inline std::vector<WeldJoint>& JointStorage::Array() { return m_weld_joints; }
+template<> inline std::vector<PrismaticJoint>& JointStorage::Array() { return m_prismatic_joints; }
+template<> inline std::vector<MouseJoint>& JointStorage::Array() { return m_mouse_joints; }
+
+template<> constexpr JointStorage::JointType JointStorage::TypeOf<DistanceJoint>() { return JointType::distance; }
+template<> constexpr JointStorage::JointType JointStorage::TypeOf<RevoluteJoint>() { return JointType::revolute; }
+template<> constexpr JointStorage::JointType JointStorage::TypeOf<WeldJoint>() { return JointType::weld; }
+template<> constexpr JointStorage::JointType JointStorage::TypeOf<PrismaticJoint>() { return JointType::prismatic; }
+template<> constexpr JointStorage::JointType JointStorage::TypeOf<MouseJoint>() { return JointType::mouse; }
+
+} // namespace physics
+
+#endif // PHYSICS_JOINT_STORAGE_H
@@ -2,46 +2,51 @@
 #define PHYSICS_OBJECT_DRAGGER_H
 
 #include "IMouseAction.h"
-#include "World.h"
+#include "SimulationThread.h"
 
 namespace physics
 {
 
 /**
  * @brief Handles picking an object in the scene with mouse
- *        and applying force towards the cursor.
+ *        and pulling it towards the cursor with a MouseJoint.
+ *
+ * @note Objects are picked on the latest snapshot,
+ *       and the mouse joint is edited through commands run by the simulation.
  */
 class ObjectDragger : public IMouseAction
 {
 public:
-    ObjectDragger(std::shared_ptr<World> world);
+    ObjectDragger(std::shared_ptr<SimulationThread> simulation);
 
     virtual std::string Description() const override;
     virtual std::string Tooltip() const override;
 
     /**
-     * @brief Try to pick an object under the cursor.
+     * @brief Try to pick an object under the cursor,
+     *        and attach a mouse joint on the picked point.
      * 
      * @note Static objects are ignored.
      */
     virtual void OnMouseClick(const Vec3& mouse_pos) override;
 
     /**
-     * @brief Update drag vector, which will be the direction of force.
+     * @brief Update drag vector and the target of the mouse joint.
      */
     virtual void OnMouseDown(const Vec3& mouse_pos) override;
 
     /**
-     * @brief Reset picked object to null.
+     * @brief Reset picked object to null and remove the mouse joint.
      */
     virtual void OnMouseRelease(const Vec3& mouse_pos) override;
 
     /**
-     * @brief Pull the selected object towards the cursor.
+     * @brief Change how strongly the selected object is pulled towards the cursor.
      * 
-     * @warning This should be called only when IsObjectSelected() is true.
+     * @param drag_strength The maximum acceleration of the picked object,
+     *                      relative to the default value.
      */
-    void ApplyDraggingForce(float drag_strength, float time_step);
+    void ConfigureDragStrength(float drag_strength);
 
     /**
      * @brief Test if an object is currently being dragged towards the cursor.
@@ -63,10 +68,14 @@ public:
     Vec3 DragVector() const;
 
 private:
-    std::shared_ptr<World> m_world;
-    std::shared_ptr<Rigidbody> m_picked_object;
+    std::shared_ptr<SimulationThread> m_simulation;
+    BodyHandle m_picked_body;
     Vec3 m_picked_offset;
     Vec3 m_drag_vector;
+    float m_drag_strength = 1.0f;
+
+    // Only accessed by the commands, i.e., by the thread running the simulation.
+    JointId m_mouse_joint = -1;
 };
 
 } // namespace physics
@@ -2,7 +2,8 @@
 #define PHYSICS_POLYGON_DRAWER_H
 
 #include "IMouseAction.h"
-#include "World.h"
+#include "ShapeCache.h"
+#include "SimulationThread.h"
 
 namespace physics
 {
@@ -11,11 +12,13 @@ class PolygonDrawer : public IMouseAction
 {
 public:
     /**
+     * @param shape_cache Shares the geometry of identical polygons.
+     *                    Only used by the simulation, which spawns the drawn polygons.
      * @param draw_finish_distance The maximum distance from the first vertex to the latest vertex
      *                             required to finish drawing and try to create a rigidbody.
      *                             Any point within this radius from the first vertex is considered the last vertex.
      */
-    PolygonDrawer(std::shared_ptr<World> world, float draw_finish_distance = 20.0f);
+    PolygonDrawer(std::shared_ptr<SimulationThread> simulation, std::shared_ptr<ShapeCache> shape_cache, float draw_finish_distance = 20.0f);
 
     virtual std::string Description() const override;
     virtual std::string Tooltip() const override;
@@ -32,7 +35,8 @@ private:
     void AppendVertex(const Vec3& vertex);
     void ClearVertices();
 
-    std::shared_ptr<World> m_world;
+    std::shared_ptr<SimulationThread> m_simulation;
+    std::shared_ptr<ShapeCache> m_shape_cache;
     float m_draw_finish_distance;
 
     // List of all clicked points, which will construct a polygon.
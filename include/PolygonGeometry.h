@@ -0,0 +1,69 @@
+#ifndef PHYSICS_POLYGON_GEOMETRY_H
+#define PHYSICS_POLYGON_GEOMETRY_H
+
+#include "LineSegment.h"
+#include "PoolAllocator.h"
+#include <span>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief PolygonGeometry is the immutable shape of a ConvexPolygon,
+ *        expressed in the polygon's local coordinate system.
+ *
+ * @note Everything here is computed once on construction and never changes,
+ *       so a single instance can be shared by every polygon of the same shape.
+ *       Only the pose is stored per object.
+ *
+ * @see ShapeCache for sharing instances.
+ */
+class PolygonGeometry
+{
+public:
+    /**
+     * @warning The order of @p vertices must be counter-clockwise!
+     *          If not, an exception will be thrown.
+     */
+    explicit PolygonGeometry(const std::vector<Vec3>& vertices);
+
+    /**
+     * @return False if the constructor would throw on @p vertices,
+     *         e.g., to validate untrusted input beforehand.
+     */
+    static bool IsCounterClockwise(std::span<const Vec3> vertices);
+
+    const PooledVector<Vec3>& Vertices() const;
+
+    /**
+     * @note edges[i] goes from vertices[i] to vertices[i + 1],
+     *       and already has its normal vector computed.
+     */
+    const PooledVector<LineSegment>& Edges() const;
+
+    float Area() const;
+    Vec3 CenterOfMass() const;
+
+    /**
+     * @return The distance to the farthest vertex from the local origin.
+     */
+    float BoundaryRadius() const;
+
+private:
+    /**
+     * @brief Throw exception if the order of vertices is not counter-clockwise.
+     */
+    void ValidateCounterClockwiseOrder() const;
+
+    PooledVector<Vec3> m_vertices;
+    PooledVector<LineSegment> m_edges;
+
+    float m_area = 0.0f;
+    Vec3 m_center_of_mass = {};
+    float m_boundary_radius = 0.0f;
+};
+
+} // namespace physics
+
+#endif // PHYSICS_POLYGON_GEOMETRY_H
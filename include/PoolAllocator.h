@@ -0,0 +1,133 @@
+#ifndef PHYSICS_POOL_ALLOCATOR_H
+#define PHYSICS_POOL_ALLOCATOR_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief SizeClassPool hands out small blocks of memory from large chunks,
+ *        keeping a free list for each size class.
+ *
+ * @note Objects created and destroyed over and over, such as bodies and their shapes,
+ *       reuse the same blocks instead of going through the general-purpose heap.
+ *
+ * @see PoolAllocator
+ */
+class SizeClassPool
+{
+public:
+    /**
+     * @brief Blocks larger than this are forwarded to the global operator new.
+     */
+    static constexpr std::size_t max_block_size = 512;
+
+    /**
+     * @brief Every block is aligned at least to this.
+     */
+    static constexpr std::size_t block_alignment = 16;
+
+    /**
+     * @return The pool shared by the whole program.
+     */
+    static SizeClassPool& Instance();
+
+    void* Allocate(std::size_t size);
+    void Deallocate(void* memory, std::size_t size);
+
+private:
+    static constexpr std::size_t num_size_classes = 6;
+    static constexpr std::size_t chunk_size = 64 * 1024;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    /**
+     * @return Index of the smallest size class that fits @p size, which is one of 16, 32, ..., 512 bytes.
+     */
+    static std::size_t SizeClass(std::size_t size);
+
+    /**
+     * @brief Split a new chunk into blocks of the size class @p size_class.
+     */
+    void Refill(std::size_t size_class);
+
+    std::array<FreeBlock*, num_size_classes> m_free_lists{};
+    std::vector<std::unique_ptr<std::byte[]>> m_chunks;
+
+    // Bodies may be created from other threads than the simulation.
+    std::mutex m_mutex;
+};
+
+/**
+ * @brief Standard allocator backed by SizeClassPool::Instance().
+ */
+template<typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(std::size_t count)
+    {
+        if constexpr (alignof(T) > SizeClassPool::block_alignment)
+        {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{alignof(T)}));
+        }
+        else
+        {
+            return static_cast<T*>(SizeClassPool::Instance().Allocate(count * sizeof(T)));
+        }
+    }
+
+    void deallocate(T* memory, std::size_t count)
+    {
+        if constexpr (alignof(T) > SizeClassPool::block_alignment)
+        {
+            ::operator delete(memory, std::align_val_t{alignof(T)});
+        }
+        else
+        {
+            SizeClassPool::Instance().Deallocate(memory, count * sizeof(T));
+        }
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U>&) const
+    {
+        return true;
+    }
+};
+
+/**
+ * @brief std::vector whose buffer comes from SizeClassPool.
+ */
+template<typename T>
+using PooledVector = std::vector<T, PoolAllocator<T>>;
+
+/**
+ * @brief Same as std::make_shared(), but the object and its reference count
+ *        are allocated from SizeClassPool.
+ */
+template<typename T, typename... Args>
+std::shared_ptr<T> MakePooled(Args&&... args)
+{
+    return std::allocate_shared<T>(PoolAllocator<T>{}, std::forward<Args>(args)...);
+}
+
+} // namespace physics
+
+#endif // PHYSICS_POOL_ALLOCATOR_H
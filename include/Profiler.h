@@ -0,0 +1,176 @@
+#ifndef PHYSICS_PROFILER_H
+#define PHYSICS_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace physics
+{
+
+/**
+ * @brief Phases of a single fixed step, timed by StepProfiler.
+ *
+ * @note FixedStep covers the whole step, including the other phases.
+ */
+enum class StepPhase
+{
+    Broadphase,
+    Narrowphase,
+    ResolveCollisions,
+    Update,
+    UpdateSubstepped,
+    FixedStep
+};
+
+constexpr int num_step_phases = 6;
+
+/**
+ * @return A human-readable name of @p phase.
+ */
+const char* PhaseName(StepPhase phase);
+
+/**
+ * @brief Timing of a single phase over the last StepProfiler::window_size fixed steps,
+ *        in milliseconds. Steps which skipped the phase count as zero.
+ */
+struct PhaseStats
+{
+    float last_ms = 0.0f;
+    float average_ms = 0.0f;
+    float max_ms = 0.0f;
+    float p99_ms = 0.0f;
+};
+
+/**
+ * @brief Amount of work done by a single fixed step.
+ */
+struct StepCounters
+{
+    // Pairs whose bounding boxes overlap, found by the broadphase.
+    std::uint64_t candidate_pairs = 0;
+
+    // Pairs that passed the bounding circle test and reached the collider.
+    std::uint64_t narrowphase_tests = 0;
+
+    // Edge normals projected by the separating axis test of polygons.
+    std::uint64_t sat_axes = 0;
+
+    // Contact points over all collisions.
+    std::uint64_t contacts = 0;
+
+    // Iterations or substeps of every solver, e.g., joint iterations plus split impulse iterations.
+    std::uint64_t solver_iterations = 0;
+
+    // Objects which are integrated. Every dynamic object is awake, since nothing sleeps yet.
+    std::uint64_t awake_bodies = 0;
+};
+
+/**
+ * @brief Counters incremented deep inside collision detection.
+ *        Every thread has its own, so the narrowphase can count without synchronization.
+ *
+ * @note They only grow, so the user takes the difference before and after the work.
+ */
+struct NarrowphaseCounters
+{
+    std::uint64_t narrowphase_tests = 0;
+    std::uint64_t sat_axes = 0;
+};
+
+/**
+ * @return The counters of the calling thread.
+ */
+NarrowphaseCounters& LocalNarrowphaseCounters();
+
+/**
+ * @brief StepProfiler keeps the time spent on each phase of the last few fixed steps,
+ *        along with the counters of the last step.
+ *
+ * @note Nothing here allocates. Samples live in a fixed ring buffer.
+ *
+ * @see World::Stats()
+ */
+class StepProfiler
+{
+public:
+    /**
+     * @brief The number of fixed steps the statistics are taken over.
+     */
+    static constexpr int window_size = 256;
+
+    /**
+     * @brief Add @p milliseconds spent on @p phase during the current step.
+     */
+    void AddTime(StepPhase phase, float milliseconds);
+
+    /**
+     * @return Counters of the current step.
+     */
+    StepCounters& Counters();
+
+    /**
+     * @brief Record the current step, and start a new one.
+     */
+    void EndStep();
+
+    /**
+     * @return The number of steps in the window, up to window_size.
+     */
+    int NumSamples() const;
+
+    /**
+     * @note Takes time proportional to window_size, so don't call it inside the step.
+     */
+    PhaseStats Stats(StepPhase phase) const;
+
+    /**
+     * @return Counters of the last step recorded by EndStep().
+     */
+    const StepCounters& LastCounters() const;
+
+private:
+    std::array<float, num_step_phases> m_current_times{};
+    std::array<std::array<float, window_size>, num_step_phases> m_samples{};
+    int m_num_samples = 0;
+    int m_next_sample = 0;
+
+    StepCounters m_current_counters;
+    StepCounters m_last_counters;
+};
+
+/**
+ * @brief Add the lifetime of this instance to a phase of StepProfiler,
+ *        and record it to Tracer::Global() if tracing is enabled.
+ */
+class ScopedPhaseTimer
+{
+public:
+    ScopedPhaseTimer(StepProfiler& profiler, StepPhase phase);
+    ~ScopedPhaseTimer();
+
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+private:
+    StepProfiler& m_profiler;
+    StepPhase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace physics
+
+// Timers and counters are only compiled in when PHYSICS_PROFILE is defined,
+// so that a build without profiling doesn't even read the clock.
+#ifdef PHYSICS_PROFILE
+#define PHYSICS_PROFILE_CONCAT_INNER(a, b) a##b
+#define PHYSICS_PROFILE_CONCAT(a, b) PHYSICS_PROFILE_CONCAT_INNER(a, b)
+#define PHYSICS_PROFILE_SCOPE(profiler, phase) \
+    const auto PHYSICS_PROFILE_CONCAT(profile_scope_, __LINE__) = ::physics::ScopedPhaseTimer((profiler), (phase))
+#define PHYSICS_PROFILE_ONLY(...) __VA_ARGS__
+#else
+#define PHYSICS_PROFILE_SCOPE(profiler, phase)
+#define PHYSICS_PROFILE_ONLY(...)
+#endif
+
+#endif // PHYSICS_PROFILER_H
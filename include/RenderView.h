@@ -0,0 +1,53 @@
+#ifndef PHYSICS_RENDER_VIEW_H
+#define PHYSICS_RENDER_VIEW_H
+
+#include "SFML/Graphics/RenderTarget.hpp"
+#include "SFML/Graphics/Shape.hpp"
+#include "WorldSnapshot.h"
+#include <memory>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief RenderView keeps an SFML shape for each rigidbody of a World,
+ *        so that the simulation itself never depends on the graphics library.
+ *
+ * @note Objects are drawn from a WorldSnapshot, so the world may be stepped on another thread.
+ *
+ * @note Shapes are created lazily and only moved when a frame is drawn,
+ *       no matter how many time steps were simulated in between.
+ */
+class RenderView
+{
+public:
+    /**
+     * @brief Draw every object of @p snapshot on its interpolated transform.
+     *
+     * @see SimulationThread::AcquireSnapshot()
+     */
+    void Draw(const WorldSnapshot& snapshot, sf::RenderTarget& target);
+
+private:
+    /**
+     * @return A new SFML shape that looks like @p collider in its local coordinate.
+     */
+    static std::unique_ptr<sf::Shape> CreateShape(const ICollider& collider);
+
+    struct Entry
+    {
+        BodyHandle handle;
+        std::unique_ptr<sf::Shape> shape;
+    };
+
+    /**
+     * @brief Shapes indexed by BodyHandle::slot.
+     * @note A stale entry is replaced once its slot is reused by another object.
+     */
+    std::vector<Entry> m_entries;
+};
+
+} // namespace physics
+
+#endif // PHYSICS_RENDER_VIEW_H
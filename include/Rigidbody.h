@@ -2,6 +2,7 @@
 #define PHYSICS_RIGIDBODY_H
 
 #include "ICollider.h"
+#include "BodyStorage.h"
 #include "Vec3.h"
 #include "LineSegment.h"
 #include "Angle.h"
@@ -100,7 +101,12 @@ struct CollisionPair
  * @note Collision resolution is handled by World class,
  *       using information from rigidbodies.
  * 
- * @note Rigidbody uses Transform of its collider.
+ * @note Rigidbody is a view of a single row in a BodyStorage.
+ *       A standalone rigidbody keeps its row as plain data,
+ *       and moves it into the world's storage on World::AddObject().
+ *
+ * @note The transform of the collider is only a copy
+ *       used for collision detection, which is synchronized by World::CheckCollisions().
  */
 class Rigidbody
 {
@@ -112,6 +118,10 @@ public:
         float inertia
     );
 
+    // The storage keeps a pointer to this instance.
+    Rigidbody(const Rigidbody&) = delete;
+    Rigidbody& operator=(const Rigidbody&) = delete;
+
     ICollider* Collider();
     const ICollider* Collider() const;
 
@@ -124,6 +134,45 @@ public:
     const Vec3& LinearVelocity() const;
     const Vec3& AngularVelocity() const;
 
+    /**
+     * @brief Overwrite the velocity, e.g., to restart a scene.
+     *        Use impulses to interact with the simulation instead.
+     */
+    void SetLinearVelocity(const Vec3& velocity);
+    void SetAngularVelocity(const Vec3& velocity);
+
+    /**
+     * @return The row of this object in BodyStorage, or -1 if it doesn't belong to any World.
+     * 
+     * @note The index changes whenever another object is removed from the same storage.
+     */
+    int BodyIndex() const;
+
+    /**
+     * @brief Move the state of this object into @p storage,
+     *        and view the new row from now on.
+     * 
+     * @note Called by World::AddObject() and World::RemoveObject().
+     */
+    void MoveToStorage(BodyStorage& storage);
+
+    /**
+     * @brief Exchange the rows of this object and @p other, which share the same storage.
+     * 
+     * @note Called by World to keep static objects at the front of the storage.
+     */
+    void SwapStorageRow(Rigidbody& other);
+
+    /**
+     * @brief Move the state of this object out of its storage, and keep it as plain data.
+     */
+    void Detach();
+
+    /**
+     * @brief Copy the transform into the collider, which is used for collision detection.
+     */
+    void SyncColliderTransform();
+
     float InverseMass() const;
     float InverseInertia() const;
 
@@ -146,6 +195,14 @@ public:
     */
     Vec3 GlobalVelocity(const Vec3& local_pos) const;
 
+    /**
+     * @return The pseudo velocity of a point inside this rigidbody
+     *         expressed in global coordinate system.
+     * 
+     * @see Rigidbody::ApplyPseudoImpulse()
+     */
+    Vec3 GlobalPseudoVelocity(const Vec3& local_pos) const;
+
     /**
      * @note @p new_mass should not be negative.
      */
@@ -156,6 +213,15 @@ public:
      */
     void SetInertia(float new_inertia);
 
+    /**
+     * @brief Same as above, but takes the inverse, which is what the object keeps.
+     *        Zero is infinite, e.g., to restore a saved object bit by bit.
+     *
+     * @note Both values should not be negative.
+     */
+    void SetInverseMass(float inv_mass);
+    void SetInverseInertia(float inv_inertia);
+
     /**
      * @brief Make the object immutable to external force.
      *        This is identical to giving infinite mass and inertia.
@@ -196,39 +262,75 @@ public:
     void ApplyImpulse(const Vec3& rel_impact_pos, const Vec3& impulse, float delta_time);
 
     /**
-     * @brief Reduce the linear and angular velocity by given factor.
+     * @brief Immediately change linear and angular velocity by the @p impulse vector.
+     * 
+     * @note Unlike ApplyImpulse(), which spreads the impulse over the next time step
+     *       as an acceleration, the effect is visible right away.
+     *       This is what iterative solvers need, since each iteration
+     *       must see the velocity changed by the previous one.
+     * 
+     * @warning Same as ApplyImpulse(), @p rel_impact_pos and @p impulse should be global!
+     */
+    void ApplyInstantImpulse(const Vec3& rel_impact_pos, const Vec3& impulse);
+
+    /**
+     * @brief Immediately change angular velocity by a pure angular impulse (i.e., torque * time).
      * 
-     * @note Damping helps stabilizing simulation with lots of external forces.
+     * @note Positive value means counter-clockwise rotation.
      */
-    void ApplyDamping(float linear_damping, float angular_damping);
+    void ApplyInstantAngularImpulse(float angular_impulse);
 
     /**
-     * @brief Perform explicit euler integration on linear and angular disposition.
+     * @brief Change the pseudo velocity, which is used to move the object
+     *        out of an overlap on the next position integration.
      * 
-     * @param delta_time The time step between previous and current frame.
+     * @note Pseudo velocity never becomes a part of the momentum.
+     *       Therefore, positional correction cannot add any kinetic energy.
      * 
-     * @note @p delta_time should be identical to the value used on ApplyImpulse().
+     * @see World::ConfigurePositionalCorrectionMode()
      */
-    void Update(float delta_time);
+    void ApplyPseudoImpulse(const Vec3& rel_impact_pos, const Vec3& impulse);
 
 private:
     std::shared_ptr<ICollider> m_collider;
     MaterialProperties m_material;
 
-    DoF m_velocity;
-    DoF m_acceleration;
-
     /**
+     * @brief The storage and row which hold velocity, acceleration, transform,
+     *        and the inverse of mass and inertia.
+     * 
      * Reason for storing inverse of mass and inertia:
      * 1. Division by mass or inertia is more frequent than the value itself.
      * 2. Easy to handle infinite mass and inertia,
      *    which is used to represent a static object.
      */
-    float m_inv_mass;
-    float m_inv_inertia;
+    BodyStorage* m_storage = nullptr;
+    int m_index = -1;
+
+    /**
+     * @brief The state used while this object doesn't belong to any World, i.e., m_storage is nullptr.
+     */
+    BodyRow m_row;
 
+    /**
+     * @return The property of the current row, which is in m_row while detached.
+     */
+    template<typename T>
+    T& Field(std::vector<T> BodyStorage::* column, T BodyRow::* field);
+    template<typename T>
+    const T& Field(std::vector<T> BodyStorage::* column, T BodyRow::* field) const;
 };
 
+/**
+ * @return The effective mass of two objects pushed apart at given points along @p direction,
+ *         which is the impulse required to change their relative velocity by 1.
+ *         Zero if both objects are immovable along @p direction.
+ * 
+ * @param rel_pos1 Displacement of the point from object1's center, in global coordinate.
+ * @param rel_pos2 Displacement of the point from object2's center, in global coordinate.
+ */
+float EffectiveMass(const Rigidbody* object1, const Rigidbody* object2, const Vec3& rel_pos1, const Vec3& rel_pos2, const Vec3& direction);
+
 } // namespace physics
 
 #endif // PHYSICS_RIGIDBODY_H
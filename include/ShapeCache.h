@@ -0,0 +1,48 @@
+#ifndef PHYSICS_SHAPE_CACHE_H
+#define PHYSICS_SHAPE_CACHE_H
+
+#include "PolygonGeometry.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief ShapeCache hands out the same PolygonGeometry
+ *        for every request with identical vertices.
+ *
+ * @note Thousands of identical crates then share a single copy of vertices and edges,
+ *       which saves memory and keeps the narrowphase working on the same cache lines.
+ *
+ * @note The cache does not keep geometry alive by itself.
+ *       Once every polygon using it is destroyed, the geometry is released.
+ */
+class ShapeCache
+{
+public:
+    /**
+     * @return Geometry with exactly the same @p vertices, which is created on the first request.
+     *
+     * @warning The order of @p vertices must be counter-clockwise!
+     *          If not, an exception will be thrown.
+     */
+    std::shared_ptr<const PolygonGeometry> Polygon(const std::vector<Vec3>& vertices);
+
+    /**
+     * @return The number of distinct geometries still in use.
+     */
+    int Size() const;
+
+private:
+    static std::size_t Hash(const std::vector<Vec3>& vertices);
+    static bool IsSame(const PolygonGeometry& geometry, const std::vector<Vec3>& vertices);
+
+    // Geometries grouped by the hash of their vertices.
+    std::unordered_multimap<std::size_t, std::weak_ptr<const PolygonGeometry>> m_polygons;
+};
+
+} // namespace physics
+
+#endif // PHYSICS_SHAPE_CACHE_H
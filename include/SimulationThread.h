@@ -0,0 +1,152 @@
+#ifndef PHYSICS_SIMULATION_THREAD_H
+#define PHYSICS_SIMULATION_THREAD_H
+
+#include "CommandQueue.h"
+#include "World.h"
+#include "WorldSnapshot.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace physics
+{
+
+/**
+ * @brief SimulationThread advances a World either on a dedicated thread,
+ *        or on the caller's thread through Update().
+ *
+ * @note The render thread never touches the world.
+ *       It reads immutable snapshots, and edits the world by submitting commands,
+ *       which are run between two calls of World::Step().
+ *       Both work the same way in either mode, so input handlers don't care where the world runs.
+ *
+ * @note Snapshots are triple-buffered.
+ *       The simulation writes one buffer, the render thread reads another,
+ *       and the third holds the latest published snapshot.
+ *       Neither side ever waits for the other.
+ *
+ * @note Submit(), AcquireSnapshot() and Snapshot() must be called from a single thread,
+ *       e.g., the render thread.
+ */
+class SimulationThread
+{
+public:
+    /**
+     * @param world Belongs to this instance from now on.
+     *              Modify it directly only before the first Start() or Update().
+     */
+    explicit SimulationThread(std::shared_ptr<World> world);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    /**
+     * @brief Advance the world on a new thread until Stop(),
+     *        taking the elapsed time from the clock.
+     *
+     * @param publish_interval The time in seconds between two iterations of the thread.
+     *                         Each iteration runs the submitted commands,
+     *                         advances the world by the elapsed time and publishes a snapshot.
+     *                         Smaller than the fixed time step, so that the interpolated poses move smoothly.
+     */
+    void Start(float publish_interval = 1.0f / 240.0f);
+
+    /**
+     * @brief Join the thread started by Start(), if any.
+     * @note Commands submitted but not run yet are kept for the next iteration.
+     */
+    void Stop();
+
+    bool IsRunning() const;
+
+    /**
+     * @brief Run the submitted commands, advance the world by @p frame_time, and publish a snapshot,
+     *        all on the calling thread.
+     *
+     * @warning The thread must not be running.
+     */
+    void Update(float frame_time);
+
+    /**
+     * @brief Change how fast the simulated time passes, relative to the elapsed time.
+     *        0 pauses the simulation, while commands are still run.
+     */
+    void ConfigureTimeScale(float time_scale);
+
+    /**
+     * @brief Run @p command on the world before the next time step.
+     *
+     * @note Commands run in the order they were submitted.
+     * @note Waits while the queue is full, i.e., the simulation is falling far behind.
+     */
+    void Submit(CommandQueue::Command command);
+
+    /**
+     * @brief Take the latest published snapshot for reading, if there is a new one.
+     * @return Snapshot()
+     *
+     * @note The previous snapshot is handed back to the simulation,
+     *       so references to it become invalid.
+     */
+    const WorldSnapshot& AcquireSnapshot();
+
+    /**
+     * @return The snapshot taken by the last AcquireSnapshot().
+     *         It doesn't change until the next AcquireSnapshot().
+     */
+    const WorldSnapshot& Snapshot() const;
+
+private:
+    /**
+     * @brief A single iteration of the simulation, which is shared by both modes.
+     */
+    void Advance(float elapsed_time);
+
+    /**
+     * @brief Copy the state of the world into the snapshot owned by the simulation, and publish it.
+     */
+    void PublishSnapshot();
+
+    void ThreadLoop(std::stop_token stop_token, float publish_interval);
+
+    std::shared_ptr<World> m_world;
+    CommandQueue m_commands;
+    std::atomic<float> m_time_scale = 1.0f;
+    std::uint64_t m_num_steps = 0;
+
+    /**
+     * @brief Copy of the collider of each object, indexed by BodyHandle::slot.
+     *
+     * @note Snapshots share the copies, since the original colliders
+     *       are written by every step of the world.
+     *       A stale entry is replaced once its slot is reused by another object.
+     */
+    struct ColliderEntry
+    {
+        BodyHandle handle;
+        std::shared_ptr<const ICollider> collider;
+    };
+    std::vector<ColliderEntry> m_colliders;
+
+    /**
+     * @brief The triple buffer.
+     *
+     * @note m_write_index belongs to the simulation, and m_read_index to the reader.
+     *       m_ready_index holds the remaining buffer,
+     *       along with ready_flag if it was published after the reader took its last one.
+     */
+    static constexpr int ready_flag = 4;
+    std::array<WorldSnapshot, 3> m_snapshots;
+    int m_write_index = 0;
+    int m_read_index = 1;
+    std::atomic<int> m_ready_index = 2;
+
+    // Declared last, so that the thread is joined before anything else is destroyed.
+    std::jthread m_thread;
+};
+
+} // namespace physics
+
+#endif // PHYSICS_SIMULATION_THREAD_H
@@ -0,0 +1,99 @@
+#ifndef PHYSICS_SLOT_MAP_H
+#define PHYSICS_SLOT_MAP_H
+
+#include <cstdint>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief BodyHandle is a weak reference to an object of a World.
+ *
+ * @note The generation is increased whenever a slot is freed,
+ *       so a handle to a removed object never refers to an object
+ *       that reused the same slot later.
+ *
+ * @see World::AddObject(), World::Object()
+ */
+struct BodyHandle
+{
+    std::uint32_t slot = invalid_slot;
+    std::uint32_t generation = 0;
+
+    static constexpr std::uint32_t invalid_slot = UINT32_MAX;
+
+    bool operator==(const BodyHandle& other) const = default;
+};
+
+/**
+ * @brief SlotMap translates handles into indices of a dense array,
+ *        whose elements are removed by moving the last element into the hole.
+ *
+ * @note The dense array itself is owned by the user.
+ *       Every Insert(), Erase() and Swap() must be mirrored on it
+ *       by appending an element, by swap-removing an element
+ *       and by exchanging two elements, respectively.
+ *
+ * @note Every operation takes constant time.
+ */
+class SlotMap
+{
+public:
+    /**
+     * @brief Assign a handle to a new element appended at the end of the dense array.
+     */
+    BodyHandle Insert();
+
+    /**
+     * @brief Free the slot of @p handle.
+     *        The last element of the dense array takes the place of the erased one.
+     *
+     * @warning @p handle must be valid.
+     */
+    void Erase(BodyHandle handle);
+
+    /**
+     * @brief Follow the dense array exchanging the elements at @p first and @p second.
+     */
+    void Swap(int first, int second);
+
+    /**
+     * @return The dense index of @p handle, or -1 if the handle is stale or invalid.
+     */
+    int DenseIndex(BodyHandle handle) const;
+
+    /**
+     * @return The handle of the element at @p dense_index.
+     */
+    BodyHandle Handle(int dense_index) const;
+
+    int Size() const;
+
+    /**
+     * @brief Allocate for @p capacity elements at once.
+     */
+    void Reserve(int capacity);
+
+private:
+    struct Slot
+    {
+        // Index into the dense array while occupied,
+        // or the next free slot while free.
+        std::uint32_t index;
+        std::uint32_t generation;
+        bool occupied;
+    };
+
+    std::vector<Slot> m_slots;
+
+    // The slot of each element in the dense array.
+    std::vector<std::uint32_t> m_dense_to_slot;
+
+    // Head of the free list threaded through m_slots.
+    std::uint32_t m_free_head = BodyHandle::invalid_slot;
+};
+
+} // namespace physics
+
+#endif // PHYSICS_SLOT_MAP_H
@@ -0,0 +1,62 @@
+#ifndef PHYSICS_SOFTNESS_H
+#define PHYSICS_SOFTNESS_H
+
+#include "Angle.h"
+
+namespace physics
+{
+
+/**
+ * @brief Softness holds the coefficients of a soft constraint,
+ *        which behaves like a damped spring instead of a rigid rod.
+ *
+ * @note A rigid constraint tries to remove all the error within a single time step,
+ *       which easily overshoots when the time step is large.
+ *       A soft constraint instead targets a spring with given frequency and damping ratio,
+ *       so that the result stays stable regardless of the time step.
+ *
+ * @note The formulation is derived from an implicit integration of
+ *       a mass-spring-damper system, as described in Erin Catto's "Solver2D".
+ *
+ * @see MakeSoftness()
+ */
+struct Softness
+{
+    // Ratio of the position error converted into velocity bias.
+    float bias_rate = 0.0f;
+
+    // Scale applied on the effective mass of a constraint.
+    float mass_scale = 1.0f;
+
+    // Scale applied on the accumulated impulse, which acts like a relaxation.
+    float impulse_scale = 0.0f;
+};
+
+/**
+ * @param hertz The frequency of the target spring.
+ *              Zero means a rigid constraint without any bias.
+ * @param damping_ratio 1 is critical damping, while larger values are over-damped.
+ * @param time_step The time step of a single (sub)step.
+ */
+inline Softness MakeSoftness(float hertz, float damping_ratio, float time_step)
+{
+    if (hertz == 0.0f)
+    {
+        return {};
+    }
+
+    const auto omega = 2.0f * pi * hertz;
+    const auto a1 = 2.0f * damping_ratio + time_step * omega;
+    const auto a2 = time_step * omega * a1;
+    const auto a3 = 1.0f / (1.0f + a2);
+
+    return {
+        .bias_rate = omega / a1,
+        .mass_scale = a2 * a3,
+        .impulse_scale = a3
+    };
+}
+
+} // namespace physics
+
+#endif // PHYSICS_SOFTNESS_H
@@ -9,28 +9,47 @@ namespace physics
 /**
  * @brief AnchorPoint represents one side of a spring.
  *        Since objects are dynamic, we keep the relative position.
+ *
+ * @note The object is not owned by the anchor.
+ *       World removes springs and joints attached to an object when the object is removed.
+ *
+ * @see World::MakeAnchorPoint()
  */
 struct AnchorPoint
 {
-    std::shared_ptr<Rigidbody> object;
+    Rigidbody* object;
     Vec3 local_pos;
 
     Vec3 GlobalPosition() const;
-    void ApplyImpulse(const Vec3& impulse, float delta_time);
 };
 
 /**
- * @brief Spring applies force
+ * @brief Spring pulls or pushes two anchor points
+ *        towards the neutral distance, like a damped harmonic oscillator.
  * 
+ * @note Instead of applying Hooke's law explicitly,
+ *       the spring is solved as a soft constraint.
+ *       The stiffness and damping are folded into the effective mass,
+ *       which is equivalent to an implicit integration of the spring force.
+ *       Therefore, even a very stiff spring stays stable with a large time step.
+ * 
+ * @note This only describes a spring to be added.
+ *       World keeps the registered springs in a SpringStorage.
+ * 
+ * @see MakeSoftness(), SpringStorage
  */
 struct Spring
 {
     AnchorPoint start;
     AnchorPoint end;
     float neutral_distance;
-    float coefficient;
 
-    void ApplyImpulse(float delta_time);
+    // Natural frequency of the spring in Hz,
+    // which is independent from the mass of connected objects.
+    float hertz;
+
+    // 0: no damping, 1: critical damping.
+    float damping_ratio = 0.0f;
 };
 
 } // namespace physics
@@ -2,7 +2,7 @@
 #define PHYSICS_SPRING_CONNECTOR_H
 
 #include "IMouseAction.h"
-#include "World.h"
+#include "SimulationThread.h"
 
 namespace physics
 {
@@ -10,11 +10,14 @@ namespace physics
 /**
  * @brief Handles connecting two objects with spring
  *        and deleting all springs on an object.
+ *
+ * @note End points are picked on the latest snapshot,
+ *       and springs are edited through commands run by the simulation.
  */
 class SpringConnector : public IMouseAction
 {
 public:
-    SpringConnector(std::shared_ptr<World> world);
+    SpringConnector(std::shared_ptr<SimulationThread> simulation);
 
     virtual std::string Description() const override;
     virtual std::string Tooltip() const override;
@@ -24,21 +27,26 @@ public:
     virtual void OnMouseRelease(const Vec3& mouse_pos) override;
 
     /**
-     * @brief Change the strength of newly created springs.
+     * @brief Change the stiffness of newly created springs.
      * 
-     * @param coefficient A positive value representing the strength.
+     * @param hertz A positive value representing the frequency of oscillation.
+     * @param damping_ratio 0: no damping, 1: critical damping.
      * 
      * @note This does not affect existing springs!
      */
-    void ConfigureSprintCoefficient(float coefficient);
+    void ConfigureSpring(float hertz, float damping_ratio);
 
 private:
-    std::optional<AnchorPoint> TryPickAnchorPoint(const Vec3& mouse_pos) const;
+    /**
+     * @return The object under the cursor and the cursor position in its local coordinate system.
+     */
+    std::optional<std::pair<BodyHandle, Vec3>> TryPickAnchorPoint(const Vec3& mouse_pos) const;
 
-    std::shared_ptr<World> m_world;
-    std::optional<AnchorPoint> m_spring_start;
+    std::shared_ptr<SimulationThread> m_simulation;
+    std::optional<std::pair<BodyHandle, Vec3>> m_spring_start;
 
-    float m_spring_coefficient = 10000.0f;
+    float m_spring_hertz = 1.0f;
+    float m_spring_damping_ratio = 0.1f;
 };
 
 } // namespace physics
@@ -0,0 +1,112 @@
+#ifndef PHYSICS_SPRING_STORAGE_H
+#define PHYSICS_SPRING_STORAGE_H
+
+#include "BodyStorage.h"
+#include "Spring.h"
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief SpringStorage keeps every spring of a World as a structure of arrays,
+ *        referring to the connected objects by their index in BodyStorage.
+ *
+ * @note Springs are solved in two phases.
+ *       Prepare() computes everything that depends only on the positions
+ *       in a single pass without any dependency between springs,
+ *       and the iterations afterwards only read it back
+ *       while exchanging impulses through the velocities.
+ *
+ * @note Each body keeps the list of springs attached to it,
+ *       so removing the springs of a body only visits that body's springs.
+ *
+ * @see World::AddSpring()
+ */
+class SpringStorage
+{
+public:
+    /**
+     * @brief Add a spring between two objects in the same BodyStorage.
+     * @warning Both anchors must be on different objects.
+     */
+    void Add(const Spring& spring);
+
+    /**
+     * @brief Remove every spring connected to the body at @p body.
+     */
+    void RemoveSpringsOnBody(int body);
+
+    /**
+     * @brief Follow the body moved from index @p from to index @p to.
+     *
+     * @warning The body previously at @p to must not have any spring left.
+     *
+     * @see BodyStorage::SwapRemove()
+     */
+    void MoveBody(int from, int to);
+
+    /**
+     * @brief Follow the bodies at @p first and @p second exchanging their indices.
+     *
+     * @see BodyStorage::SwapRows()
+     */
+    void SwapBodies(int first, int second);
+
+    int Size() const;
+
+    /**
+     * @brief Compute the anchors, axis, stretch and effective mass of the springs in range [@p begin, @p end)
+     *        from the current positions of @p bodies.
+     *
+     * @note This must be called again whenever the positions change.
+     * @note Springs don't depend on each other, so disjoint ranges can be prepared concurrently.
+     */
+    void Prepare(const BodyStorage& bodies, int begin, int end);
+
+    /**
+     * @brief Apply the impulses accumulated on the previous time step.
+     */
+    void WarmStart(BodyStorage& bodies) const;
+
+    /**
+     * @brief Perform a single iteration over all springs.
+     *
+     * @param time_step The time step the spring force is integrated over.
+     */
+    void Solve(BodyStorage& bodies, float time_step);
+
+    // Definition of each spring.
+    // @see Spring
+    std::vector<int> bodies1;
+    std::vector<int> bodies2;
+    std::vector<Vec3> local_anchors1;
+    std::vector<Vec3> local_anchors2;
+    std::vector<float> neutral_distances;
+    std::vector<float> frequencies;
+    std::vector<float> damping_ratios;
+
+    // Accumulated impulse applied on the end point.
+    std::vector<float> impulses;
+
+private:
+    /**
+     * @brief Remove the spring at @p index by moving the last spring into it.
+     */
+    void SwapRemove(int index);
+
+    // Results of Prepare().
+    // Anchors are relative to the center of each object, in global coordinate.
+    std::vector<Vec3> m_rel_anchors1;
+    std::vector<Vec3> m_rel_anchors2;
+    std::vector<Vec3> m_axes;
+    std::vector<float> m_stretches;
+    std::vector<float> m_axial_masses;
+
+    // Indices of the springs attached to each body.
+    std::vector<std::vector<int>> m_springs_of_body;
+};
+
+} // namespace physics
+
+#endif // PHYSICS_SPRING_STORAGE_H
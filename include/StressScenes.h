@@ -0,0 +1,41 @@
+#ifndef PHYSICS_STRESS_SCENES_H
+#define PHYSICS_STRESS_SCENES_H
+
+#include "World.h"
+#include <span>
+
+namespace physics
+{
+
+/**
+ * @brief A canonical scene used to measure the performance of World.
+ *
+ * @note Every scene is built from the same numbers on every platform,
+ *       including the random ones, so results can be compared between machines.
+ */
+struct StressScene
+{
+    const char* name;
+    const char* description;
+
+    /**
+     * @brief Add about @p num_bodies dynamic objects, plus the static ones the scene needs,
+     *        to the empty @p world, and configure its gravity.
+     */
+    void (*build)(World& world, int num_bodies);
+};
+
+/**
+ * @return Every stress scene:
+ *         pyramid, funnel, pile, lattice and sparse.
+ */
+std::span<const StressScene> StressScenes();
+
+/**
+ * @return The scene called @p name, or nullptr if there is none.
+ */
+const StressScene* FindStressScene(std::string_view name);
+
+} // namespace physics
+
+#endif // PHYSICS_STRESS_SCENES_H
@@ -0,0 +1,38 @@
+#ifndef PHYSICS_SWAP_REMOVE_H
+#define PHYSICS_SWAP_REMOVE_H
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace physics
+{
+
+// Helpers shared by the implementation of the storages,
+// which keep their rows dense by moving the last row into the hole of a removed one.
+
+/**
+ * @brief Move the last element of @p values into @p index and shrink by one.
+ */
+template<typename T>
+void SwapRemoveElement(std::vector<T>& values, int index)
+{
+    values[index] = values.back();
+    values.pop_back();
+}
+
+/**
+ * @brief Remove @p value from @p values without keeping the order.
+ */
+template<typename T>
+void SwapRemoveValue(std::vector<T>& values, const T& value)
+{
+    const auto it = std::find(values.begin(), values.end(), value);
+    assert(it != values.end());
+    *it = values.back();
+    values.pop_back();
+}
+
+} // namespace physics
+
+#endif // PHYSICS_SWAP_REMOVE_H
@@ -0,0 +1,159 @@
+#ifndef PHYSICS_TRACER_H
+#define PHYSICS_TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief Tracer records when each phase of a step and each job ran, and on which thread,
+ *        and writes them as Chrome trace events, which Perfetto and chrome://tracing can open.
+ *
+ * @note Tracing is disabled until Tracer::Enable() is called.
+ *       A disabled tracer costs a single atomic load per scope.
+ *
+ * @note Events go into a lock-free ring buffer shared by every thread,
+ *       which overwrites the oldest events once full.
+ *       Recording never allocates and never waits for another thread,
+ *       so a capture shows the spikes as they happen.
+ *
+ * @see PHYSICS_TRACE_SCOPE, ScopedPhaseTimer
+ */
+class Tracer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief The number of events kept by the ring buffer.
+     *        A step of a few thousand bodies on 8 threads takes a few hundred.
+     */
+    static constexpr std::size_t capacity = 1 << 16;
+
+    Tracer();
+    ~Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /**
+     * @return The instance used by the whole process.
+     *
+     * @note If Tracer::WriteOnExit() was called, the trace is written when the process exits.
+     */
+    static Tracer& Global();
+
+    /**
+     * @brief Start and stop recording.
+     *
+     * @note The ring buffer is allocated on the first call to Enable(),
+     *       and events recorded so far are kept while disabled.
+     */
+    void Enable();
+    void Disable();
+    bool IsEnabled() const;
+
+    /**
+     * @brief Record that @p name ran on the calling thread from @p start until @p end.
+     *
+     * @param name A string which lives until the trace is written, such as a literal.
+     */
+    void Record(const char* name, Clock::time_point start, Clock::time_point end);
+
+    /**
+     * @brief Show the calling thread as @p name, instead of its number.
+     *
+     * @note Takes a lock, so call it once when the thread starts.
+     */
+    void SetThreadName(std::string name);
+
+    /**
+     * @brief Write every event in the buffer in the Chrome trace event format.
+     *
+     * @note Safe while other threads record.
+     *       Events being written at the same time are left out.
+     */
+    void WriteChromeTrace(std::ostream& out) const;
+
+    /**
+     * @brief Same as above, but writes to a file.
+     * @return False if the file couldn't be written.
+     */
+    bool WriteChromeTrace(const std::string& path) const;
+
+    /**
+     * @brief Write the trace to @p path when the global instance is destroyed at exit.
+     */
+    void WriteOnExit(std::string path);
+
+private:
+    /**
+     * @brief A single event, whose fields are guarded by @p sequence like a seqlock.
+     *        0 means the slot is being written or was never written.
+     */
+    struct Slot
+    {
+        std::atomic<std::uint64_t> sequence = 0;
+        std::atomic<const char*> name = nullptr;
+        std::atomic<std::int64_t> start_ns = 0;
+        std::atomic<std::int64_t> duration_ns = 0;
+        std::atomic<std::uint32_t> thread_id = 0;
+    };
+
+    /**
+     * @return A small number which identifies the calling thread.
+     */
+    static std::uint32_t ThreadId();
+
+    std::atomic<bool> m_enabled = false;
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<std::uint64_t> m_next_event = 0;
+
+    // Timestamps are relative to this, so that the first event is close to zero.
+    Clock::time_point m_epoch;
+
+    // Guards the allocation of m_slots, the thread names and the exit path.
+    mutable std::mutex m_mutex;
+    std::vector<std::pair<std::uint32_t, std::string>> m_thread_names;
+    std::string m_exit_path;
+};
+
+/**
+ * @brief Record the lifetime of this instance, if tracing is enabled.
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* name);
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+    bool m_is_recording;
+    Tracer::Clock::time_point m_start;
+};
+
+} // namespace physics
+
+// Compiled in along with the profiler, since both only matter when looking for slow steps.
+#ifdef PHYSICS_PROFILE
+#define PHYSICS_TRACE_CONCAT_INNER(a, b) a##b
+#define PHYSICS_TRACE_CONCAT(a, b) PHYSICS_TRACE_CONCAT_INNER(a, b)
+#define PHYSICS_TRACE_SCOPE(name) \
+    const auto PHYSICS_TRACE_CONCAT(trace_scope_, __LINE__) = ::physics::TraceScope(name)
+#else
+#define PHYSICS_TRACE_SCOPE(name)
+#endif
+
+#endif // PHYSICS_TRACER_H
@@ -0,0 +1,326 @@
+#ifndef PHYSICS_TRAJECTORY_FILE_H
+#define PHYSICS_TRAJECTORY_FILE_H
+
+#include "World.h"
+#include "WorldSnapshot.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief Version of the files written by TrajectoryRecorder.
+ */
+constexpr std::uint32_t trajectory_file_version = 1;
+
+/**
+ * @brief The start of a trajectory file.
+ *
+ * @note A trajectory file is a sequence of blocks followed by the index.
+ *       Each block is either a scene, i.e., a world file as written by WriteWorldFile(),
+ *       or a chunk of frames of the scene written before it.
+ */
+struct TrajectoryFileHeader
+{
+    std::array<char, 8> magic;
+    std::uint32_t version;
+
+    // 0x01020304 in the byte order of the machine which wrote the file.
+    std::uint32_t byte_order;
+
+    // The simulated time between two frames.
+    float fixed_time_step;
+
+    // The size of a single step of the quantized values.
+    float position_precision;
+    float rotation_precision;
+    float velocity_precision;
+
+    std::uint64_t num_frames;
+
+    // Written last, so that it stays zero if the recording was never finished.
+    std::uint64_t index_offset;
+    std::uint64_t num_scenes;
+    std::uint64_t num_chunks;
+};
+
+/**
+ * @brief The objects and springs of the world while a range of frames was recorded.
+ */
+struct TrajectoryFileScene
+{
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+/**
+ * @brief Consecutive frames of a single scene.
+ *
+ * @note Every object stores its position, rotation, linear velocity and angular velocity,
+ *       in the order of World::Objects() in the scene.
+ *       Each value is quantized, subtracted from the same value of the previous frame,
+ *       and stored as a zigzag-encoded variable-length integer.
+ *       The first frame of a chunk is subtracted from zero, so decoding starts at any chunk.
+ */
+struct TrajectoryFileChunk
+{
+    std::uint64_t first_frame;
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t num_frames;
+
+    // Index of the scene, which also tells the number of objects.
+    std::uint32_t scene;
+};
+
+struct TrajectoryRecorderOptions
+{
+    // Error of the recorded positions, in the units of the world.
+    float position_precision = 1.0f / 1024.0f;
+
+    // Error of the recorded rotations and angular velocities, in radians.
+    float rotation_precision = 1.0f / 65536.0f;
+
+    // Error of the recorded linear velocities.
+    float velocity_precision = 1.0f / 256.0f;
+
+    // The longest distance a seek has to decode.
+    int frames_per_chunk = 120;
+};
+
+/**
+ * @brief TrajectoryRecorder records the pose and velocity of every object after each fixed step,
+ *        and streams them into a file, which is replayed by TrajectoryReader.
+ *
+ * @note Encoding a frame costs a pass over the objects on the simulating thread,
+ *       while a background thread writes the finished chunks.
+ *       The simulation never waits for the disk.
+ *       Chunk buffers are reused once written, so a new one is allocated only while the disk falls behind.
+ *
+ * @note Whenever objects or springs are added, removed or changed, e.g., the mass or the material,
+ *       the whole world is written as a new scene, which the following chunks refer to.
+ *
+ * @see World::ConfigureStepCallback()
+ */
+class TrajectoryRecorder
+{
+public:
+    /**
+     * @return A recorder writing to @p path, or nothing if the file couldn't be created.
+     */
+    static std::unique_ptr<TrajectoryRecorder> Open(const std::string& path, const TrajectoryRecorderOptions& options = {});
+
+    /**
+     * @brief Finish().
+     */
+    ~TrajectoryRecorder();
+
+    TrajectoryRecorder(const TrajectoryRecorder&) = delete;
+    TrajectoryRecorder& operator=(const TrajectoryRecorder&) = delete;
+
+    /**
+     * @brief Append the current state of @p world as the next frame.
+     *
+     * @note Does nothing once finished.
+     */
+    void Record(const World& world);
+
+    /**
+     * @brief Write the remaining frames and the index, and close the file.
+     * @return False if anything couldn't be written.
+     *
+     * @note Safe to call from another thread than Record(),
+     *       e.g., from the render thread while the callback is still installed.
+     */
+    bool Finish();
+
+    std::uint64_t NumFrames() const;
+
+private:
+    TrajectoryRecorder(std::ofstream out, const TrajectoryRecorderOptions& options);
+
+    /**
+     * @brief A scene or chunk handed over to the writer thread.
+     */
+    struct Block
+    {
+        std::vector<std::byte> bytes;
+        bool is_scene = false;
+        std::uint64_t first_frame = 0;
+        std::uint32_t num_frames = 0;
+    };
+
+    /**
+     * @brief What a scene stores of an object besides its pose and velocity.
+     */
+    struct SceneObject
+    {
+        BodyHandle handle;
+        float inv_mass;
+        float inv_inertia;
+        MaterialProperties material;
+    };
+
+    /**
+     * @brief What a scene stores of a spring.
+     */
+    struct SceneSpring
+    {
+        int body1;
+        int body2;
+        Vec3 local_anchor1;
+        Vec3 local_anchor2;
+        float neutral_distance;
+        float hertz;
+        float damping_ratio;
+    };
+
+    /**
+     * @return True if an object or a spring was added, removed or changed since the previous frame,
+     *         or the objects were reordered.
+     */
+    bool IsNewScene(const World& world);
+
+    /**
+     * @brief Hand the current chunk over to the writer thread, if it has any frame.
+     */
+    void FlushChunk();
+
+    /**
+     * @return An empty buffer, which reuses the memory of a written block if there is any.
+     */
+    std::vector<std::byte> TakeBuffer();
+
+    void Push(Block block);
+
+    void WriterLoop(std::stop_token stop_token);
+
+    TrajectoryFileHeader m_header;
+    int m_frames_per_chunk;
+
+    // Serializes Record() and Finish().
+    std::mutex m_record_mutex;
+    bool m_is_finished = false;
+    std::atomic<std::uint64_t> m_num_frames = 0;
+
+    /**
+     * @brief State of the simulating thread.
+     */
+    std::vector<SceneObject> m_scene_objects;
+    std::vector<SceneSpring> m_scene_springs;
+    bool m_has_scene = false;
+    Block m_chunk;
+    std::vector<std::int32_t> m_previous_values;
+
+    /**
+     * @brief Blocks waiting for the writer thread, and the buffers it wrote.
+     */
+    std::mutex m_queue_mutex;
+    std::condition_variable_any m_wake;
+    std::vector<Block> m_pending;
+    std::vector<std::vector<std::byte>> m_free_buffers;
+
+    /**
+     * @brief Owned by the writer thread until it is joined.
+     */
+    std::ofstream m_out;
+    std::uint64_t m_file_size = 0;
+    std::vector<TrajectoryFileScene> m_scenes;
+    std::vector<TrajectoryFileChunk> m_chunks;
+    bool m_failed = false;
+
+    // Declared last, so that the thread is joined before anything else is destroyed.
+    std::jthread m_writer;
+};
+
+/**
+ * @brief TrajectoryReader replays a file written by TrajectoryRecorder, one frame at a time.
+ *
+ * @note Seeking decodes from the first frame of the chunk,
+ *       unless the frame follows the current one, so playing forward decodes each frame once.
+ */
+class TrajectoryReader
+{
+public:
+    /**
+     * @return A reader of @p path, or nothing if it is not a finished trajectory file of this version.
+     *
+     * @note The time step is taken from the first frame, so a file without frames is rejected as well.
+     */
+    static std::unique_ptr<TrajectoryReader> Open(const std::string& path);
+
+    std::uint64_t NumFrames() const;
+    float FixedTimeStep() const;
+
+    /**
+     * @brief Decode @p frame, which must be less than NumFrames().
+     * @return False if the file couldn't be read or is corrupted.
+     */
+    bool Seek(std::uint64_t frame);
+
+    /**
+     * @return The frame decoded by the last successful Seek().
+     */
+    std::uint64_t Frame() const;
+
+    /**
+     * @brief The world the current frame was recorded in, whose objects are placed on the frame.
+     *
+     * @note The objects keep their handles while the scene doesn't change,
+     *       and the handles of a new scene never match the ones of the previous scene.
+     */
+    const World& Scene() const;
+
+    /**
+     * @brief Overwrite @p snapshot with the objects and springs of the current frame,
+     *        so that it is drawn the same as a snapshot of a live simulation.
+     *
+     * @note num_steps is the frame, and there are no collisions.
+     */
+    void FillSnapshot(WorldSnapshot& snapshot) const;
+
+private:
+    TrajectoryReader(std::ifstream in, const TrajectoryFileHeader& header);
+
+    bool LoadScene(std::uint32_t scene);
+    bool LoadChunk(int chunk);
+
+    /**
+     * @brief Decode the next frame of the current chunk into the scene.
+     */
+    bool DecodeFrame();
+
+    std::ifstream m_in;
+    TrajectoryFileHeader m_header;
+    std::vector<TrajectoryFileScene> m_scenes;
+    std::vector<TrajectoryFileChunk> m_chunks;
+
+    std::unique_ptr<World> m_scene;
+    std::uint32_t m_scene_index = UINT32_MAX;
+
+    // Copies of the colliders of the scene, shared by every snapshot.
+    std::vector<std::shared_ptr<const ICollider>> m_colliders;
+
+    int m_chunk_index = -1;
+    std::vector<std::byte> m_chunk_bytes;
+    std::size_t m_cursor = 0;
+
+    // The number of frames decoded from the current chunk.
+    std::uint32_t m_num_decoded = 0;
+    std::vector<std::int32_t> m_values;
+    std::uint64_t m_frame = 0;
+};
+
+} // namespace physics
+
+#endif // PHYSICS_TRAJECTORY_FILE_H
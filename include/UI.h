@@ -2,6 +2,7 @@
 #define PHYSICS_UI_H
 
 #include "IMouseAction.h"
+#include "World.h"
 #include <vector>
 #include <memory>
 
@@ -28,34 +29,75 @@ public:
      */
     void AddMouseActionType(std::shared_ptr<IMouseAction> mouse_action);
 
+    /**
+     * @brief Show @p stats in the profiler section from the next UI::Update().
+     */
+    void SetStepStats(const StepStats& stats);
+
+    /**
+     * @brief Show @p frame out of @p num_frames on the replay slider from the next UI::Update().
+     *        Zero frames tells that there is nothing to replay.
+     */
+    void SetReplayFrame(int frame, int num_frames);
+
     bool IsUpdateRequired() const;
+    bool IsSingleStepRequired() const;
     bool IsGravityEnabled() const;
     bool IsCollisionEnabled() const;
+    bool IsSubsteppingEnabled() const;
+    bool IsSplitImpulseEnabled() const;
+    bool IsSimulationThreadEnabled() const;
+    bool IsTracingEnabled() const;
+    bool IsTraceSaveRequired() const;
+    bool IsRecordingEnabled() const;
+    bool IsReplayEnabled() const;
+    bool IsReplayPlaying() const;
+    bool IsReplayFrameChanged() const;
+
+    int SubstepCount() const;
+    int ReplayFrame() const;
 
     float TimeScale() const;
     float DragStrength() const;
     float GravityStrength() const;
     float LinearDamping() const;
     float AngularDamping() const;
-    float SpringCoefficient() const;
+    float SpringFrequency() const;
+    float SpringDampingRatio() const;
 
     Vec3 MousePosition() const;
 
 private:
     void DrawUI();
+    void DrawProfiler();
     void HandleMouseAction();
 
     bool m_enable_gravity = true;
     bool m_enable_collision = true;
     bool m_enable_update = true;
     bool m_update_one_step = false;
+    bool m_enable_substepping = false;
+    bool m_enable_split_impulse = false;
+    bool m_enable_simulation_thread = false;
+    bool m_enable_tracing = false;
+    bool m_save_trace = false;
+    bool m_enable_recording = false;
+    bool m_enable_replay = false;
+    bool m_play_replay = true;
+    bool m_replay_frame_changed = false;
+
+    int m_replay_frame = 0;
+    int m_num_replay_frames = 0;
+
+    int m_substep_count = 4;
 
     float m_time_scale = 1.0f;
     float m_drag_strength = 0.2f;
     float m_gravity_strength = 9.8f;
     float m_linear_damping = 0.0f;
     float m_angular_damping = 0.0f;
-    float m_spring_coefficient = 10000.0f;
+    float m_spring_hertz = 1.0f;
+    float m_spring_damping_ratio = 0.1f;
 
     // List of all possible actions for mouse clicks.
     // One of them will be chosen and set as m_active_mouse_action.
@@ -63,6 +105,8 @@ private:
 
     // The action executed in response to mouse clicks.
     int m_active_mouse_action_index = 0;
+
+    StepStats m_step_stats;
 };
 
 } // namespace physics
@@ -2,30 +2,160 @@
 #define PHYSICS_WORLD_H
 
 #include "Rigidbody.h"
-#include "Spring.h"
+#include "SpringStorage.h"
+#include "ContactConstraint.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "JointStorage.h"
+#include "Profiler.h"
+#include "SlotMap.h"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
 
 namespace physics
 {
 
+/**
+ * @brief Strategy of positional correction in World::ResolveCollisions().
+ * 
+ * @see World::ConfigurePositionalCorrectionMode()
+ */
+enum class PositionalCorrectionMode
+{
+    // Move the transforms right away, one collision after another.
+    Direct,
+
+    // Solve pseudo velocities over all collisions, which are
+    // integrated into position only and never fed back into momentum.
+    SplitImpulse
+};
+
+/**
+ * @brief Memory allocated by a single World::Step() call.
+ *
+ * @see World::LastStepAllocations()
+ */
+struct StepAllocationStats
+{
+    // Number of heap allocations, including the ones made by the standard library.
+    // Only counted when PHYSICS_COUNT_ALLOCATIONS is enabled, and 0 otherwise.
+    std::size_t heap_allocations = 0;
+
+    // Bytes taken from the frame arena and the thread arenas by the last fixed step.
+    std::size_t arena_bytes = 0;
+};
+
+/**
+ * @brief Where the time of the last few fixed steps went.
+ *
+ * @see World::Stats()
+ */
+struct StepStats
+{
+    // False if the library was built without PHYSICS_PROFILE, in which case everything else is zero.
+    bool enabled = false;
+
+    // The number of fixed steps the phase statistics are taken over.
+    int num_samples = 0;
+
+    // Indexed by StepPhase.
+    std::array<PhaseStats, num_step_phases> phases{};
+
+    // Counters of the last fixed step.
+    StepCounters counters;
+
+    // Allocations of the last World::Step(), which are counted regardless of PHYSICS_PROFILE.
+    StepAllocationStats allocations;
+};
+
+/**
+ * @brief Every parameter set by the Configure functions of World, except for the threads,
+ *        which belong to the machine rather than the scene.
+ *
+ * @see World::Config(), World::Configure()
+ */
+struct WorldConfig
+{
+    // @see World::ConfigureFixedTimeStep()
+    float fixed_time_step = 1.0f / 60.0f;
+    int max_steps_per_frame = 4;
+
+    // @see World::ConfigureGravity()
+    Vec3 gravity;
+
+    // @see World::ConfigurePipeline()
+    bool use_substepping = false;
+    bool resolve_collisions = true;
+
+    // @see World::ConfigurePositionalCorrection(), World::ConfigurePositionalCorrectionMode()
+    float penetration_allowance = 0.05f;
+    float correction_ratio = 0.4f;
+    PositionalCorrectionMode correction_mode = PositionalCorrectionMode::Direct;
+    int correction_iterations = 4;
+
+    // @see World::ConfigureDeterminism()
+    bool deterministic = false;
+
+    // @see World::ConfigureDamping(), World::ConfigureMaxVelocity()
+    float linear_damping = 0.0f;
+    float angular_damping = 0.0f;
+    float max_linear_speed = std::numeric_limits<float>::infinity();
+    float max_angular_speed = std::numeric_limits<float>::infinity();
+
+    // @see World::ConfigureSubstepping()
+    int num_substeps = 4;
+    float contact_hertz = 30.0f;
+    float contact_damping_ratio = 10.0f;
+    float max_push_velocity = 30.0f;
+
+    // @see World::ConfigureJoints()
+    float joint_hertz = 60.0f;
+    float joint_damping_ratio = 2.0f;
+    int joint_iterations = 8;
+};
+
 /**
  * @brief World is a helper class for managing a group of simulated rigidbodies.
 */
 class World
 {
 public:
+    World() = default;
+    ~World();
+
+    // Objects refer to the storage of this instance.
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
     /**
      * @return The list of all rigidbodies managed by this instance.
-     * @note The non-const version was required for configuring
-     *       SFML shape of the rigidbody's collider,
-     *       such as fill color and outline thickness.
      */
     std::vector<std::shared_ptr<Rigidbody>>& Objects();
     const std::vector<std::shared_ptr<Rigidbody>>& Objects() const;
 
+    /**
+     * @return The transform of each object in World::Objects() to be rendered,
+     *         interpolated between the last two fixed steps.
+     * 
+     * @note The interpolated state lags behind the simulation by less than a single step.
+     *       In exchange, motion looks smooth even if the frame rate
+     *       doesn't match the fixed time step.
+     * 
+     * @see World::Step()
+     */
+    const std::vector<physics::Transform>& RenderTransforms() const;
+
     /**
      * @return The list of all springs managed by this instance.
      */
-    const std::vector<Spring>& Springs() const;
+    const SpringStorage& Springs() const;
+
+    /**
+     * @return All joints managed by this instance.
+     */
+    const JointStorage& Joints() const;
 
     /**
      * @return The list of collisions occured during this time step.
@@ -33,6 +163,59 @@ public:
      */
     const std::vector<CollisionPair>& Collisions() const;
 
+    /**
+     * @return Memory allocated by the last World::Step().
+     * @note A scene without spawning or despawning should report no heap allocations.
+     *       Objects created with MakePooled() are spawned and despawned without any either,
+     *       once ReserveObjects() made room for them.
+     */
+    const StepAllocationStats& LastStepAllocations() const;
+
+    /**
+     * @return Time spent on each phase of the last few fixed steps,
+     *         and the amount of work done by the last one.
+     * 
+     * @note Timers and counters are compiled in only with PHYSICS_PROFILE.
+     */
+    StepStats Stats() const;
+
+    /**
+     * @return The current configuration, e.g., to save it along with the objects.
+     */
+    WorldConfig Config() const;
+
+    /**
+     * @brief Apply every parameter of @p config, same as calling each Configure function.
+     */
+    void Configure(const WorldConfig& config);
+
+    /**
+     * @brief Change the time step used by World::Step().
+     * 
+     * @param fixed_time_step The time step of a single simulation step.
+     * @param max_steps_per_frame The maximum number of steps World::Step() may run
+     *                            to catch up with the elapsed time.
+     *                            The remaining time is dropped, so that a slow frame
+     *                            doesn't cause even more steps on the next frame.
+     * 
+     * @note Both arguments must be positive.
+     */
+    void ConfigureFixedTimeStep(float fixed_time_step, int max_steps_per_frame);
+
+    /**
+     * @brief Change the gravitational acceleration applied by World::Step().
+     */
+    void ConfigureGravity(const Vec3& gravity);
+
+    /**
+     * @brief Choose the solver used by World::Step().
+     * 
+     * @param use_substepping True to use World::UpdateSubstepped(),
+     *                        false to use World::ResolveCollisions() followed by World::Update().
+     * @param resolve_collisions False if collisions should be detected but not resolved.
+     */
+    void ConfigurePipeline(bool use_substepping, bool resolve_collisions);
+
     /**
      * @brief Change the behavior of position adjustment
      *        after a collision is resolved.
@@ -51,6 +234,74 @@ public:
      */
     void ConfigurePositionalCorrection(float penetration_allowance, float correction_ratio);
 
+    /**
+     * @brief Choose how World::ResolveCollisions() removes the overlap.
+     * 
+     * @param mode PositionalCorrectionMode::Direct moves the objects inside the collision loop,
+     *             so later collisions see positions that were already moved.
+     *             PositionalCorrectionMode::SplitImpulse iteratively solves pseudo velocities,
+     *             which also correct rotation, and applies them on the next Update().
+     * @param num_iterations The number of iterations for PositionalCorrectionMode::SplitImpulse.
+     * 
+     * @note Since pseudo velocities do not change the momentum,
+     *       split impulse never adds kinetic energy even with a high correction ratio.
+     */
+    void ConfigurePositionalCorrectionMode(PositionalCorrectionMode mode, int num_iterations);
+
+    /**
+     * @brief Change the behavior of joints.
+     * 
+     * @param joint_hertz The stiffness used to remove position error of rigid joints.
+     * @param joint_damping_ratio The damping ratio used to remove position error of rigid joints.
+     * @param num_iterations The number of spring and joint iterations per World::Update().
+     * 
+     * @note World::UpdateSubstepped() solves springs and joints once per substep,
+     *       so @p num_iterations only applies to World::Update().
+     * @note Like contacts, the frequency is limited to a quarter of the (sub)step rate.
+     */
+    void ConfigureJoints(float joint_hertz, float joint_damping_ratio, int num_iterations);
+
+    /**
+     * @brief Run the parallel stages of the simulation on a new JobSystem with @p num_threads threads.
+     *        Those are the narrowphase of World::CheckCollisions(), split impulse,
+     *        spring preparation and the integration of large worlds.
+     * 
+     * @note @p num_threads must be positive. 1 means single-threaded.
+     * @note The result does not depend on the number of threads.
+     */
+    void ConfigureThreadCount(int num_threads);
+
+    /**
+     * @brief Run the parallel stages of the simulation on @p jobs,
+     *        which may be shared with other worlds and the caller's own jobs.
+     * 
+     * @note World::Step() can itself run as a job of @p jobs.
+     *       Threads waiting inside the step run other jobs in the meantime.
+     * 
+     * @see World::ConfigureThreadCount()
+     */
+    void ConfigureJobSystem(std::shared_ptr<JobSystem> jobs);
+
+    /**
+     * @brief Make the result independent of the order objects were added and removed.
+     * 
+     * @param deterministic True to order the objects by their id before every collision detection.
+     *                      Candidate pairs, collisions and contacts then follow the ids,
+     *                      and the lower id always becomes CollisionPair::object1.
+     * 
+     * @note The result never depends on the number of threads, even if this is disabled.
+     *       Parallel stages write disjoint ranges and are merged in a fixed order.
+     * @note Springs and joints are solved in the order they were added.
+     * @note Objects added without an id are numbered in the order they were added,
+     *       so the result is independent of that order only if every object is added with a stable id,
+     *       e.g., one saved along with the scene.
+     *       Debug builds assert that no two static or two dynamic objects share an id,
+     *       since their order would then depend on where they started.
+     * 
+     * @see World::AddObject(), World::StateHash()
+     */
+    void ConfigureDeterminism(bool deterministic);
+
     /**
      * @brief Change the magnitude of linear and angular velocity damping.
      * 
@@ -61,25 +312,181 @@ public:
      */
     void ConfigureDamping(float linear_damping, float angular_damping);
 
+    /**
+     * @brief Limit the speed of every object, which is applied after damping.
+     * 
+     * @note Both arguments must be positive. Infinity, the default, disables the limit.
+     */
+    void ConfigureMaxVelocity(float max_linear_speed, float max_angular_speed);
+
+    /**
+     * @brief Change the behavior of World::UpdateSubstepped().
+     * 
+     * @param num_substeps The number of substeps a single time step is divided into.
+     * @param contact_hertz The stiffness of contacts, expressed as a spring frequency.
+     *                      Higher value pushes overlapping objects apart faster.
+     * @param contact_damping_ratio The damping ratio of contacts.
+     *                              Values larger than 1 prevent overlapping objects from bouncing off.
+     * @param max_push_velocity Upper limit of the velocity used to push overlapping objects apart.
+     * 
+     * @note @p num_substeps must be positive.
+     * @note The contact frequency is limited to a quarter of the substep rate,
+     *       since a stiffer spring cannot be simulated with such time step.
+     */
+    void ConfigureSubstepping(int num_substeps, float contact_hertz, float contact_damping_ratio, float max_push_velocity);
+
+    /**
+     * @brief Call @p callback at the end of every fixed step, on the thread which steps the world,
+     *        e.g., to record the state of every step rather than the interpolated frames.
+     * 
+     * @note An empty function, the default, removes the callback.
+     * @see TrajectoryRecorder
+     */
+    void ConfigureStepCallback(std::function<void(const World&)> callback);
+
     /**
      * @brief Add and remove a rigidbody from this simulator.
+     * 
+     * @return The handle of the new object.
+     * 
+     * @note Removing an object moves the last object of World::Objects() into its place.
+     *       It also removes every spring and joint attached to the object.
+     * @note Adding takes constant time, and removing takes time proportional
+     *       to the number of springs and joints attached to the object.
      */
-    void AddObject(std::shared_ptr<Rigidbody> object);
+    BodyHandle AddObject(std::shared_ptr<Rigidbody> object);
     void RemoveObject(const std::shared_ptr<Rigidbody>& object);
 
+    /**
+     * @brief Same as above, but with an id which identifies the object across runs.
+     * 
+     * @param id A stable identifier, which must be unique within this instance.
+     *           The overload without id uses one more than the largest id added so far,
+     *           which follows the order of the calls.
+     * 
+     * @see World::ConfigureDeterminism()
+     */
+    BodyHandle AddObject(std::shared_ptr<Rigidbody> object, std::uint64_t id);
+
+    /**
+     * @brief Allocate every list indexed by objects for @p num_objects objects at once,
+     *        e.g., before adding a whole scene.
+     */
+    void ReserveObjects(int num_objects);
+
+    /**
+     * @brief Same as above, but identifies the object with a handle.
+     * 
+     * @return False if @p handle was stale, in which case nothing happens.
+     */
+    bool RemoveObject(BodyHandle handle);
+
+    /**
+     * @return The object referred by @p handle,
+     *         or nullptr if the object was already removed.
+     */
+    Rigidbody* Object(BodyHandle handle);
+    const Rigidbody* Object(BodyHandle handle) const;
+
+    /**
+     * @return The handle of @p object, which must belong to this instance.
+     */
+    BodyHandle Handle(const Rigidbody& object) const;
+
+    /**
+     * @return The id given to @p object by World::AddObject().
+     */
+    std::uint64_t BodyId(const Rigidbody& object) const;
+
+    /**
+     * @return An anchor on the object referred by @p handle,
+     *         or nothing if the object was already removed.
+     * 
+     * @param local_pos The anchor position in the object's local coordinate system.
+     */
+    std::optional<AnchorPoint> MakeAnchorPoint(BodyHandle handle, const Vec3& local_pos);
+
     /**
      * @brief Add and remove a spring from this simulator.
+     * @warning Both objects of the spring must belong to this instance.
      */
     void AddSpring(const Spring& spring);
-    void RemoveSpringOnObject(const std::shared_ptr<Rigidbody>& object);
+    void RemoveSpringOnObject(const Rigidbody* object);
+
+    /**
+     * @brief Add and remove a joint from this simulator.
+     * 
+     * @return The identifier of the new joint.
+     * 
+     * @note Removing an object also removes the joints connected to it.
+     */
+    JointId AddJoint(const DistanceJoint& joint);
+    JointId AddJoint(const RevoluteJoint& joint);
+    JointId AddJoint(const WeldJoint& joint);
+    JointId AddJoint(const PrismaticJoint& joint);
+    JointId AddJoint(const MouseJoint& joint);
+    void RemoveJoint(JointId id);
+
+    /**
+     * @return The mouse joint with the specified identifier,
+     *         or nullptr if it doesn't exist.
+     * 
+     * @note The pointer becomes invalid when a mouse joint is added or removed.
+     */
+    MouseJoint* FindMouseJoint(JointId id);
 
     /**
      * @return The first rigidbody which contains the specified point.
      * 
-     * @note If there are multiple candidates, the 'oldest' object is selected.
+     * @note If there are multiple candidates, the one with the lowest index in World::Objects() is selected.
      */
     std::shared_ptr<Rigidbody> PickObject(const Vec3& pos);
 
+    /**
+     * @brief Same as World::PickObject(), but returns a handle.
+     * 
+     * @return Invalid handle if there is no object on @p pos.
+     */
+    BodyHandle PickHandle(const Vec3& pos) const;
+
+    /**
+     * @brief Advance the simulation by @p frame_time using fixed time steps.
+     * 
+     * @param frame_time The elapsed time since the previous call.
+     * @return The number of fixed steps performed, which might be zero.
+     * 
+     * @note Each fixed step runs the whole pipeline: collision detection, gravity,
+     *       and either World::UpdateSubstepped() or World::ResolveCollisions() with World::Update().
+     *       The leftover time is accumulated for the next call,
+     *       and used to interpolate World::RenderTransforms().
+     * 
+     * @see World::ConfigureFixedTimeStep(), World::ConfigurePipeline()
+     */
+    int Step(float frame_time);
+
+    /**
+     * @return The time step used by World::Step().
+     */
+    float FixedTimeStep() const;
+
+    /**
+     * @return A hash of the position and velocity of every object, visited in the order of their ids.
+     * 
+     * @note Compare the hash after each step to find the first step where two runs diverged.
+     *       Floats are hashed by their bits, so the hashes match only for bit-identical states.
+     */
+    std::uint64_t StateHash() const;
+
+    /**
+     * @brief Forget the state carried over between time steps,
+     *        which are the accumulated impulses of springs and joints,
+     *        the time not simulated yet and the transforms used for interpolation.
+     * 
+     * @note Call after teleporting objects, e.g., to restart a scene.
+     * @see WorldBatch::Reset()
+     */
+    void ClearHistory();
+
     /**
      * @brief Detect every collision occurrance within this time step.
      * 
@@ -104,16 +511,144 @@ public:
      */
     void Update(float delta_time);
 
+    /**
+     * @brief Resolve collisions and update all objects using multiple substeps.
+     *        This replaces ResolveCollisions() followed by Update().
+     * 
+     * @param delta_time The time step of the whole update.
+     * @param resolve_collisions False if collisions should be ignored.
+     * 
+     * @note Collision detection is expensive, so it runs only once per time step.
+     *       Each substep then integrates velocity, relaxes contacts as soft constraints,
+     *       and integrates position. Instead of detecting collisions again,
+     *       the separation of each contact point is recomputed
+     *       from the anchors cached in the objects' local coordinate system.
+     *       This gives the stability of a small time step at a fraction of the cost.
+     * 
+     * @note CheckCollisions() must be preceded.
+     * 
+     * @see World::ConfigureSubstepping()
+     */
+    void UpdateSubstepped(float delta_time, bool resolve_collisions);
+
 private:
+    /**
+     * @brief Run the whole pipeline once with the fixed time step.
+     */
+    void FixedStep();
+
+    /**
+     * @brief Blend the transforms of the previous and current step.
+     * 
+     * @param alpha 0: previous step, 1: current step.
+     */
+    void InterpolateRenderTransforms(float alpha);
+
+    /**
+     * @brief Create a ContactConstraint for each of m_collisions in the frame arena.
+     */
+    void BuildContactConstraints();
+
+    /**
+     * @brief Remove overlaps by solving pseudo velocities over all collisions.
+     * 
+     * @see PositionalCorrectionMode::SplitImpulse
+     */
+    void SolvePseudoVelocities(float delta_time);
+
+    /**
+     * @brief Warm start and solve all springs and joints.
+     *
+     * @note The springs must be prepared by PrepareSprings() since the positions last changed.
+     */
+    void WarmStartJoints();
+    void SolveJoints(const JointSolverContext& context, bool use_bias);
+
+    /**
+     * @return Time step information for joints, using the current joint parameters.
+     */
+    JointSolverContext MakeJointSolverContext(float time_step) const;
+
+    /**
+     * @brief Prepare all springs from the current positions, in parallel.
+     */
+    void PrepareSprings();
+
+    /**
+     * @return Gravity, damping and speed limit for the integration in BodyStorage.
+     */
+    IntegrationParameters MakeIntegrationParameters() const;
+
+    /**
+     * @brief Move static objects to the front of every list of objects,
+     *        so that integration can skip them as a whole.
+     * 
+     * @note Objects can become static at any time through Rigidbody,
+     *       so this runs at the start of every update.
+     *       Nothing moves unless an object was added, removed or changed its mass.
+     */
+    void PartitionStaticBodies();
+
+    /**
+     * @brief Exchange the objects at @p first and @p second in every list indexed by objects.
+     */
+    void SwapBodies(int first, int second);
+
+    /**
+     * @brief Put static objects first, same as World::PartitionStaticBodies(),
+     *        and sort the objects of each partition by their id.
+     * 
+     * @note Nothing moves unless an object was added, removed or changed its mass.
+     * @see World::ConfigureDeterminism()
+     */
+    void SortBodiesById();
+
     /**
      * @brief List of all registered rigidbodies.
+     * 
+     * @note m_objects[i] is the view of row i in m_bodies.
      */
     std::vector<std::shared_ptr<Rigidbody>> m_objects;
 
+    /**
+     * @brief Dynamic state of all registered rigidbodies.
+     */
+    BodyStorage m_bodies;
+
+    /**
+     * @brief Rows [0, m_num_static_bodies) of m_bodies are static objects.
+     * @see World::PartitionStaticBodies()
+     */
+    int m_num_static_bodies = 0;
+
+    /**
+     * @brief Translates handles into indices of m_objects and m_bodies.
+     */
+    SlotMap m_slots;
+
+    /**
+     * @brief The id of each object, stored in the same order as m_objects.
+     * @see World::AddObject()
+     */
+    std::vector<std::uint64_t> m_body_ids;
+    std::uint64_t m_num_added_objects = 0;
+
+    /**
+     * @brief Transforms of m_objects, stored in the same order.
+     * @see World::RenderTransforms()
+     */
+    std::vector<physics::Transform> m_previous_transforms;
+    std::vector<physics::Transform> m_render_transforms;
+
     /**
      * @brief List of all registered springs.
      */
-    std::vector<Spring> m_springs;
+    SpringStorage m_springs;
+
+    /**
+     * @brief List of all registered joints.
+     */
+    JointStorage m_joints;
 
     /**
      * @brief Stores all collisions detected during this time step.
@@ -121,12 +656,37 @@ private:
      */
     std::vector<CollisionPair> m_collisions;
 
+
+    /**
+     * @brief Parameters for World::Step().
+     * @see World::ConfigureFixedTimeStep(), World::ConfigureGravity(), World::ConfigurePipeline()
+     */
+    float m_fixed_time_step = 1.0f / 60.0f;
+    int m_max_steps_per_frame = 4;
+    float m_time_accumulator = 0.0f;
+    Vec3 m_gravity;
+    bool m_use_substepping = false;
+    bool m_resolve_collisions = true;
+
     /**
      * @brief Parameters for positional correction.
      * @see World::ConfigurePositionalCorrection()
      */
     float m_penetration_allowance = 0.05f;
     float m_correction_ratio = 0.4f;
+    PositionalCorrectionMode m_correction_mode = PositionalCorrectionMode::Direct;
+    int m_correction_iterations = 4;
+
+    /**
+     * @brief Runs the parallel stages.
+     * @see World::ConfigureThreadCount(), World::ConfigureJobSystem()
+     */
+    std::shared_ptr<JobSystem> m_jobs = JobSystem::Serial();
+
+    /**
+     * @see World::ConfigureDeterminism()
+     */
+    bool m_deterministic = false;
 
     /**
      * @brief Parameters for velocity damping.
@@ -134,6 +694,77 @@ private:
      */
     float m_linear_damping = 0.0f;
     float m_angular_damping = 0.0f;
+
+    /**
+     * @brief Parameters for the speed limit.
+     * @see World::ConfigureMaxVelocity()
+     */
+    float m_max_linear_speed = std::numeric_limits<float>::infinity();
+    float m_max_angular_speed = std::numeric_limits<float>::infinity();
+
+    /**
+     * @brief Parameters for the substepped solver.
+     * @see World::ConfigureSubstepping()
+     */
+    int m_num_substeps = 4;
+    float m_contact_hertz = 30.0f;
+    float m_contact_damping_ratio = 10.0f;
+    float m_max_push_velocity = 30.0f;
+
+    /**
+     * @brief Parameters for joints.
+     * @see World::ConfigureJoints()
+     */
+    float m_joint_hertz = 60.0f;
+    float m_joint_damping_ratio = 2.0f;
+    int m_joint_iterations = 8;
+
+    /**
+     * @see World::ConfigureStepCallback()
+     */
+    std::function<void(const World&)> m_step_callback;
+
+    /**
+     * @brief Collisions with relative normal velocity under this threshold do not bounce.
+     */
+    float m_restitution_threshold = 1.0f;
+
+    /**
+     * @brief Memory of the data that lives only during a single time step.
+     *        This gets reset whenever World::CheckCollision() is called.
+     */
+    FrameArena m_frame_arena;
+
+    /**
+     * @brief Scratch memory of each thread of m_jobs, indexed by JobSystem::ThreadIndex().
+     *        Reset together with m_frame_arena.
+     */
+    std::vector<FrameArena> m_thread_arenas = std::vector<FrameArena>(1);
+
+    /**
+     * @brief Held by a thread outside the pool while it uses m_thread_arenas[0],
+     *        since all of them share thread index 0.
+     */
+    std::mutex m_outside_arena_mutex;
+
+    /**
+     * @brief Solver representation of m_collisions,
+     *        reused over the substeps of World::UpdateSubstepped()
+     *        and the iterations of split impulse.
+     * 
+     * @note Allocated from m_frame_arena.
+     */
+    std::span<ContactConstraint> m_contact_constraints;
+
+    /**
+     * @see World::LastStepAllocations()
+     */
+    StepAllocationStats m_last_step_allocations;
+
+    /**
+     * @see World::Stats()
+     */
+    StepProfiler m_profiler;
 };
 
 } // namespace physics
@@ -0,0 +1,113 @@
+#ifndef PHYSICS_WORLD_BATCH_H
+#define PHYSICS_WORLD_BATCH_H
+
+#include "World.h"
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief WorldBatch simulates many independent copies of a small scene,
+ *        such as rollouts of a control policy.
+ *
+ * @note The worlds live in a single array, and are stepped as jobs of a shared JobSystem,
+ *       one world per job.
+ *       Each world runs its own stages on a single thread,
+ *       since a few objects cannot keep multiple threads busy, while thousands of worlds can.
+ *
+ * @note Objects are referred to by their order in the template scene.
+ *       The pose of every object of every world is kept in a single array
+ *       written by the job that stepped the world, and read in place through Poses().
+ */
+class WorldBatch
+{
+public:
+    /**
+     * @param scene The template scene.
+     *              Its objects, springs and joints, except for mouse joints, are copied into every world.
+     * @param num_worlds The number of worlds, which must be positive.
+     * @param jobs Runs the worlds in parallel.
+     *
+     * @note Configuration of @p scene is not copied. Use ForEachWorld() instead.
+     */
+    WorldBatch(const World& scene, int num_worlds, std::shared_ptr<JobSystem> jobs);
+
+    int Size() const;
+    int ObjectsPerWorld() const;
+
+    World& At(int world);
+    const World& At(int world) const;
+
+    /**
+     * @brief Invoke @p func(world) on every world, e.g., to configure them.
+     */
+    template<typename Func>
+    void ForEachWorld(Func&& func);
+
+    /**
+     * @brief Advance every world by a single fixed time step.
+     * @see World::FixedTimeStep()
+     */
+    void Step();
+
+    /**
+     * @brief Put every object back to the state of the template scene,
+     *        and clear the history of the worlds.
+     *
+     * @see World::ClearHistory()
+     */
+    void Reset();
+    void Reset(int world);
+
+    /**
+     * @return The pose of every object, ordered by world and then by the template scene.
+     *         The pose of object i of world w is at w * ObjectsPerWorld() + i.
+     *
+     * @note Updated by Step() and Reset(). The memory stays the same during the lifetime.
+     */
+    std::span<const Transform> Poses() const;
+    std::span<const Transform> Poses(int world) const;
+
+private:
+    /**
+     * @brief Copy the poses of @p world into m_poses.
+     */
+    void PublishPoses(int world);
+
+    int m_num_worlds;
+    std::unique_ptr<World[]> m_worlds;
+    std::shared_ptr<JobSystem> m_jobs;
+
+    /**
+     * @brief Handles of the copied objects in the order of the template scene.
+     *
+     * @note Every world inserts the same objects into an empty World in the same order,
+     *       so the handles are the same for every world.
+     */
+    std::vector<BodyHandle> m_handles;
+
+    /**
+     * @brief Initial state of each object of the template scene.
+     */
+    std::vector<Transform> m_initial_transforms;
+    std::vector<Vec3> m_initial_linear_velocities;
+    std::vector<Vec3> m_initial_angular_velocities;
+
+    std::vector<Transform> m_poses;
+};
+
+template<typename Func>
+void WorldBatch::ForEachWorld(Func&& func)
+{
+    for (int i = 0; i < m_num_worlds; ++i)
+    {
+        func(m_worlds[i]);
+    }
+}
+
+} // namespace physics
+
+#endif // PHYSICS_WORLD_BATCH_H
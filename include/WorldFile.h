@@ -0,0 +1,241 @@
+#ifndef PHYSICS_WORLD_FILE_H
+#define PHYSICS_WORLD_FILE_H
+
+#include "World.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+
+namespace physics
+{
+
+/**
+ * @brief Version of the files written by WriteWorldFile().
+ *
+ * @note Records are read in place without any conversion,
+ *       so this must be bumped whenever a record below changes.
+ */
+constexpr std::uint32_t world_file_version = 1;
+
+/**
+ * @brief The sections of a world file, in the order they are stored.
+ */
+enum class WorldFileSection : std::uint32_t
+{
+    Config,
+    Vertices,
+    Polygons,
+    Bodies,
+    Springs
+};
+
+constexpr int num_world_file_sections = 5;
+
+/**
+ * @brief An array of records in a world file.
+ */
+struct WorldFileSectionEntry
+{
+    // From the start of the file, aligned to world_file_alignment.
+    std::uint64_t offset;
+    std::uint64_t count;
+
+    // sizeof() the record, which is checked when the file is opened.
+    std::uint32_t record_size;
+    std::uint32_t reserved;
+};
+
+/**
+ * @brief The start of a world file.
+ */
+struct WorldFileHeader
+{
+    std::array<char, 8> magic;
+    std::uint32_t version;
+
+    // 0x01020304 in the byte order of the machine which wrote the file.
+    std::uint32_t byte_order;
+
+    std::uint64_t file_size;
+    std::array<WorldFileSectionEntry, num_world_file_sections> sections;
+};
+
+/**
+ * @brief A point or vector on the plane, which is all the simulation uses of Vec3.
+ */
+struct WorldFileVec2
+{
+    float x;
+    float y;
+};
+
+/**
+ * @brief WorldConfig with fixed-size fields.
+ */
+struct WorldFileConfig
+{
+    float fixed_time_step;
+    std::int32_t max_steps_per_frame;
+    WorldFileVec2 gravity;
+    std::uint32_t use_substepping;
+    std::uint32_t resolve_collisions;
+    float penetration_allowance;
+    float correction_ratio;
+    std::uint32_t correction_mode;
+    std::int32_t correction_iterations;
+    std::uint32_t deterministic;
+    float linear_damping;
+    float angular_damping;
+    float max_linear_speed;
+    float max_angular_speed;
+    std::int32_t num_substeps;
+    float contact_hertz;
+    float contact_damping_ratio;
+    float max_push_velocity;
+    float joint_hertz;
+    float joint_damping_ratio;
+    std::int32_t joint_iterations;
+};
+
+/**
+ * @brief The geometry of a ConvexPolygon, shared by every body with the same vertices.
+ */
+struct WorldFilePolygon
+{
+    // Range of the counter-clockwise vertices in the vertex section.
+    std::uint32_t first_vertex;
+    std::uint32_t num_vertices;
+};
+
+enum class WorldFileShape : std::uint32_t
+{
+    Circle,
+    Polygon
+};
+
+/**
+ * @brief A rigidbody and its collider.
+ */
+struct WorldFileBody
+{
+    // @see World::BodyId()
+    std::uint64_t id;
+
+    WorldFileShape shape;
+
+    // Index in the polygon section, only used by polygons.
+    std::uint32_t polygon;
+
+    // Only used by circles.
+    float radius;
+
+    WorldFileVec2 position;
+    Radian rotation;
+    WorldFileVec2 linear_velocity;
+    float angular_velocity;
+
+    // Both are zero for static bodies.
+    float inv_mass;
+    float inv_inertia;
+
+    MaterialProperties material;
+};
+
+/**
+ * @brief A spring, which refers to its bodies by their index in the body section.
+ */
+struct WorldFileSpring
+{
+    std::uint32_t body1;
+    std::uint32_t body2;
+    WorldFileVec2 local_anchor1;
+    WorldFileVec2 local_anchor2;
+    float neutral_distance;
+    float hertz;
+    float damping_ratio;
+};
+
+/**
+ * @brief Every section starts on this boundary, which suits every record,
+ *        so a file mapped or read into aligned memory is used without copying.
+ */
+constexpr std::size_t world_file_alignment = 16;
+
+/**
+ * @brief A world file in memory, e.g., read as a whole or mapped with mmap(),
+ *        whose records are used in place.
+ *
+ * @note The view doesn't own the memory, which must outlive it.
+ */
+class WorldFileView
+{
+public:
+    /**
+     * @return A view of @p data, or nothing if it is not a valid world file of this version,
+     *         was written on a machine with another byte order,
+     *         any record refers outside of its section,
+     *         or the vertices of a polygon are not counter-clockwise.
+     *
+     * @warning @p data must be aligned to 8 bytes, which memory from operator new and mmap() always is.
+     */
+    static std::optional<WorldFileView> Open(std::span<const std::byte> data);
+
+    const WorldFileConfig& Config() const;
+    std::span<const WorldFileVec2> Vertices() const;
+    std::span<const WorldFilePolygon> Polygons() const;
+    std::span<const WorldFileBody> Bodies() const;
+    std::span<const WorldFileSpring> Springs() const;
+
+private:
+    explicit WorldFileView(std::span<const std::byte> data);
+
+    template<typename T>
+    std::span<const T> Section(WorldFileSection section) const;
+
+    std::span<const std::byte> m_data;
+};
+
+/**
+ * @brief Write the objects, shapes, materials, springs and configuration of @p world
+ *        in a compact binary format, which can be loaded by LoadWorld().
+ *
+ * @note Bodies with the same polygon share a single copy of its vertices.
+ *
+ * @note Joints are not saved.
+ *       The accumulated impulses of springs and the time not simulated yet aren't either,
+ *       so a loaded world starts the same as after World::ClearHistory().
+ */
+void WriteWorldFile(const World& world, std::ostream& out);
+
+/**
+ * @brief Same as above, but writes to a file.
+ * @return False if the file couldn't be written.
+ */
+bool WriteWorldFile(const World& world, const std::string& path);
+
+/**
+ * @brief Add every body and spring of @p file to the empty @p world,
+ *        and apply its configuration.
+ *
+ * @note Bodies keep their ids and the order of World::Objects(),
+ *       and bodies with the same polygon share a single PolygonGeometry.
+ *
+ * @note Never throws, since WorldFileView::Open() already rejected every shape PolygonGeometry would.
+ */
+void LoadWorld(const WorldFileView& file, World& world);
+
+/**
+ * @brief Read the whole file at @p path into a single buffer, and load it into the empty @p world.
+ *
+ * @return False if the file couldn't be read or is not a valid world file,
+ *         in which case @p world is left untouched.
+ */
+bool ReadWorldFile(const std::string& path, World& world);
+
+} // namespace physics
+
+#endif // PHYSICS_WORLD_FILE_H
@@ -0,0 +1,75 @@
+#ifndef PHYSICS_WORLD_SNAPSHOT_H
+#define PHYSICS_WORLD_SNAPSHOT_H
+
+#include "ICollider.h"
+#include "SlotMap.h"
+#include "Transform.h"
+#include "World.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace physics
+{
+
+/**
+ * @brief WorldSnapshot is a copy of everything needed to draw and pick the objects of a World,
+ *        published by SimulationThread after it advanced the world.
+ *
+ * @note Nothing in here refers to the world, so the render thread reads it
+ *       while the simulation thread keeps stepping.
+ *
+ * @note The object lists are stored in the same order.
+ */
+struct WorldSnapshot
+{
+    /**
+     * @brief The end points of a spring in global coordinate.
+     */
+    struct SpringSegment
+    {
+        Vec3 start;
+        Vec3 end;
+    };
+
+    /**
+     * @return The index of the object referred by @p handle,
+     *         or nothing if the object didn't exist when this snapshot was taken.
+     *
+     * @note Takes linear time.
+     */
+    std::optional<int> Find(BodyHandle handle) const;
+
+    /**
+     * @return The first object which contains @p pos, same as World::PickHandle(),
+     *         but tested on the transforms of this snapshot.
+     */
+    BodyHandle PickHandle(const Vec3& pos) const;
+
+    // The number of fixed steps simulated before this snapshot was taken.
+    std::uint64_t num_steps = 0;
+
+    std::vector<BodyHandle> handles;
+
+    // Copies of the colliders, which are shared by every snapshot but never modified.
+    std::vector<std::shared_ptr<const ICollider>> colliders;
+
+    // The interpolated transforms, same as World::RenderTransforms().
+    std::vector<Transform> transforms;
+
+    std::vector<bool> is_static;
+
+    // Placed on the interpolated transforms, same as the objects.
+    std::vector<SpringSegment> springs;
+
+    // Contact points and normals of the last fixed step.
+    std::vector<CollisionInfo> collisions;
+
+    // @see World::Stats()
+    StepStats stats;
+};
+
+} // namespace physics
+
+#endif // PHYSICS_WORLD_SNAPSHOT_H
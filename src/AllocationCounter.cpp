@@ -0,0 +1,64 @@
+#include "AllocationCounter.h"
+
+#ifdef PHYSICS_COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace physics
+{
+
+std::atomic<std::size_t> heap_allocation_count = 0;
+
+std::size_t HeapAllocationCount()
+{
+    return heap_allocation_count.load(std::memory_order_relaxed);
+}
+
+bool IsCountingHeapAllocations()
+{
+    return true;
+}
+
+} // namespace physics
+
+// Array and nothrow versions forward to these by default.
+void* operator new(std::size_t size)
+{
+    physics::heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto* memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+#else
+
+namespace physics
+{
+
+std::size_t HeapAllocationCount()
+{
+    return 0;
+}
+
+bool IsCountingHeapAllocations()
+{
+    return false;
+}
+
+} // namespace physics
+
+#endif // PHYSICS_COUNT_ALLOCATIONS
@@ -0,0 +1,45 @@
+#include "Angle.h"
+#include <cmath>
+
+namespace physics
+{
+
+SinCos DeterministicSinCos(Radian angle)
+{
+    // Computed in double, so that the result rounded to float is accurate
+    // even after reducing a large angle.
+    //
+    // Reduce the angle to r in [-pi/4, pi/4], where angle = r + quadrant * pi/2.
+    // pi/2 is split into two parts, and the first one has so few bits
+    // that quadrant * half_pi_hi has no rounding error.
+    constexpr double half_pi_hi = 1.5707963109016418;
+    constexpr double half_pi_lo = 1.5893254773528196e-08;
+    constexpr double two_over_pi = 0.63661977236758134;
+    const auto x = static_cast<double>(angle);
+    const auto quadrant = std::floor(x * two_over_pi + 0.5);
+    const auto r = (x - quadrant * half_pi_hi) - quadrant * half_pi_lo;
+    const auto r2 = r * r;
+
+    // Taylor series up to r^13 and r^14, whose error is far below the precision of float.
+    const auto sin_r = r * (1.0 + r2 * (-1.0 / 6 + r2 * (1.0 / 120 + r2 * (-1.0 / 5040 + r2 * (1.0 / 362880
+        + r2 * (-1.0 / 39916800 + r2 * (1.0 / 6227020800.0)))))));
+    const auto cos_r = 1.0 + r2 * (-1.0 / 2 + r2 * (1.0 / 24 + r2 * (-1.0 / 720 + r2 * (1.0 / 40320
+        + r2 * (-1.0 / 3628800 + r2 * (1.0 / 479001600 + r2 * (-1.0 / 87178291200.0)))))));
+
+    // sin(r + pi/2) = cos(r) and cos(r + pi/2) = -sin(r).
+    const auto sin_r_f = static_cast<float>(sin_r);
+    const auto cos_r_f = static_cast<float>(cos_r);
+    switch (static_cast<long long>(quadrant) & 3)
+    {
+    case 0:
+        return {sin_r_f, cos_r_f};
+    case 1:
+        return {cos_r_f, -sin_r_f};
+    case 2:
+        return {-sin_r_f, -cos_r_f};
+    default:
+        return {-cos_r_f, sin_r_f};
+    }
+}
+
+} // namespace physics
@@ -0,0 +1,552 @@
+#include "BenchReport.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <iterator>
+#include <string_view>
+
+namespace physics
+{
+
+/**
+ * @brief A parsed JSON value, which is just enough to read a BenchReport back.
+ */
+struct JsonValue
+{
+    enum class Type
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    /**
+     * @return The member called @p key, or nullptr if this is not an object or has no such member.
+     */
+    const JsonValue* Find(std::string_view key) const
+    {
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            if (keys[i] == key)
+            {
+                return &values[i];
+            }
+        }
+        return nullptr;
+    }
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+
+    // Elements of an array, or the values of an object in the same order as keys.
+    std::vector<JsonValue> values;
+    std::vector<std::string> keys;
+};
+
+/**
+ * @brief Recursive descent parser of JSON text.
+ *
+ * @note Strings only support the escapes WriteBenchReport() could produce.
+ */
+class JsonParser
+{
+public:
+    explicit JsonParser(std::string_view text)
+        : m_text(text)
+    {}
+
+    /**
+     * @return The value of the whole text, or nothing if it is not valid JSON.
+     */
+    std::optional<JsonValue> Parse()
+    {
+        auto value = JsonValue{};
+        if (!ParseValue(value))
+        {
+            return {};
+        }
+        SkipWhitespace();
+        if (m_pos != m_text.size())
+        {
+            return {};
+        }
+        return value;
+    }
+
+private:
+    bool ParseValue(JsonValue& value)
+    {
+        SkipWhitespace();
+        if (m_pos == m_text.size())
+        {
+            return false;
+        }
+
+        const auto c = m_text[m_pos];
+        if (c == '{')
+        {
+            value.type = JsonValue::Type::Object;
+            return ParseObject(value);
+        }
+        if (c == '[')
+        {
+            value.type = JsonValue::Type::Array;
+            return ParseArray(value);
+        }
+        if (c == '"')
+        {
+            value.type = JsonValue::Type::String;
+            return ParseString(value.string);
+        }
+        if (ConsumeWord("true"))
+        {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = true;
+            return true;
+        }
+        if (ConsumeWord("false"))
+        {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = false;
+            return true;
+        }
+        if (ConsumeWord("null"))
+        {
+            value.type = JsonValue::Type::Null;
+            return true;
+        }
+
+        value.type = JsonValue::Type::Number;
+        const auto begin = m_text.data() + m_pos;
+        const auto [end, error] = std::from_chars(begin, m_text.data() + m_text.size(), value.number);
+        m_pos += end - begin;
+        return error == std::errc() && end != begin;
+    }
+
+    bool ParseObject(JsonValue& value)
+    {
+        ++m_pos;
+        if (Consume('}'))
+        {
+            return true;
+        }
+
+        do
+        {
+            SkipWhitespace();
+            auto& key = value.keys.emplace_back();
+            if (!ParseString(key) || !Consume(':') || !ParseValue(value.values.emplace_back()))
+            {
+                return false;
+            }
+        } while (Consume(','));
+        return Consume('}');
+    }
+
+    bool ParseArray(JsonValue& value)
+    {
+        ++m_pos;
+        if (Consume(']'))
+        {
+            return true;
+        }
+
+        do
+        {
+            if (!ParseValue(value.values.emplace_back()))
+            {
+                return false;
+            }
+        } while (Consume(','));
+        return Consume(']');
+    }
+
+    bool ParseString(std::string& string)
+    {
+        if (m_pos == m_text.size() || m_text[m_pos] != '"')
+        {
+            return false;
+        }
+        ++m_pos;
+
+        while (m_pos < m_text.size())
+        {
+            const auto c = m_text[m_pos++];
+            if (c == '"')
+            {
+                return true;
+            }
+            if (c == '\\')
+            {
+                if (m_pos == m_text.size())
+                {
+                    return false;
+                }
+                string.push_back(m_text[m_pos++]);
+                continue;
+            }
+            string.push_back(c);
+        }
+        return false;
+    }
+
+    void SkipWhitespace()
+    {
+        while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' || m_text[m_pos] == '\r' || m_text[m_pos] == '\t'))
+        {
+            ++m_pos;
+        }
+    }
+
+    bool Consume(char c)
+    {
+        SkipWhitespace();
+        if (m_pos < m_text.size() && m_text[m_pos] == c)
+        {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool ConsumeWord(std::string_view word)
+    {
+        if (m_text.substr(m_pos, word.size()) == word)
+        {
+            m_pos += word.size();
+            return true;
+        }
+        return false;
+    }
+
+    std::string_view m_text;
+    std::size_t m_pos = 0;
+};
+
+double NumberMember(const JsonValue& object, std::string_view key)
+{
+    const auto member = object.Find(key);
+    return member && member->type == JsonValue::Type::Number ? member->number : 0.0;
+}
+
+bool BoolMember(const JsonValue& object, std::string_view key)
+{
+    const auto member = object.Find(key);
+    return member && member->type == JsonValue::Type::Bool && member->boolean;
+}
+
+std::string StringMember(const JsonValue& object, std::string_view key)
+{
+    const auto member = object.Find(key);
+    return member && member->type == JsonValue::Type::String ? member->string : std::string();
+}
+
+TimeSummary ReadTimeSummary(const JsonValue& object)
+{
+    return TimeSummary{
+        .average_ms = NumberMember(object, "average_ms"),
+        .median_ms = NumberMember(object, "median_ms"),
+        .p99_ms = NumberMember(object, "p99_ms"),
+        .max_ms = NumberMember(object, "max_ms")
+    };
+}
+
+void WriteTimeSummary(std::ostream& out, const TimeSummary& summary)
+{
+    out << "{\"average_ms\": " << summary.average_ms
+        << ", \"median_ms\": " << summary.median_ms
+        << ", \"p99_ms\": " << summary.p99_ms
+        << ", \"max_ms\": " << summary.max_ms << "}";
+}
+
+/**
+ * @return @p name with spaces replaced, to be used as a JSON key.
+ */
+std::string JsonKey(std::string_view name)
+{
+    auto key = std::string(name);
+    std::replace(key.begin(), key.end(), ' ', '_');
+    return key;
+}
+
+TimeSummary Summarize(std::vector<float>& samples)
+{
+    if (samples.empty())
+    {
+        return {};
+    }
+
+    auto summary = TimeSummary{};
+    auto sum = 0.0;
+    for (const auto sample : samples)
+    {
+        sum += sample;
+        summary.max_ms = std::max(summary.max_ms, static_cast<double>(sample));
+    }
+    summary.average_ms = sum / samples.size();
+
+    const auto median_index = samples.size() / 2;
+    std::nth_element(samples.begin(), samples.begin() + median_index, samples.end());
+    summary.median_ms = samples[median_index];
+
+    const auto p99_index = std::min(samples.size() - 1, samples.size() * 99 / 100);
+    std::nth_element(samples.begin(), samples.begin() + p99_index, samples.end());
+    summary.p99_ms = samples[p99_index];
+    return summary;
+}
+
+void WriteBenchReport(std::ostream& out, const BenchReport& report)
+{
+    const auto& settings = report.settings;
+    out << "{\n";
+    out << "  \"settings\": {\n";
+    out << "    \"bodies\": " << settings.num_bodies << ",\n";
+    out << "    \"frames\": " << settings.num_frames << ",\n";
+    out << "    \"warmup_frames\": " << settings.num_warmup_frames << ",\n";
+    out << "    \"threads\": " << settings.num_threads << ",\n";
+    out << "    \"solver\": \"" << (settings.use_substepping ? "substepped" : "sequential") << "\",\n";
+    out << "    \"substeps\": " << settings.num_substeps << ",\n";
+    out << "    \"split_impulse\": " << (settings.correction_mode == PositionalCorrectionMode::SplitImpulse ? "true" : "false") << ",\n";
+    out << "    \"correction_iterations\": " << settings.num_correction_iterations << ",\n";
+    out << "    \"joint_iterations\": " << settings.num_joint_iterations << ",\n";
+    out << "    \"deterministic\": " << (settings.deterministic ? "true" : "false") << "\n";
+    out << "  },\n";
+    out << "  \"counts_allocations\": " << (report.counts_allocations ? "true" : "false") << ",\n";
+
+    out << "  \"scenes\": [";
+    for (std::size_t i = 0; i < report.scenes.size(); ++i)
+    {
+        const auto& result = report.scenes[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\n";
+        out << "      \"name\": \"" << result.name << "\",\n";
+        out << "      \"objects\": " << result.num_objects << ",\n";
+        out << "      \"springs\": " << result.num_springs << ",\n";
+        out << "      \"seconds\": " << result.seconds << ",\n";
+        out << "      \"steps_per_second\": " << result.steps_per_second << ",\n";
+        out << "      \"step\": ";
+        WriteTimeSummary(out, result.step);
+        out << ",\n";
+
+        if (result.has_phases)
+        {
+            out << "      \"phases\": {\n";
+            for (int phase = 0; phase < num_step_phases; ++phase)
+            {
+                out << "        \"" << JsonKey(PhaseName(static_cast<StepPhase>(phase))) << "\": ";
+                WriteTimeSummary(out, result.phases[phase]);
+                out << (phase + 1 < num_step_phases ? ",\n" : "\n");
+            }
+            out << "      },\n";
+
+            const auto& counters = result.counters;
+            out << "      \"counters\": {"
+                << "\"candidate_pairs\": " << counters.candidate_pairs
+                << ", \"narrowphase_tests\": " << counters.narrowphase_tests
+                << ", \"sat_axes\": " << counters.sat_axes
+                << ", \"contacts\": " << counters.contacts
+                << ", \"solver_iterations\": " << counters.solver_iterations
+                << ", \"awake_bodies\": " << counters.awake_bodies << "},\n";
+        }
+
+        out << "      \"heap_allocations\": " << result.heap_allocations << ",\n";
+        out << "      \"respawn_heap_allocations\": " << result.respawn_heap_allocations << ",\n";
+        out << "      \"peak_memory_bytes\": " << result.peak_memory_bytes << ",\n";
+        // As a string, since JSON readers may not keep 64-bit integers exact.
+        out << "      \"state_hash\": \"" << std::hex << result.state_hash << std::dec << "\"\n";
+        out << "    }";
+    }
+    out << "\n  ]\n";
+    out << "}\n";
+}
+
+std::optional<BenchReport> ReadBenchReport(std::istream& in)
+{
+    const auto text = std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    const auto root = JsonParser(text).Parse();
+    if (!root || root->type != JsonValue::Type::Object)
+    {
+        return {};
+    }
+
+    const auto settings = root->Find("settings");
+    const auto scenes = root->Find("scenes");
+    if (!settings || settings->type != JsonValue::Type::Object || !scenes || scenes->type != JsonValue::Type::Array)
+    {
+        return {};
+    }
+
+    auto report = BenchReport{};
+    report.settings = BenchSettings{
+        .num_bodies = static_cast<int>(NumberMember(*settings, "bodies")),
+        .num_frames = static_cast<int>(NumberMember(*settings, "frames")),
+        .num_warmup_frames = static_cast<int>(NumberMember(*settings, "warmup_frames")),
+        .num_threads = static_cast<int>(NumberMember(*settings, "threads")),
+        .use_substepping = StringMember(*settings, "solver") == "substepped",
+        .num_substeps = static_cast<int>(NumberMember(*settings, "substeps")),
+        .correction_mode = BoolMember(*settings, "split_impulse") ? PositionalCorrectionMode::SplitImpulse : PositionalCorrectionMode::Direct,
+        .num_correction_iterations = static_cast<int>(NumberMember(*settings, "correction_iterations")),
+        .num_joint_iterations = static_cast<int>(NumberMember(*settings, "joint_iterations")),
+        .deterministic = BoolMember(*settings, "deterministic")
+    };
+    report.counts_allocations = BoolMember(*root, "counts_allocations");
+
+    for (const auto& scene : scenes->values)
+    {
+        auto& result = report.scenes.emplace_back();
+        result.name = StringMember(scene, "name");
+        result.num_objects = static_cast<int>(NumberMember(scene, "objects"));
+        result.num_springs = static_cast<int>(NumberMember(scene, "springs"));
+        result.seconds = NumberMember(scene, "seconds");
+        result.steps_per_second = NumberMember(scene, "steps_per_second");
+        if (const auto step = scene.Find("step"))
+        {
+            result.step = ReadTimeSummary(*step);
+        }
+
+        if (const auto phases = scene.Find("phases"))
+        {
+            result.has_phases = true;
+            for (int phase = 0; phase < num_step_phases; ++phase)
+            {
+                if (const auto summary = phases->Find(JsonKey(PhaseName(static_cast<StepPhase>(phase)))))
+                {
+                    result.phases[phase] = ReadTimeSummary(*summary);
+                }
+            }
+        }
+
+        if (const auto counters = scene.Find("counters"))
+        {
+            result.counters = StepCounters{
+                .candidate_pairs = static_cast<std::uint64_t>(NumberMember(*counters, "candidate_pairs")),
+                .narrowphase_tests = static_cast<std::uint64_t>(NumberMember(*counters, "narrowphase_tests")),
+                .sat_axes = static_cast<std::uint64_t>(NumberMember(*counters, "sat_axes")),
+                .contacts = static_cast<std::uint64_t>(NumberMember(*counters, "contacts")),
+                .solver_iterations = static_cast<std::uint64_t>(NumberMember(*counters, "solver_iterations")),
+                .awake_bodies = static_cast<std::uint64_t>(NumberMember(*counters, "awake_bodies"))
+            };
+        }
+
+        result.heap_allocations = static_cast<std::uint64_t>(NumberMember(scene, "heap_allocations"));
+        result.respawn_heap_allocations = static_cast<std::uint64_t>(NumberMember(scene, "respawn_heap_allocations"));
+        result.peak_memory_bytes = static_cast<std::uint64_t>(NumberMember(scene, "peak_memory_bytes"));
+
+        const auto hash = StringMember(scene, "state_hash");
+        std::from_chars(hash.data(), hash.data() + hash.size(), result.state_hash, 16);
+    }
+    return report;
+}
+
+/**
+ * @return True if @p current is slower than @p baseline by more than @p limits allow.
+ */
+bool IsSlower(double baseline, double current, const RegressionLimits& limits)
+{
+    return current > baseline * (1.0 + limits.tolerance) && current - baseline > limits.min_difference_ms;
+}
+
+/**
+ * @brief Print a row of the comparison table.
+ */
+void PrintTimeRow(std::ostream& out, const char* metric, double baseline, double current, bool is_regression)
+{
+    char row[128];
+    const auto change = baseline > 0.0 ? (current / baseline - 1.0) * 100.0 : 0.0;
+    std::snprintf(row, sizeof(row), "  %-28s %10.4f %10.4f %+9.1f%%%s\n",
+        metric, baseline, current, change, is_regression ? "  <- slower" : "");
+    out << row;
+}
+
+/**
+ * @return True if @p current is more than @p baseline.
+ */
+bool PrintAllocationRow(std::ostream& out, const char* metric, std::uint64_t baseline, std::uint64_t current)
+{
+    const auto is_regression = current > baseline;
+    char row[128];
+    std::snprintf(row, sizeof(row), "  %-28s %10llu %10llu%s\n",
+        metric,
+        static_cast<unsigned long long>(baseline),
+        static_cast<unsigned long long>(current),
+        is_regression ? "             <- more" : "");
+    out << row;
+    return is_regression;
+}
+
+int CompareBenchReports(const BenchReport& baseline, const BenchReport& current, const RegressionLimits& limits, std::ostream& out)
+{
+    const auto compare_allocations = baseline.counts_allocations && current.counts_allocations;
+    if (baseline.counts_allocations && !current.counts_allocations)
+    {
+        out << "note: heap allocations are not compared, since this build doesn't count them (PHYSICS_COUNT_ALLOCATIONS)\n";
+    }
+
+    auto num_regressions = 0;
+    for (const auto& result : current.scenes)
+    {
+        const auto it = std::find_if(baseline.scenes.begin(), baseline.scenes.end(), [&result](const SceneResult& scene) {
+            return scene.name == result.name;
+        });
+        if (it == baseline.scenes.end())
+        {
+            out << "\n" << result.name << ": not in the baseline, skipped\n";
+            continue;
+        }
+        const auto& expected = *it;
+
+        char header[128];
+        std::snprintf(header, sizeof(header), "  %-28s %10s %10s %10s\n", "median ms", "baseline", "current", "change");
+        out << "\n" << result.name << "\n" << header;
+
+        auto scene_regressions = 0;
+        const auto step_regressed = IsSlower(expected.step.median_ms, result.step.median_ms, limits);
+        PrintTimeRow(out, "step", expected.step.median_ms, result.step.median_ms, step_regressed);
+        scene_regressions += step_regressed;
+
+        if (expected.has_phases && result.has_phases)
+        {
+            for (int phase = 0; phase < num_step_phases; ++phase)
+            {
+                const auto baseline_ms = expected.phases[phase].median_ms;
+                const auto current_ms = result.phases[phase].median_ms;
+                const auto phase_regressed = IsSlower(baseline_ms, current_ms, limits);
+                PrintTimeRow(out, PhaseName(static_cast<StepPhase>(phase)), baseline_ms, current_ms, phase_regressed);
+                scene_regressions += phase_regressed;
+            }
+        }
+
+        if (compare_allocations)
+        {
+            // Allocations don't depend on the machine, so any increase is a regression.
+            scene_regressions += PrintAllocationRow(out, "heap allocations", expected.heap_allocations, result.heap_allocations);
+            scene_regressions += PrintAllocationRow(out, "respawn heap allocations", expected.respawn_heap_allocations, result.respawn_heap_allocations);
+        }
+
+        if (current.settings.deterministic && result.state_hash != expected.state_hash)
+        {
+            out << "  note: the final state differs from the baseline, so the scene no longer behaves the same\n";
+        }
+
+        num_regressions += scene_regressions;
+    }
+
+    out << "\n";
+    if (num_regressions == 0)
+    {
+        out << "no regressions";
+    }
+    else
+    {
+        out << num_regressions << (num_regressions == 1 ? " regression" : " regressions");
+    }
+    out << " (tolerance " << limits.tolerance * 100.0 << "%, ignoring differences under " << limits.min_difference_ms << " ms)\n";
+    return num_regressions;
+}
+
+} // namespace physics
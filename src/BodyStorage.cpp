@@ -0,0 +1,367 @@
+#include "BodyStorage.h"
+#include "SwapRemove.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+// SSE2 is part of every x86-64 target, so the integration loops use it directly
+// instead of hoping for the auto-vectorizer, which gives up on the xyz rows of Vec3.
+#if defined(__SSE2__) || defined(_M_X64)
+#define PHYSICS_INTEGRATE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace physics
+{
+
+int BodyStorage::Append(Rigidbody* owner, const BodyRow& row)
+{
+    transforms.push_back(row.transform);
+    linear_velocities.push_back(row.linear_velocity);
+    angular_velocities.push_back(row.angular_velocity);
+    linear_accelerations.push_back(row.linear_acceleration);
+    angular_accelerations.push_back(row.angular_acceleration);
+    linear_pseudo_velocities.push_back(row.linear_pseudo_velocity);
+    angular_pseudo_velocities.push_back(row.angular_pseudo_velocity);
+    inv_masses.push_back(row.inv_mass);
+    inv_inertias.push_back(row.inv_inertia);
+    owners.push_back(owner);
+
+    return Size() - 1;
+}
+
+Rigidbody* BodyStorage::SwapRemove(int index)
+{
+    SwapRemoveElement(transforms, index);
+    SwapRemoveElement(linear_velocities, index);
+    SwapRemoveElement(angular_velocities, index);
+    SwapRemoveElement(linear_accelerations, index);
+    SwapRemoveElement(angular_accelerations, index);
+    SwapRemoveElement(linear_pseudo_velocities, index);
+    SwapRemoveElement(angular_pseudo_velocities, index);
+    SwapRemoveElement(inv_masses, index);
+    SwapRemoveElement(inv_inertias, index);
+    SwapRemoveElement(owners, index);
+
+    return index < Size() ? owners[index] : nullptr;
+}
+
+BodyRow BodyStorage::Row(int index) const
+{
+    return BodyRow{
+        .transform = transforms[index],
+        .linear_velocity = linear_velocities[index],
+        .angular_velocity = angular_velocities[index],
+        .linear_acceleration = linear_accelerations[index],
+        .angular_acceleration = angular_accelerations[index],
+        .linear_pseudo_velocity = linear_pseudo_velocities[index],
+        .angular_pseudo_velocity = angular_pseudo_velocities[index],
+        .inv_mass = inv_masses[index],
+        .inv_inertia = inv_inertias[index]
+    };
+}
+
+int BodyStorage::Size() const
+{
+    return static_cast<int>(owners.size());
+}
+
+void BodyStorage::Reserve(int capacity)
+{
+    transforms.reserve(capacity);
+    linear_velocities.reserve(capacity);
+    angular_velocities.reserve(capacity);
+    linear_accelerations.reserve(capacity);
+    angular_accelerations.reserve(capacity);
+    linear_pseudo_velocities.reserve(capacity);
+    angular_pseudo_velocities.reserve(capacity);
+    inv_masses.reserve(capacity);
+    inv_inertias.reserve(capacity);
+    owners.reserve(capacity);
+}
+
+#ifdef PHYSICS_INTEGRATE_SSE2
+
+// The kernels read the arrays as plain floats.
+static_assert(sizeof(Vec3) == 3 * sizeof(float));
+static_assert(sizeof(physics::Transform) == 4 * sizeof(float) && std::is_standard_layout_v<physics::Transform>);
+
+/**
+ * @brief Four consecutive Vec3 with one register per component.
+ */
+struct Vec3x4
+{
+    __m128 x;
+    __m128 y;
+    __m128 z;
+};
+
+Vec3x4 LoadVec3x4(const Vec3* values)
+{
+    // a: x0 y0 z0 x1, b: y1 z1 x2 y2, c: z2 x3 y3 z3
+    const auto* floats = &values->x;
+    const auto a = _mm_loadu_ps(floats);
+    const auto b = _mm_loadu_ps(floats + 4);
+    const auto c = _mm_loadu_ps(floats + 8);
+
+    const auto x_bc = _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2));
+    const auto y_ab = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+    const auto y_bc = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+    const auto z_ab = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+    const auto z_cc = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+    return Vec3x4{
+        .x = _mm_shuffle_ps(a, x_bc, _MM_SHUFFLE(2, 0, 3, 0)),
+        .y = _mm_shuffle_ps(y_ab, y_bc, _MM_SHUFFLE(2, 0, 2, 0)),
+        .z = _mm_shuffle_ps(z_ab, z_cc, _MM_SHUFFLE(2, 0, 2, 0))
+    };
+}
+
+void StoreVec3x4(Vec3* values, const Vec3x4& vectors)
+{
+    const auto& [x, y, z] = vectors;
+    const auto x0y0 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0));
+    const auto z0x1 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+    const auto y1z1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+    const auto x2y2 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2));
+    const auto z2x3 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+    const auto y3z3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+
+    auto* floats = &values->x;
+    _mm_storeu_ps(floats, _mm_shuffle_ps(x0y0, z0x1, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(floats + 4, _mm_shuffle_ps(y1z1, x2y2, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(floats + 8, _mm_shuffle_ps(z2x3, y3z3, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+void ClearVec3x4(Vec3* values)
+{
+    auto* floats = &values->x;
+    _mm_storeu_ps(floats, _mm_setzero_ps());
+    _mm_storeu_ps(floats + 4, _mm_setzero_ps());
+    _mm_storeu_ps(floats + 8, _mm_setzero_ps());
+}
+
+/**
+ * @brief Same as the scalar update of IntegrateVelocities(), for four rows starting at @p i.
+ */
+void AccelerateVec3x4(BodyStorage& storage, int i, Vec3x4& linear, __m128& angular_z, const Vec3& gravity, __m128 delta_time)
+{
+    const auto linear_acceleration = LoadVec3x4(&storage.linear_accelerations[i]);
+    const auto angular_acceleration = LoadVec3x4(&storage.angular_accelerations[i]);
+
+    // Multiplied as 1 or 0 rather than masked, so that the signs of zeros match the scalar loop.
+    const auto is_movable = _mm_cmpgt_ps(_mm_loadu_ps(&storage.inv_masses[i]), _mm_setzero_ps());
+    const auto gravity_mask = _mm_and_ps(is_movable, _mm_set1_ps(1.0f));
+
+    const auto accelerate = [&](__m128 velocity, __m128 acceleration, float gravity) {
+        const auto total = _mm_add_ps(acceleration, _mm_mul_ps(_mm_set1_ps(gravity), gravity_mask));
+        return _mm_add_ps(velocity, _mm_mul_ps(total, delta_time));
+    };
+    linear.x = accelerate(linear.x, linear_acceleration.x, gravity.x);
+    linear.y = accelerate(linear.y, linear_acceleration.y, gravity.y);
+    linear.z = accelerate(linear.z, linear_acceleration.z, gravity.z);
+    angular_z = _mm_add_ps(angular_z, _mm_mul_ps(angular_acceleration.z, delta_time));
+}
+
+#endif
+
+/**
+ * @brief Damp and clamp the velocities in range [@p begin, @p end),
+ *        after accelerating them for @p delta_time if @p Accelerate is true.
+ *        The accelerations are cleared.
+ *
+ * @note Four rows are updated at once with SSE2 where it is available.
+ *       Both paths do the same IEEE operations in the same order,
+ *       so the results are bit-identical, including the signs of zeros.
+ */
+template<bool Accelerate>
+void UpdateVelocityRange(BodyStorage& storage, int begin, int end, const IntegrationParameters& params, float delta_time)
+{
+    auto* linear_velocities = storage.linear_velocities.data();
+    auto* angular_velocities = storage.angular_velocities.data();
+    auto* linear_accelerations = storage.linear_accelerations.data();
+    auto* angular_accelerations = storage.angular_accelerations.data();
+    const auto* inv_masses = storage.inv_masses.data();
+
+    const auto linear_keep = 1.0f - params.linear_damping;
+    const auto angular_keep = 1.0f - params.angular_damping;
+
+    auto i = begin;
+#ifdef PHYSICS_INTEGRATE_SSE2
+    const auto delta_time4 = _mm_set1_ps(delta_time);
+    const auto linear_keep4 = _mm_set1_ps(linear_keep);
+    const auto angular_keep4 = _mm_set1_ps(angular_keep);
+    const auto max_linear_speed4 = _mm_set1_ps(params.max_linear_speed);
+    const auto max_angular_speed4 = _mm_set1_ps(params.max_angular_speed);
+    const auto min_angular_speed4 = _mm_set1_ps(-params.max_angular_speed);
+    for (; i + 4 <= end; i += 4)
+    {
+        auto linear = LoadVec3x4(&linear_velocities[i]);
+        auto angular = LoadVec3x4(&angular_velocities[i]);
+        if constexpr (Accelerate)
+        {
+            AccelerateVec3x4(storage, i, linear, angular.z, params.gravity, delta_time4);
+        }
+        ClearVec3x4(&linear_accelerations[i]);
+        ClearVec3x4(&angular_accelerations[i]);
+
+        linear.x = _mm_mul_ps(linear.x, linear_keep4);
+        linear.y = _mm_mul_ps(linear.y, linear_keep4);
+        linear.z = _mm_mul_ps(linear.z, linear_keep4);
+        angular.z = _mm_mul_ps(angular.z, angular_keep4);
+
+        // Same as std::min() and std::clamp() below, including the operand order.
+        const auto squared_speed = _mm_add_ps(_mm_add_ps(_mm_mul_ps(linear.x, linear.x), _mm_mul_ps(linear.y, linear.y)), _mm_mul_ps(linear.z, linear.z));
+        const auto scale = _mm_min_ps(_mm_div_ps(max_linear_speed4, _mm_sqrt_ps(squared_speed)), _mm_set1_ps(1.0f));
+        linear.x = _mm_mul_ps(linear.x, scale);
+        linear.y = _mm_mul_ps(linear.y, scale);
+        linear.z = _mm_mul_ps(linear.z, scale);
+        angular.z = _mm_min_ps(max_angular_speed4, _mm_max_ps(min_angular_speed4, angular.z));
+
+        StoreVec3x4(&linear_velocities[i], linear);
+        StoreVec3x4(&angular_velocities[i], angular);
+    }
+#endif
+
+    // The rows left over, or every row without SSE2.
+    for (; i < end; ++i)
+    {
+        auto vx = linear_velocities[i].x;
+        auto vy = linear_velocities[i].y;
+        auto vz = linear_velocities[i].z;
+        auto wz = angular_velocities[i].z;
+
+        if constexpr (Accelerate)
+        {
+            // Gravity is mass-independent, but doesn't move a body whose position is locked.
+            const auto gravity_mask = static_cast<float>(inv_masses[i] > 0.0f);
+            vx += (linear_accelerations[i].x + params.gravity.x * gravity_mask) * delta_time;
+            vy += (linear_accelerations[i].y + params.gravity.y * gravity_mask) * delta_time;
+            vz += (linear_accelerations[i].z + params.gravity.z * gravity_mask) * delta_time;
+            wz += angular_accelerations[i].z * delta_time;
+        }
+        linear_accelerations[i] = {};
+        angular_accelerations[i] = {};
+
+        vx *= linear_keep;
+        vy *= linear_keep;
+        vz *= linear_keep;
+        wz *= angular_keep;
+
+        // A zero velocity gives an infinite ratio, which leaves the velocity as it is.
+        const auto scale = std::min(1.0f, params.max_linear_speed / std::sqrt(vx * vx + vy * vy + vz * vz));
+        linear_velocities[i] = {vx * scale, vy * scale, vz * scale};
+        angular_velocities[i].z = std::clamp(wz, -params.max_angular_speed, params.max_angular_speed);
+    }
+}
+
+void BodyStorage::SwapRows(int first, int second)
+{
+    std::swap(transforms[first], transforms[second]);
+    std::swap(linear_velocities[first], linear_velocities[second]);
+    std::swap(angular_velocities[first], angular_velocities[second]);
+    std::swap(linear_accelerations[first], linear_accelerations[second]);
+    std::swap(angular_accelerations[first], angular_accelerations[second]);
+    std::swap(linear_pseudo_velocities[first], linear_pseudo_velocities[second]);
+    std::swap(angular_pseudo_velocities[first], angular_pseudo_velocities[second]);
+    std::swap(inv_masses[first], inv_masses[second]);
+    std::swap(inv_inertias[first], inv_inertias[second]);
+    std::swap(owners[first], owners[second]);
+}
+
+bool BodyStorage::IsStaticRow(int index) const
+{
+    return inv_masses[index] < epsilon && inv_inertias[index] < epsilon;
+}
+
+void BodyStorage::IntegrateVelocities(int begin, int end, const Vec3& gravity, float delta_time)
+{
+    auto i = begin;
+#ifdef PHYSICS_INTEGRATE_SSE2
+    const auto delta_time4 = _mm_set1_ps(delta_time);
+    for (; i + 4 <= end; i += 4)
+    {
+        auto linear = LoadVec3x4(&linear_velocities[i]);
+        auto angular = LoadVec3x4(&angular_velocities[i]);
+        AccelerateVec3x4(*this, i, linear, angular.z, gravity, delta_time4);
+        StoreVec3x4(&linear_velocities[i], linear);
+        StoreVec3x4(&angular_velocities[i], angular);
+    }
+#endif
+
+    for (; i < end; ++i)
+    {
+        const auto gravity_mask = static_cast<float>(inv_masses[i] > 0.0f);
+        linear_velocities[i].x += (linear_accelerations[i].x + gravity.x * gravity_mask) * delta_time;
+        linear_velocities[i].y += (linear_accelerations[i].y + gravity.y * gravity_mask) * delta_time;
+        linear_velocities[i].z += (linear_accelerations[i].z + gravity.z * gravity_mask) * delta_time;
+        angular_velocities[i].z += angular_accelerations[i].z * delta_time;
+    }
+}
+
+void BodyStorage::IntegratePositions(int begin, int end, float delta_time)
+{
+    auto i = begin;
+#ifdef PHYSICS_INTEGRATE_SSE2
+    const auto delta_time4 = _mm_set1_ps(delta_time);
+    for (; i + 4 <= end; i += 4)
+    {
+        const auto linear = LoadVec3x4(&linear_velocities[i]);
+        const auto linear_pseudo = LoadVec3x4(&linear_pseudo_velocities[i]);
+        const auto angular = LoadVec3x4(&angular_velocities[i]);
+        const auto angular_pseudo = LoadVec3x4(&angular_pseudo_velocities[i]);
+
+        // A transform is a row of x, y, z and rotation,
+        // so the offsets are transposed into the same rows.
+        auto dx = _mm_mul_ps(_mm_add_ps(linear.x, linear_pseudo.x), delta_time4);
+        auto dy = _mm_mul_ps(_mm_add_ps(linear.y, linear_pseudo.y), delta_time4);
+        auto dz = _mm_mul_ps(_mm_add_ps(linear.z, linear_pseudo.z), delta_time4);
+        auto drotation = _mm_mul_ps(_mm_add_ps(angular.z, angular_pseudo.z), delta_time4);
+        _MM_TRANSPOSE4_PS(dx, dy, dz, drotation);
+
+        auto* rows = reinterpret_cast<float*>(&transforms[i]);
+        _mm_storeu_ps(rows, _mm_add_ps(_mm_loadu_ps(rows), dx));
+        _mm_storeu_ps(rows + 4, _mm_add_ps(_mm_loadu_ps(rows + 4), dy));
+        _mm_storeu_ps(rows + 8, _mm_add_ps(_mm_loadu_ps(rows + 8), dz));
+        _mm_storeu_ps(rows + 12, _mm_add_ps(_mm_loadu_ps(rows + 12), drotation));
+
+        ClearVec3x4(&linear_pseudo_velocities[i]);
+        ClearVec3x4(&angular_pseudo_velocities[i]);
+    }
+#endif
+
+    for (; i < end; ++i)
+    {
+        transforms[i].AddPosition((linear_velocities[i] + linear_pseudo_velocities[i]) * delta_time);
+        transforms[i].AddRotation((angular_velocities[i].z + angular_pseudo_velocities[i].z) * delta_time);
+
+        // Pseudo velocity is only valid for a single integration.
+        linear_pseudo_velocities[i] = {};
+        angular_pseudo_velocities[i] = {};
+    }
+}
+
+void BodyStorage::FinishVelocities(int begin, int end, const IntegrationParameters& params)
+{
+    UpdateVelocityRange<false>(*this, begin, end, params, 0.0f);
+}
+
+void BodyStorage::Integrate(int begin, int end, const IntegrationParameters& params, float delta_time)
+{
+    // Positions move with the velocity of the previous step.
+    IntegratePositions(begin, end, delta_time);
+    UpdateVelocityRange<true>(*this, begin, end, params, delta_time);
+}
+
+Vec3 BodyStorage::GlobalVelocity(int index, const Vec3& rel_pos) const
+{
+    return linear_velocities[index] + angular_velocities[index].Cross(rel_pos);
+}
+
+void BodyStorage::ApplyInstantImpulse(int index, const Vec3& rel_impact_pos, const Vec3& impulse)
+{
+    angular_velocities[index] += rel_impact_pos.Cross(impulse) * inv_inertias[index];
+    linear_velocities[index] += impulse * inv_masses[index];
+}
+
+} // namespace physics
@@ -0,0 +1,74 @@
+#include "Broadphase.h"
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace physics
+{
+
+/**
+ * @brief Visit the pairs found by sort and sweep, in no particular order.
+ *
+ * @param order Body indices sorted by the lower bound of the x-axis.
+ */
+template<typename Func>
+void SweepOverlappingPairs(std::span<const int> order, std::span<const Vec3> lower, std::span<const Vec3> upper, Func&& func)
+{
+    for (int i = 0; i < order.size(); ++i)
+    {
+        const auto body1 = order[i];
+
+        // Every later body starts further on the x-axis,
+        // so we can stop at the first one starting after this body ends.
+        for (int j = i + 1; j < order.size() && lower[order[j]].x <= upper[body1].x; ++j)
+        {
+            const auto body2 = order[j];
+            if (lower[body2].y <= upper[body1].y && lower[body1].y <= upper[body2].y)
+            {
+                func(BodyPair{std::min(body1, body2), std::max(body1, body2)});
+            }
+        }
+    }
+}
+
+std::span<BodyPair> FindCandidatePairs(std::span<const physics::Transform> transforms, std::span<const float> radii, FrameArena& arena)
+{
+    assert(transforms.size() == radii.size());
+
+    const auto num_bodies = transforms.size();
+    auto lower = arena.AllocateArray<Vec3>(num_bodies);
+    auto upper = arena.AllocateArray<Vec3>(num_bodies);
+    auto order = arena.AllocateArray<int>(num_bodies);
+    for (int i = 0; i < num_bodies; ++i)
+    {
+        // Slightly enlarge the bounds, so that rounding errors never drop
+        // a pair which the exact distance test would have accepted.
+        const auto extent = radii[i] * 1.0001f + 0.0001f;
+        const auto& position = transforms[i].Position();
+        lower[i] = position - Vec3{extent, extent};
+        upper[i] = position + Vec3{extent, extent};
+    }
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&lower](int a, int b) {
+        return lower[a].x < lower[b].x;
+    });
+
+    // Count first, since the arena cannot grow an allocation.
+    auto num_pairs = std::size_t{0};
+    SweepOverlappingPairs(order, lower, upper, [&num_pairs](const BodyPair&) {
+        ++num_pairs;
+    });
+
+    auto pairs = arena.AllocateArray<BodyPair>(num_pairs);
+    auto num_written = std::size_t{0};
+    SweepOverlappingPairs(order, lower, upper, [&](const BodyPair& pair) {
+        pairs[num_written++] = pair;
+    });
+
+    std::sort(pairs.begin(), pairs.end(), [](const BodyPair& a, const BodyPair& b) {
+        return a.Key() < b.Key();
+    });
+    return pairs;
+}
+
+} // namespace physics
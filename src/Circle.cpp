@@ -1,21 +1,23 @@
 #include "Circle.h"
 #include "ConvexPolygon.h"
 #include "Angle.h"
+#include "PoolAllocator.h"
 
 namespace physics
 {
 
 Circle::Circle(float radius)
-    : m_shape(radius)
+    : m_radius(radius)
+{}
+
+float Circle::BoundaryRadius() const
 {
-    // sf::CircleShape has origin on the corner,
-    // so we should adjust it to the origin.
-    m_shape.setOrigin({radius, radius});
+    return m_radius;
 }
 
-float Circle::BoundaryRadius() const
+std::shared_ptr<ICollider> Circle::Clone() const
 {
-    return m_shape.getRadius();
+    return MakePooled<Circle>(*this);
 }
 
 bool Circle::IsPointInside(const Vec3& local_point) const
@@ -33,16 +35,6 @@ Vec3 Circle::CenterOfMass() const
     return Transform().Position();
 }
 
-sf::Shape& Circle::SFMLShape()
-{
-    return m_shape;
-}
-
-const sf::Shape& Circle::SFMLShape() const
-{
-    return m_shape;
-}
-
 std::optional<CollisionInfo> Circle::CheckCollision(const ICollider* other) const
 {
     return other->CheckCollisionAccept(this);
@@ -87,6 +79,7 @@ std::optional<CollisionInfo> Circle::CheckCollisionAccept(const Circle* other) c
         // and the line connecting centers of 'this' and 'other'.
         const auto contact_point = other->Transform().Position() + result.normal * other->BoundaryRadius();
         result.contacts.push_back(contact_point);
+        result.contact_depths.push_back(result.penetration_depth);
         return result;
     }
     // Case 2) they were too far from each other...
@@ -148,6 +141,7 @@ std::optional<CollisionInfo> Circle::CheckCollisionAccept(const ConvexPolygon* o
                 // required to separate two objects.
                 // Therefore, this must take radius into account.
                 collision.penetration_depth = circle_radius + dist_from_edge;
+                collision.contact_depths.push_back(collision.penetration_depth);
             }
             else
             {
@@ -164,6 +158,7 @@ std::optional<CollisionInfo> Circle::CheckCollisionAccept(const ConvexPolygon* o
                 // The circle barely touches the polygon when dist_from_edge == circle_radius
                 // and in this case, circle_radius is always greater than dist_from_edge.
                 collision.penetration_depth = circle_radius - dist_from_edge;
+                collision.contact_depths.push_back(collision.penetration_depth);
             }
 
             // Keep recording the collision information with minimum penetration depth.
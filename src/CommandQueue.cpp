@@ -0,0 +1,58 @@
+#include "CommandQueue.h"
+#include <cassert>
+#include <thread>
+
+namespace physics
+{
+
+CommandQueue::CommandQueue(std::size_t capacity)
+    : m_commands(capacity)
+{
+    assert(capacity > 0);
+}
+
+void CommandQueue::Push(Command command)
+{
+    while (!TryPush(command))
+    {
+        std::this_thread::yield();
+    }
+}
+
+bool CommandQueue::TryPush(Command& command)
+{
+    const auto tail = m_tail.load(std::memory_order_relaxed);
+    const auto head = m_head.load(std::memory_order_acquire);
+    if (tail - head == m_commands.size())
+    {
+        return false;
+    }
+
+    m_commands[tail % m_commands.size()] = std::move(command);
+
+    // Publishes the command to the consumer.
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+int CommandQueue::Drain(World& world)
+{
+    const auto head = m_head.load(std::memory_order_relaxed);
+    const auto tail = m_tail.load(std::memory_order_acquire);
+
+    // Commands pushed while draining are left for the next call.
+    for (auto i = head; i != tail; ++i)
+    {
+        // Moved out and released before running,
+        // so that the producer can reuse the slot while the command runs.
+        auto& slot = m_commands[i % m_commands.size()];
+        auto command = std::move(slot);
+        slot = nullptr;
+        m_head.store(i + 1, std::memory_order_release);
+
+        command(world);
+    }
+    return static_cast<int>(tail - head);
+}
+
+} // namespace physics
@@ -0,0 +1,442 @@
+#include "ContactConstraint.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+
+namespace physics
+{
+
+/**
+ * @return Tangent direction of a contact, perpendicular to the @p normal.
+ */
+Vec3 ContactTangent(const Vec3& normal)
+{
+    return normal.Cross(Vec3{.z = 1});
+}
+
+ContactBlockMatrix::ContactBlockMatrix(
+    const Rigidbody* object1,
+    const Rigidbody* object2,
+    const std::array<Vec3, 2>& rel_anchors1,
+    const std::array<Vec3, 2>& rel_anchors2,
+    const Vec3& normal
+)
+{
+    // Angular part of the jacobian, which is the torque arm of a normal impulse.
+    const auto arm1a = rel_anchors1[0].Cross(normal).z;
+    const auto arm1b = rel_anchors1[1].Cross(normal).z;
+    const auto arm2a = rel_anchors2[0].Cross(normal).z;
+    const auto arm2b = rel_anchors2[1].Cross(normal).z;
+
+    const auto inv_mass = object1->InverseMass() + object2->InverseMass();
+    const auto inv_inertia1 = object1->InverseInertia();
+    const auto inv_inertia2 = object2->InverseInertia();
+
+    k11 = inv_mass + inv_inertia1 * arm1a * arm1a + inv_inertia2 * arm2a * arm2a;
+    k22 = inv_mass + inv_inertia1 * arm1b * arm1b + inv_inertia2 * arm2b * arm2b;
+    k12 = inv_mass + inv_inertia1 * arm1a * arm1b + inv_inertia2 * arm2a * arm2b;
+}
+
+bool ContactBlockMatrix::IsWellConditioned() const
+{
+    // Upper limit of the condition number we trust.
+    constexpr auto max_condition_number = 1000.0f;
+
+    return k11 * k11 < max_condition_number * (k11 * k22 - k12 * k12);
+}
+
+std::optional<std::array<float, 2>> ContactBlockMatrix::Solve(float c1, float c2) const
+{
+    // Since there are only two unknowns, we can enumerate
+    // all four combinations of active points and pick the one
+    // that satisfies the complementarity conditions.
+
+    // Case 1) both points are pushing: x = -inverse(K) * c.
+    const auto det = k11 * k22 - k12 * k12;
+    const auto x1 = -(k22 * c1 - k12 * c2) / det;
+    const auto x2 = -(k11 * c2 - k12 * c1) / det;
+    if (x1 >= 0.0f && x2 >= 0.0f)
+    {
+        return std::array{x1, x2};
+    }
+
+    // Case 2) only the first point is pushing, while the second one separates.
+    const auto only_x1 = -c1 / k11;
+    if (only_x1 >= 0.0f && k12 * only_x1 + c2 >= 0.0f)
+    {
+        return std::array{only_x1, 0.0f};
+    }
+
+    // Case 3) only the second point is pushing, while the first one separates.
+    const auto only_x2 = -c2 / k22;
+    if (only_x2 >= 0.0f && k12 * only_x2 + c1 >= 0.0f)
+    {
+        return std::array{0.0f, only_x2};
+    }
+
+    // Case 4) both points are separating.
+    if (c1 >= 0.0f && c2 >= 0.0f)
+    {
+        return std::array{0.0f, 0.0f};
+    }
+
+    return {};
+}
+
+ContactConstraint::ContactConstraint(const CollisionPair& collision)
+    : object1(collision.object1)
+    , object2(collision.object2)
+    , normal(collision.info.normal)
+    , material(collision.object1->Material().Average(collision.object2->Material()))
+{
+    assert(collision.info.contacts.size() == collision.info.contact_depths.size());
+    assert(collision.info.contacts.size() <= 2);
+
+    const auto tangent = ContactTangent(normal);
+    for (int i = 0; i < collision.info.contacts.size(); ++i)
+    {
+        const auto& contact = collision.info.contacts[i];
+
+        auto point = ContactPointConstraint{};
+        point.local_anchor1 = object1->Transform().LocalPosition(contact);
+        point.local_anchor2 = object2->Transform().LocalPosition(contact);
+        point.rel_anchor1 = contact - object1->Transform().Position();
+        point.rel_anchor2 = contact - object2->Transform().Position();
+        point.base_separation = -collision.info.contact_depths[i];
+        point.normal_mass = EffectiveMass(object1, object2, point.rel_anchor1, point.rel_anchor2, normal);
+        point.tangent_mass = EffectiveMass(object1, object2, point.rel_anchor1, point.rel_anchor2, tangent);
+
+        const auto rel_velocity = object2->GlobalVelocity(point.rel_anchor2) - object1->GlobalVelocity(point.rel_anchor1);
+        point.relative_velocity = rel_velocity.Dot(normal);
+
+        points.push_back(point);
+    }
+
+    if (points.size() == 2)
+    {
+        const auto matrix = ContactBlockMatrix(
+            object1, object2,
+            {points[0].rel_anchor1, points[1].rel_anchor1},
+            {points[0].rel_anchor2, points[1].rel_anchor2},
+            normal
+        );
+        if (matrix.IsWellConditioned())
+        {
+            block = matrix;
+        }
+    }
+}
+
+void ContactConstraint::WarmStart()
+{
+    const auto tangent = ContactTangent(normal);
+    for (const auto& point : points)
+    {
+        const auto impulse = normal * point.normal_impulse + tangent * point.tangent_impulse;
+        object1->ApplyInstantImpulse(point.rel_anchor1, -impulse);
+        object2->ApplyInstantImpulse(point.rel_anchor2, impulse);
+    }
+}
+
+void ContactConstraint::Solve(const Softness& softness, float inv_time_step, float penetration_allowance, float max_push_velocity, bool use_bias)
+{
+    // Decide the velocity bias and softness of each point.
+    auto biases = std::array{0.0f, 0.0f};
+    auto mass_scales = std::array{1.0f, 1.0f};
+    auto impulse_scales = std::array{0.0f, 0.0f};
+    for (int i = 0; i < points.size(); ++i)
+    {
+        // Recompute the separation using the anchors, which moved along with the objects.
+        // Since both anchors were on the same point when the collision was detected,
+        // their displacement tells how much the objects approached or separated since then.
+        const auto& point = points[i];
+        const auto anchor1 = object1->Transform().GlobalPosition(point.local_anchor1);
+        const auto anchor2 = object2->Transform().GlobalPosition(point.local_anchor2);
+        const auto separation = point.base_separation + (anchor2 - anchor1).Dot(normal) + penetration_allowance;
+
+        if (separation > 0.0f)
+        {
+            // The objects are not touching yet.
+            // Allow them to approach just enough to close the gap in this substep.
+            biases[i] = separation * inv_time_step;
+        }
+        else if (use_bias)
+        {
+            // Push the objects apart like a damped spring.
+            // The speed is limited so that a deep overlap doesn't launch them away.
+            biases[i] = std::max(softness.bias_rate * separation, -max_push_velocity);
+            mass_scales[i] = softness.mass_scale;
+            impulse_scales[i] = softness.impulse_scale;
+        }
+    }
+
+    // Non-penetration constraint.
+    if (!block || !SolveNormalBlock(biases, mass_scales, impulse_scales))
+    {
+        for (int i = 0; i < points.size(); ++i)
+        {
+            auto& point = points[i];
+            const auto rel_velocity = object2->GlobalVelocity(point.rel_anchor2) - object1->GlobalVelocity(point.rel_anchor1);
+            const auto velocity_along_normal = rel_velocity.Dot(normal);
+
+            // Clamp the accumulated impulse, not the incremental one.
+            // Objects can only push each other, but an iteration
+            // is allowed to undo the excessive push of previous iterations.
+            const auto impulse_magnitude = -point.normal_mass * mass_scales[i] * (velocity_along_normal + biases[i]) - impulse_scales[i] * point.normal_impulse;
+            const auto new_impulse = std::max(point.normal_impulse + impulse_magnitude, 0.0f);
+            const auto impulse = normal * (new_impulse - point.normal_impulse);
+            point.normal_impulse = new_impulse;
+
+            object1->ApplyInstantImpulse(point.rel_anchor1, -impulse);
+            object2->ApplyInstantImpulse(point.rel_anchor2, impulse);
+        }
+    }
+
+    // Friction constraint.
+    const auto tangent = ContactTangent(normal);
+    for (auto& point : points)
+    {
+        const auto rel_velocity = object2->GlobalVelocity(point.rel_anchor2) - object1->GlobalVelocity(point.rel_anchor1);
+        const auto velocity_along_tangent = rel_velocity.Dot(tangent);
+
+        // Try to stop the sliding motion completely,
+        // as long as the static friction can hold it.
+        // Otherwise, the dynamic friction takes over.
+        auto new_impulse = point.tangent_impulse - point.tangent_mass * velocity_along_tangent;
+        if (std::abs(new_impulse) > point.normal_impulse * material.static_friction)
+        {
+            const auto max_dynamic_friction = point.normal_impulse * material.dynamic_friction;
+            new_impulse = std::clamp(new_impulse, -max_dynamic_friction, max_dynamic_friction);
+        }
+        const auto impulse = tangent * (new_impulse - point.tangent_impulse);
+        point.tangent_impulse = new_impulse;
+
+        object1->ApplyInstantImpulse(point.rel_anchor1, -impulse);
+        object2->ApplyInstantImpulse(point.rel_anchor2, impulse);
+    }
+}
+
+bool ContactConstraint::SolveNormalBlock(const std::array<float, 2>& biases, const std::array<float, 2>& mass_scales, const std::array<float, 2>& impulse_scales)
+{
+    auto& point1 = points[0];
+    auto& point2 = points[1];
+
+    const auto rel_velocity1 = object2->GlobalVelocity(point1.rel_anchor2) - object1->GlobalVelocity(point1.rel_anchor1);
+    const auto rel_velocity2 = object2->GlobalVelocity(point2.rel_anchor2) - object1->GlobalVelocity(point2.rel_anchor1);
+    const auto velocity_along_normal1 = rel_velocity1.Dot(normal);
+    const auto velocity_along_normal2 = rel_velocity2.Dot(normal);
+
+    // We solve for the new accumulated impulse x, instead of the increment.
+    // Each row is the block version of the single point update
+    // "K * (x - old) = -mass_scale * (velocity + bias) - impulse_scale * k * old",
+    // rearranged into the form "K * x + c = 0".
+    const auto old1 = point1.normal_impulse;
+    const auto old2 = point2.normal_impulse;
+    const auto c1 = mass_scales[0] * (velocity_along_normal1 + biases[0])
+        + impulse_scales[0] * block->k11 * old1
+        - (block->k11 * old1 + block->k12 * old2);
+    const auto c2 = mass_scales[1] * (velocity_along_normal2 + biases[1])
+        + impulse_scales[1] * block->k22 * old2
+        - (block->k12 * old1 + block->k22 * old2);
+
+    const auto solution = block->Solve(c1, c2);
+    if (!solution)
+    {
+        return false;
+    }
+
+    const auto impulse1 = normal * (solution->at(0) - old1);
+    const auto impulse2 = normal * (solution->at(1) - old2);
+    point1.normal_impulse = solution->at(0);
+    point2.normal_impulse = solution->at(1);
+
+    object1->ApplyInstantImpulse(point1.rel_anchor1, -impulse1);
+    object2->ApplyInstantImpulse(point1.rel_anchor2, impulse1);
+    object1->ApplyInstantImpulse(point2.rel_anchor1, -impulse2);
+    object2->ApplyInstantImpulse(point2.rel_anchor2, impulse2);
+
+    return true;
+}
+
+void ContactConstraint::ApplyRestitution(float threshold)
+{
+    if (material.restitution == 0.0f)
+    {
+        return;
+    }
+
+    for (auto& point : points)
+    {
+        // Slow collisions, such as an object resting on the ground, are not bounced.
+        // Otherwise, gravity keeps generating tiny bounces which never settle.
+        if (point.relative_velocity > -threshold || point.normal_impulse == 0.0f)
+        {
+            continue;
+        }
+
+        // Target the separating velocity given by Newton's law of restitution.
+        const auto rel_velocity = object2->GlobalVelocity(point.rel_anchor2) - object1->GlobalVelocity(point.rel_anchor1);
+        const auto velocity_along_normal = rel_velocity.Dot(normal);
+
+        const auto impulse_magnitude = -point.normal_mass * (velocity_along_normal + material.restitution * point.relative_velocity);
+        const auto new_impulse = std::max(point.normal_impulse + impulse_magnitude, 0.0f);
+        const auto impulse = normal * (new_impulse - point.normal_impulse);
+        point.normal_impulse = new_impulse;
+
+        object1->ApplyInstantImpulse(point.rel_anchor1, -impulse);
+        object2->ApplyInstantImpulse(point.rel_anchor2, impulse);
+    }
+}
+
+void ContactConstraint::SolvePseudoVelocity(float inv_time_step, float penetration_allowance, float correction_ratio)
+{
+    for (auto& point : points)
+    {
+        // Unlike the velocity solver, positions do not change until
+        // the pseudo velocity is integrated, so the separation stays the same.
+        const auto penetration = -point.base_separation - penetration_allowance;
+        if (penetration <= 0.0f)
+        {
+            continue;
+        }
+
+        // The pseudo velocity which removes 'correction_ratio' of the overlap in a single time step.
+        const auto target_velocity = penetration * correction_ratio * inv_time_step;
+
+        const auto rel_velocity = object2->GlobalPseudoVelocity(point.rel_anchor2) - object1->GlobalPseudoVelocity(point.rel_anchor1);
+        const auto velocity_along_normal = rel_velocity.Dot(normal);
+
+        const auto impulse_magnitude = point.normal_mass * (target_velocity - velocity_along_normal);
+        const auto new_impulse = std::max(point.pseudo_impulse + impulse_magnitude, 0.0f);
+        const auto impulse = normal * (new_impulse - point.pseudo_impulse);
+        point.pseudo_impulse = new_impulse;
+
+        // Static objects are never written,
+        // which allows them to be shared among concurrent batches.
+        if (!object1->IsStatic())
+        {
+            object1->ApplyPseudoImpulse(point.rel_anchor1, -impulse);
+        }
+        if (!object2->IsStatic())
+        {
+            object2->ApplyPseudoImpulse(point.rel_anchor2, impulse);
+        }
+    }
+}
+
+int ContactBatches::Count() const
+{
+    return offsets.empty() ? 0 : static_cast<int>(offsets.size()) - 1;
+}
+
+std::span<const int> ContactBatches::Batch(int batch) const
+{
+    return std::span<const int>(indices).subspan(offsets[batch], offsets[batch + 1] - offsets[batch]);
+}
+
+/**
+ * @return Storage for @p count objects of type @p T, all set to zero.
+ */
+template<typename T>
+std::span<T> AllocateZeroed(FrameArena& arena, std::size_t count)
+{
+    const auto values = arena.AllocateArray<T>(count);
+    std::uninitialized_fill(values.begin(), values.end(), T{0});
+    return values;
+}
+
+ContactBatches PartitionIntoBatches(std::span<const ContactConstraint> constraints, int num_bodies, FrameArena& arena)
+{
+    if (constraints.empty())
+    {
+        return {};
+    }
+
+    // A constraint conflicts with at most 2 * (max_degree - 1) others,
+    // so the greedy coloring never needs more batches than this.
+    auto degrees = AllocateZeroed<int>(arena, num_bodies);
+    auto max_degree = 1;
+    for (const auto& constraint : constraints)
+    {
+        for (const auto* object : {constraint.object1, constraint.object2})
+        {
+            if (!object->IsStatic())
+            {
+                max_degree = std::max(max_degree, ++degrees[object->BodyIndex()]);
+            }
+        }
+    }
+    const auto max_batches = 2 * max_degree - 1;
+
+    // One bit per batch for each body, set if the body appears in the batch.
+    // Static objects are never written, so they never occupy a batch.
+    constexpr auto bits_per_word = 64;
+    const auto words_per_body = (max_batches + bits_per_word - 1) / bits_per_word;
+    auto used_batches = AllocateZeroed<std::uint64_t>(arena, std::size_t(num_bodies) * words_per_body);
+    const auto used_words = [&](const Rigidbody* object) {
+        return used_batches.subspan(std::size_t(object->BodyIndex()) * words_per_body, words_per_body);
+    };
+
+    auto batch_of = arena.AllocateArray<int>(constraints.size());
+    auto num_batches = 0;
+    for (int i = 0; i < constraints.size(); ++i)
+    {
+        const auto* object1 = constraints[i].object1;
+        const auto* object2 = constraints[i].object2;
+
+        // Choose the first batch where neither object appears.
+        auto batch = -1;
+        for (int word = 0; batch < 0; ++word)
+        {
+            auto used = std::uint64_t{0};
+            for (const auto* object : {object1, object2})
+            {
+                if (!object->IsStatic())
+                {
+                    used |= used_words(object)[word];
+                }
+            }
+            if (~used != 0)
+            {
+                batch = word * bits_per_word + std::countr_one(used);
+            }
+        }
+        assert(batch < max_batches);
+
+        for (const auto* object : {object1, object2})
+        {
+            if (!object->IsStatic())
+            {
+                used_words(object)[batch / bits_per_word] |= std::uint64_t{1} << (batch % bits_per_word);
+            }
+        }
+        batch_of[i] = batch;
+        num_batches = std::max(num_batches, batch + 1);
+    }
+
+    // Counting sort by batch, which keeps the original order within each batch.
+    auto batches = ContactBatches{};
+    batches.offsets = AllocateZeroed<int>(arena, num_batches + 1);
+    for (const auto batch : batch_of)
+    {
+        ++batches.offsets[batch + 1];
+    }
+    for (int i = 0; i < num_batches; ++i)
+    {
+        batches.offsets[i + 1] += batches.offsets[i];
+    }
+
+    auto cursors = arena.AllocateArray<int>(num_batches);
+    std::copy(batches.offsets.begin(), batches.offsets.end() - 1, cursors.begin());
+    batches.indices = arena.AllocateArray<int>(constraints.size());
+    for (int i = 0; i < constraints.size(); ++i)
+    {
+        batches.indices[cursors[batch_of[i]]++] = i;
+    }
+
+    return batches;
+}
+
+} // namespace physics
@@ -1,60 +1,34 @@
 #include "ConvexPolygon.h"
 #include "Circle.h"
+#include "Profiler.h"
 #include <cassert>
 
 namespace physics
 {
 
 ConvexPolygon::ConvexPolygon(const std::vector<Vec3>& vertices)
-    : m_vertices(vertices)
-{
-    const auto num_vertices = vertices.size();
-    m_shape.setPointCount(num_vertices);
-    for (int i = 0; i < num_vertices; ++i)
-    {
-        // Record edge information.
-        const auto& curr = vertices[i];
-        const auto& next = vertices[(i + 1) % num_vertices];
-        m_edges.emplace_back(curr, next);
-
-        // Construct SFML shape.
-        m_shape.setPoint(i, {curr.x, curr.y});
-
-        // Record the length of the farthest vertex as boundary radius.
-        m_boundary_radius = std::max(m_boundary_radius, curr.Magnitude());
+    : m_geometry(MakePooled<PolygonGeometry>(vertices))
+{}
 
-        // Assuming uniform density,
-        // the center of mass should be the average of all vertices.
-        m_center_of_mass += curr / num_vertices;
-    }
-
-    ValidateCounterClockwiseOrder();
-}
+ConvexPolygon::ConvexPolygon(std::shared_ptr<const PolygonGeometry> geometry)
+    : m_geometry(std::move(geometry))
+{}
 
-void ConvexPolygon::ValidateCounterClockwiseOrder() const
+float ConvexPolygon::BoundaryRadius() const
 {
-    const auto num_edges = m_edges.size();
-    for (int i = 0; i < m_edges.size(); ++i)
-    {
-        const auto& curr = m_edges[i];
-        const auto& next = m_edges[(i + 1) % num_edges];
-        if (curr.Tangent().Cross(next.Tangent()).z < 0.0f)
-        {
-            throw std::exception("the polygon was not convex");
-        }
-    }
+    return m_geometry->BoundaryRadius();
 }
 
-float ConvexPolygon::BoundaryRadius() const
+std::shared_ptr<ICollider> ConvexPolygon::Clone() const
 {
-    return m_boundary_radius;
+    return MakePooled<ConvexPolygon>(*this);
 }
 
 bool ConvexPolygon::IsPointInside(const Vec3& local_point) const
 {
     // Key idea: since vertices are ordered counter-clockwise,
     //           an internal point should be on the left side of each edge.
-    for (const auto& edge : m_edges)
+    for (const auto& edge : Edges())
     {
         if (edge.Tangent().Cross(local_point - edge.Start()).z < 0.0f)
         {
@@ -66,35 +40,12 @@ bool ConvexPolygon::IsPointInside(const Vec3& local_point) const
 
 float ConvexPolygon::Area() const
 {
-    // Key idea: the magnitude of cross product between two vectors A and B
-    //           is twice the area of triangle OAB (O is the origin).
-    auto area = 0.0f;
-
-    auto num_vertices = m_vertices.size();
-    for (int i = 0; i < num_vertices; ++i)
-    {
-        const auto& curr = m_vertices[i];
-        const auto& next = m_vertices[(i + 1) % num_vertices];
-
-        area += curr.Cross(next).z / 2.0f;
-    }
-
-    return area;
+    return m_geometry->Area();
 }
 
 Vec3 ConvexPolygon::CenterOfMass() const
 {
-    return m_center_of_mass;
-}
-
-sf::Shape& ConvexPolygon::SFMLShape()
-{
-    return m_shape;
-}
-
-const sf::Shape& ConvexPolygon::SFMLShape() const
-{
-    return m_shape;
+    return m_geometry->CenterOfMass();
 }
 
 std::optional<CollisionInfo> ConvexPolygon::CheckCollision(const ICollider* other) const
@@ -164,9 +115,11 @@ std::optional<CollisionInfo> ConvexPolygon::CheckCollisionAccept(const ConvexPol
     for (auto end_point : {penetrating_segment.Start(), penetrating_segment.End()})
     {
         // Note: points outside a polygon have positive dot product w.r.t. the edge normal.
-        if ((end_point - reference_edge.Start()).Dot(reference_edge.Normal()) < 0.0f)
+        const auto separation = (end_point - reference_edge.Start()).Dot(reference_edge.Normal());
+        if (separation < 0.0f)
         {
             result.contacts.push_back(end_point);
+            result.contact_depths.push_back(-separation);
         }
     }
     if (incident_obj == this)
@@ -181,24 +134,30 @@ std::optional<CollisionInfo> ConvexPolygon::CheckCollisionAccept(const ConvexPol
     return result;
 }
 
-const std::vector<Vec3>& ConvexPolygon::Vertices() const
+const PooledVector<Vec3>& ConvexPolygon::Vertices() const
 {
-    return m_vertices;
+    return m_geometry->Vertices();
 }
 
-const std::vector<LineSegment>& ConvexPolygon::Edges() const
+const PooledVector<LineSegment>& ConvexPolygon::Edges() const
 {
-    return m_edges;
+    return m_geometry->Edges();
+}
+
+const std::shared_ptr<const PolygonGeometry>& ConvexPolygon::Geometry() const
+{
+    return m_geometry;
 }
 
 ProjectionRange ConvexPolygon::Projection(const Vec3& local_direction) const
 {
     auto result = ProjectionRange{};
 
+    const auto& vertices = Vertices();
     auto is_first_entry = true;
-    for (int i = 0; i < m_vertices.size(); ++i)
+    for (int i = 0; i < vertices.size(); ++i)
     {
-        auto dot = m_vertices[i].Dot(local_direction);
+        auto dot = vertices[i].Dot(local_direction);
         if (is_first_entry || result.min > dot)
         {
             result.min = dot;
@@ -223,6 +182,8 @@ std::optional<Penetration> ConvexPolygon::FindMinimumPenetration(const ConvexPol
     // From now on, everything will be calculated under polygon1's coordinate system.
     for (const auto& edge : Edges())
     {
+        PHYSICS_PROFILE_ONLY(++LocalNarrowphaseCounters().sat_axes);
+
         // Projection of polygon1 onto the normal vector,
         // assuming that the polygon is placed on the origin.
         auto normal = edge.Normal();
@@ -0,0 +1,74 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cassert>
+
+namespace physics
+{
+
+FrameArena::FrameArena(std::size_t initial_capacity)
+{
+    AddBlock(initial_capacity);
+}
+
+void* FrameArena::Allocate(std::size_t size, std::size_t alignment)
+{
+    assert((alignment & (alignment - 1)) == 0);
+
+    // Align the offset from the block start. Blocks come from operator new[],
+    // which is aligned for any fundamental type.
+    auto aligned_offset = (m_offset + alignment - 1) & ~(alignment - 1);
+    if (aligned_offset + size > m_blocks.back().size)
+    {
+        // Grow geometrically, so that a large step needs only a few blocks.
+        AddBlock(std::max(size + alignment, m_blocks.back().size * 2));
+        aligned_offset = 0;
+    }
+
+    m_offset = aligned_offset + size;
+    return m_blocks.back().memory.get() + aligned_offset;
+}
+
+void FrameArena::Reset()
+{
+    // Merge all blocks into one, so that the next step fits in a single block.
+    if (m_blocks.size() > 1)
+    {
+        const auto capacity = Capacity();
+        m_blocks.clear();
+        AddBlock(capacity);
+    }
+
+    m_offset = 0;
+    m_bytes_in_previous_blocks = 0;
+}
+
+std::size_t FrameArena::BytesUsed() const
+{
+    return m_bytes_in_previous_blocks + m_offset;
+}
+
+std::size_t FrameArena::Capacity() const
+{
+    auto capacity = std::size_t{0};
+    for (const auto& block : m_blocks)
+    {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+void FrameArena::AddBlock(std::size_t min_size)
+{
+    if (!m_blocks.empty())
+    {
+        m_bytes_in_previous_blocks += m_offset;
+    }
+
+    m_blocks.push_back(Block{
+        .memory = std::make_unique<std::byte[]>(min_size),
+        .size = min_size
+    });
+    m_offset = 0;
+}
+
+} // namespace physics
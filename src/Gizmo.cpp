@@ -23,7 +23,7 @@ sf::Shape& Gizmo::Point(const Vec3& pos, const sf::Color& color)
 sf::Shape& Gizmo::Direction(const Vec3& pos, const Vec3& dir, const sf::Color& color)
 {
     m_direction.setPosition(pos.x, pos.y);
-    m_direction.setRotation(rad2deg(std::atan2f(dir.y, dir.x)));
+    m_direction.setRotation(rad2deg(std::atan2(dir.y, dir.x)));
     m_direction.setFillColor(color);
     
     return m_direction;
@@ -0,0 +1,234 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include <cassert>
+
+namespace physics
+{
+
+// The pool and index of the calling thread, set by the workers.
+thread_local const JobSystem* t_job_system = nullptr;
+thread_local int t_thread_index = 0;
+
+struct JobSystem::Task
+{
+    std::function<void()> function;
+
+    // Unfinished dependencies, plus one held by Submit() until every dependency is registered.
+    std::atomic<int> remaining_dependencies = 1;
+
+    // Guards successors and done.
+    std::mutex mutex;
+    std::vector<TaskHandle> successors;
+    std::atomic<bool> done = false;
+
+    // Keeps the task alive while it is queued.
+    TaskHandle self;
+    JobSystem* system = nullptr;
+};
+
+JobSystem::JobSystem(int num_threads)
+{
+    assert(num_threads > 0);
+
+    for (int i = 0; i < num_threads; ++i)
+    {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    // Thread index 0 is left for the threads outside the pool.
+    for (int i = 1; i < num_threads; ++i)
+    {
+        m_workers.emplace_back([this, i](std::stop_token stop_token) {
+            WorkerLoop(stop_token, i);
+        });
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    for (auto& worker : m_workers)
+    {
+        worker.request_stop();
+    }
+    m_wake.notify_all();
+}
+
+std::shared_ptr<JobSystem> JobSystem::Serial()
+{
+    static const auto serial = std::make_shared<JobSystem>(1);
+    return serial;
+}
+
+int JobSystem::ThreadCount() const
+{
+    return static_cast<int>(m_queues.size());
+}
+
+int JobSystem::ThreadIndex() const
+{
+    return t_job_system == this ? t_thread_index : 0;
+}
+
+JobSystem::TaskHandle JobSystem::Submit(std::function<void()> function, std::span<const TaskHandle> dependencies)
+{
+    auto task = std::make_shared<Task>();
+    task->function = std::move(function);
+    task->system = this;
+
+    for (const auto& dependency : dependencies)
+    {
+        auto lock = std::scoped_lock(dependency->mutex);
+        if (!dependency->done)
+        {
+            dependency->successors.push_back(task);
+            task->remaining_dependencies.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Every dependency is registered, so the task may run once they finish.
+    ReleaseDependency(task);
+    return task;
+}
+
+void JobSystem::Wait(const TaskHandle& task)
+{
+    while (!task->done.load(std::memory_order_acquire))
+    {
+        if (!TryRunJob())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::Schedule(const Job& job)
+{
+    auto& queue = *m_queues[ThreadIndex()];
+    auto queued = false;
+    {
+        auto lock = std::scoped_lock(queue.mutex);
+        if (queue.size < WorkQueue::capacity)
+        {
+            queue.jobs[(queue.front + queue.size) % WorkQueue::capacity] = job;
+            ++queue.size;
+            m_num_queued.fetch_add(1, std::memory_order_release);
+            queued = true;
+        }
+    }
+
+    if (!queued)
+    {
+        // Running it here is always correct, just not parallel.
+        job.function(job.context, job.index);
+        return;
+    }
+
+    // Taking the lock makes sure that a worker going to sleep sees the new job.
+    {
+        auto lock = std::scoped_lock(m_sleep_mutex);
+    }
+    m_wake.notify_one();
+}
+
+bool JobSystem::TryRunJob()
+{
+    const auto num_queues = ThreadCount();
+    const auto own_index = ThreadIndex();
+
+    auto job = Job{};
+    auto found = false;
+    for (int i = 0; i < num_queues && !found; ++i)
+    {
+        // Our own newest job first, and then the oldest job of the others.
+        const auto index = (own_index + i) % num_queues;
+        auto& queue = *m_queues[index];
+        auto lock = std::scoped_lock(queue.mutex);
+        if (queue.size == 0)
+        {
+            continue;
+        }
+
+        if (index == own_index)
+        {
+            job = queue.jobs[(queue.front + queue.size - 1) % WorkQueue::capacity];
+        }
+        else
+        {
+            job = queue.jobs[queue.front];
+            queue.front = (queue.front + 1) % WorkQueue::capacity;
+        }
+        --queue.size;
+        m_num_queued.fetch_sub(1, std::memory_order_relaxed);
+        found = true;
+    }
+
+    if (found)
+    {
+        PHYSICS_TRACE_SCOPE("job");
+        job.function(job.context, job.index);
+    }
+    return found;
+}
+
+void JobSystem::WaitForZero(const std::atomic<int>& remaining)
+{
+    while (remaining.load(std::memory_order_acquire) > 0)
+    {
+        if (!TryRunJob())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::WorkerLoop(std::stop_token stop_token, int thread_index)
+{
+    t_job_system = this;
+    t_thread_index = thread_index;
+    PHYSICS_PROFILE_ONLY(Tracer::Global().SetThreadName("worker " + std::to_string(thread_index)));
+
+    while (!stop_token.stop_requested())
+    {
+        if (TryRunJob())
+        {
+            continue;
+        }
+
+        auto lock = std::unique_lock(m_sleep_mutex);
+        m_wake.wait(lock, stop_token, [this] {
+            return m_num_queued.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+void JobSystem::RunTask(void* context, int)
+{
+    auto& task = *static_cast<Task*>(context);
+    task.function();
+
+    auto successors = std::vector<TaskHandle>{};
+    {
+        auto lock = std::scoped_lock(task.mutex);
+        task.done.store(true, std::memory_order_release);
+        successors.swap(task.successors);
+    }
+    for (const auto& successor : successors)
+    {
+        task.system->ReleaseDependency(successor);
+    }
+
+    // The task may be destroyed here, if nobody else holds its handle.
+    auto self = std::move(task.self);
+}
+
+void JobSystem::ReleaseDependency(const TaskHandle& task)
+{
+    if (task->remaining_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        task->self = task;
+        Schedule(Job{RunTask, task.get(), 0});
+    }
+}
+
+} // namespace physics
@@ -0,0 +1,441 @@
+#include "Joint.h"
+#include <algorithm>
+
+namespace physics
+{
+
+/**
+ * @return Displacement of the anchor from its object's center, in global coordinate.
+ */
+Vec3 RelativeAnchor(const AnchorPoint& anchor)
+{
+    return anchor.object->Transform().GlobalDirection(anchor.local_pos);
+}
+
+/**
+ * @return Velocity of @p end's anchor relative to @p start's anchor.
+ */
+Vec3 RelativeAnchorVelocity(const AnchorPoint& start, const AnchorPoint& end, const Vec3& rel_anchor1, const Vec3& rel_anchor2)
+{
+    return end.object->GlobalVelocity(rel_anchor2) - start.object->GlobalVelocity(rel_anchor1);
+}
+
+/**
+ * @brief Apply equal and opposite impulse on two anchors.
+ *        The end object receives @p impulse, while the start object receives -@p impulse.
+ */
+void ApplyAnchorImpulse(const AnchorPoint& start, const AnchorPoint& end, const Vec3& rel_anchor1, const Vec3& rel_anchor2, const Vec3& impulse)
+{
+    start.object->ApplyInstantImpulse(rel_anchor1, -impulse);
+    end.object->ApplyInstantImpulse(rel_anchor2, impulse);
+}
+
+/**
+ * @brief Apply equal and opposite angular impulse on two objects.
+ *        The end object receives @p angular_impulse.
+ */
+void ApplyAngularImpulse(const AnchorPoint& start, const AnchorPoint& end, float angular_impulse)
+{
+    start.object->ApplyInstantAngularImpulse(-angular_impulse);
+    end.object->ApplyInstantAngularImpulse(angular_impulse);
+}
+
+/**
+ * @brief Solve the symmetric 2x2 linear system "K * x = b".
+ *
+ * @return Zero vector if the matrix is singular.
+ */
+Vec3 SolveSymmetric2x2(float k11, float k12, float k22, const Vec3& b)
+{
+    auto det = k11 * k22 - k12 * k12;
+    if (det != 0.0f)
+    {
+        det = 1.0f / det;
+    }
+
+    return {
+        det * (k22 * b.x - k12 * b.y),
+        det * (k11 * b.y - k12 * b.x)
+    };
+}
+
+/**
+ * @brief Solve the constraint "both anchors are on the same point",
+ *        which is shared by revolute and weld joints.
+ *
+ * @param accumulated_impulse Accumulated impulse applied on the end object.
+ */
+void SolvePointConstraint(const AnchorPoint& start, const AnchorPoint& end, const Softness& softness, bool use_bias, Vec3& accumulated_impulse)
+{
+    const auto* object1 = start.object;
+    const auto* object2 = end.object;
+    const auto r1 = RelativeAnchor(start);
+    const auto r2 = RelativeAnchor(end);
+
+    auto bias = Vec3{};
+    auto mass_scale = 1.0f;
+    auto impulse_scale = 0.0f;
+    if (use_bias)
+    {
+        const auto separation = end.GlobalPosition() - start.GlobalPosition();
+        bias = separation * softness.bias_rate;
+        mass_scale = softness.mass_scale;
+        impulse_scale = softness.impulse_scale;
+    }
+
+    // Effective mass matrix of a point-to-point constraint.
+    const auto inv_mass = object1->InverseMass() + object2->InverseMass();
+    const auto inv_inertia1 = object1->InverseInertia();
+    const auto inv_inertia2 = object2->InverseInertia();
+    const auto k11 = inv_mass + r1.y * r1.y * inv_inertia1 + r2.y * r2.y * inv_inertia2;
+    const auto k12 = -r1.y * r1.x * inv_inertia1 - r2.y * r2.x * inv_inertia2;
+    const auto k22 = inv_mass + r1.x * r1.x * inv_inertia1 + r2.x * r2.x * inv_inertia2;
+
+    const auto rel_velocity = RelativeAnchorVelocity(start, end, r1, r2);
+    const auto b = SolveSymmetric2x2(k11, k12, k22, rel_velocity + bias);
+    const auto impulse = -b * mass_scale - accumulated_impulse * impulse_scale;
+    accumulated_impulse += impulse;
+
+    ApplyAnchorImpulse(start, end, r1, r2, impulse);
+}
+
+/**
+ * @brief Solve the lower and upper bound of a joint coordinate.
+ *
+ * @param position Current value of the joint coordinate.
+ * @param velocity Time derivative of @p position.
+ * @param effective_mass Impulse required to change @p velocity by 1.
+ * @param apply Callback that applies an impulse along the joint coordinate.
+ */
+template<typename Apply>
+void SolveLimit(JointLimit& limit, float position, float velocity, float effective_mass, const JointSolverContext& context, bool use_bias, Apply&& apply)
+{
+    // Both bounds are one-sided constraints, written as "C >= 0".
+    // For the upper bound, the direction of the coordinate is flipped.
+    const auto solve_bound = [&](float separation, float bound_velocity, float& accumulated_impulse) {
+        auto bias = 0.0f;
+        auto mass_scale = 1.0f;
+        auto impulse_scale = 0.0f;
+        if (separation > 0.0f)
+        {
+            // Speculative: allow approaching the bound just enough to reach it.
+            bias = separation * context.inv_time_step;
+        }
+        else if (use_bias)
+        {
+            bias = context.softness.bias_rate * separation;
+            mass_scale = context.softness.mass_scale;
+            impulse_scale = context.softness.impulse_scale;
+        }
+
+        const auto impulse = -effective_mass * mass_scale * (bound_velocity + bias) - impulse_scale * accumulated_impulse;
+        const auto new_impulse = std::max(accumulated_impulse + impulse, 0.0f);
+        const auto delta = new_impulse - accumulated_impulse;
+        accumulated_impulse = new_impulse;
+        return delta;
+    };
+
+    const auto lower_delta = solve_bound(position - limit.lower, velocity, limit.lower_impulse);
+    apply(lower_delta);
+
+    // The lower bound changed the velocity, so we need to evaluate it again.
+    // Instead of recomputing, use the fact that the velocity changes by impulse / effective mass.
+    const auto updated_velocity = velocity + (effective_mass > 0.0f ? lower_delta / effective_mass : 0.0f);
+    const auto upper_delta = solve_bound(limit.upper - position, -updated_velocity, limit.upper_impulse);
+    apply(-upper_delta);
+}
+
+/**
+ * @brief Drive the joint coordinate with the motor speed, using limited force.
+ *
+ * @param velocity Time derivative of the joint coordinate.
+ * @param effective_mass Impulse required to change @p velocity by 1.
+ * @return The impulse to be applied along the joint coordinate.
+ */
+float SolveMotor(JointMotor& motor, float velocity, float effective_mass, const JointSolverContext& context)
+{
+    const auto max_impulse = motor.max_force * context.time_step;
+    const auto impulse = effective_mass * (motor.speed - velocity);
+    const auto new_impulse = std::clamp(motor.impulse + impulse, -max_impulse, max_impulse);
+    const auto delta = new_impulse - motor.impulse;
+    motor.impulse = new_impulse;
+    return delta;
+}
+
+/**
+ * @return Impulse required to change the relative angular velocity by 1.
+ */
+float AngularMass(const AnchorPoint& start, const AnchorPoint& end)
+{
+    const auto inv_inertia = start.object->InverseInertia() + end.object->InverseInertia();
+    return inv_inertia > 0.0f ? 1.0f / inv_inertia : 0.0f;
+}
+
+/**
+ * @return Rotation of the end object relative to the start object.
+ */
+Radian RelativeAngle(const AnchorPoint& start, const AnchorPoint& end, Radian reference_angle)
+{
+    return end.object->Transform().Rotation() - start.object->Transform().Rotation() - reference_angle;
+}
+
+void DistanceJoint::WarmStart()
+{
+    const auto r1 = RelativeAnchor(start);
+    const auto r2 = RelativeAnchor(end);
+    auto axis = end.GlobalPosition() - start.GlobalPosition();
+    axis.Normalize();
+
+    const auto axial_impulse = impulse + limit.lower_impulse - limit.upper_impulse + motor.impulse;
+    ApplyAnchorImpulse(start, end, r1, r2, axis * axial_impulse);
+}
+
+void DistanceJoint::Solve(const JointSolverContext& context, bool use_bias)
+{
+    const auto r1 = RelativeAnchor(start);
+    const auto r2 = RelativeAnchor(end);
+    const auto displacement = end.GlobalPosition() - start.GlobalPosition();
+    const auto current_length = displacement.Magnitude();
+    auto axis = displacement;
+    axis.Normalize();
+
+    const auto axial_mass = EffectiveMass(start.object, end.object, r1, r2, axis);
+    const auto axial_velocity = [&]() {
+        return RelativeAnchorVelocity(start, end, r1, r2).Dot(axis);
+    };
+    const auto apply = [&](float axial_impulse) {
+        ApplyAnchorImpulse(start, end, r1, r2, axis * axial_impulse);
+    };
+
+    if (motor.enabled)
+    {
+        apply(SolveMotor(motor, axial_velocity(), axial_mass, context));
+    }
+
+    // Spring or rigid rod.
+    {
+        const auto position_error = current_length - length;
+        auto softness = Softness{};
+        if (hertz > 0.0f)
+        {
+            // A spring is a physical force, not an error correction.
+            // Therefore, it is applied regardless of use_bias.
+            softness = MakeSoftness(hertz, damping_ratio, context.time_step);
+        }
+        else if (use_bias)
+        {
+            softness = context.softness;
+        }
+
+        const auto bias = softness.bias_rate * position_error;
+        const auto delta = -axial_mass * softness.mass_scale * (axial_velocity() + bias) - softness.impulse_scale * impulse;
+        impulse += delta;
+        apply(delta);
+    }
+
+    if (limit.enabled)
+    {
+        SolveLimit(limit, current_length, axial_velocity(), axial_mass, context, use_bias, apply);
+    }
+}
+
+void RevoluteJoint::WarmStart()
+{
+    const auto r1 = RelativeAnchor(start);
+    const auto r2 = RelativeAnchor(end);
+
+    ApplyAnchorImpulse(start, end, r1, r2, linear_impulse);
+    ApplyAngularImpulse(start, end, motor.impulse + limit.lower_impulse - limit.upper_impulse);
+}
+
+void RevoluteJoint::Solve(const JointSolverContext& context, bool use_bias)
+{
+    const auto angular_mass = AngularMass(start, end);
+    const auto angular_velocity = [&]() {
+        return end.object->AngularVelocity().z - start.object->AngularVelocity().z;
+    };
+    const auto apply = [&](float angular_impulse) {
+        ApplyAngularImpulse(start, end, angular_impulse);
+    };
+
+    if (motor.enabled)
+    {
+        apply(SolveMotor(motor, angular_velocity(), angular_mass, context));
+    }
+
+    if (limit.enabled)
+    {
+        SolveLimit(limit, RelativeAngle(start, end, reference_angle), angular_velocity(), angular_mass, context, use_bias, apply);
+    }
+
+    // Solve the point constraint last, since it is the most important one.
+    SolvePointConstraint(start, end, context.softness, use_bias, linear_impulse);
+}
+
+void WeldJoint::WarmStart()
+{
+    const auto r1 = RelativeAnchor(start);
+    const auto r2 = RelativeAnchor(end);
+
+    ApplyAnchorImpulse(start, end, r1, r2, linear_impulse);
+    ApplyAngularImpulse(start, end, angular_impulse);
+}
+
+void WeldJoint::Solve(const JointSolverContext& context, bool use_bias)
+{
+    // Angular constraint.
+    {
+        auto softness = Softness{};
+        if (angular_hertz > 0.0f)
+        {
+            softness = MakeSoftness(angular_hertz, angular_damping_ratio, context.time_step);
+        }
+        else if (use_bias)
+        {
+            softness = context.softness;
+        }
+
+        const auto angular_velocity = end.object->AngularVelocity().z - start.object->AngularVelocity().z;
+        const auto bias = softness.bias_rate * RelativeAngle(start, end, reference_angle);
+        const auto delta = -AngularMass(start, end) * softness.mass_scale * (angular_velocity + bias) - softness.impulse_scale * angular_impulse;
+        angular_impulse += delta;
+        ApplyAngularImpulse(start, end, delta);
+    }
+
+    // Linear constraint.
+    if (linear_hertz > 0.0f)
+    {
+        SolvePointConstraint(start, end, MakeSoftness(linear_hertz, linear_damping_ratio, context.time_step), true, linear_impulse);
+    }
+    else
+    {
+        SolvePointConstraint(start, end, context.softness, use_bias, linear_impulse);
+    }
+}
+
+void PrismaticJoint::WarmStart()
+{
+    const auto r1 = RelativeAnchor(start);
+    const auto r2 = RelativeAnchor(end);
+    const auto displacement = end.GlobalPosition() - start.GlobalPosition();
+
+    auto axis = start.object->Transform().GlobalDirection(local_axis);
+    axis.Normalize();
+    const auto perpendicular = Vec3{.z = 1}.Cross(axis);
+
+    // The start object receives the impulse at the end anchor, not at its own anchor,
+    // so that the constraint is satisfied wherever the end anchor slides to.
+    const auto axial_impulse = motor.impulse + limit.lower_impulse - limit.upper_impulse;
+    const auto linear = axis * axial_impulse + perpendicular * impulse.x;
+    ApplyAnchorImpulse(start, end, displacement + r1, r2, linear);
+    ApplyAngularImpulse(start, end, impulse.y);
+}
+
+void PrismaticJoint::Solve(const JointSolverContext& context, bool use_bias)
+{
+    const auto* object1 = start.object;
+    const auto* object2 = end.object;
+    const auto r1 = RelativeAnchor(start);
+    const auto r2 = RelativeAnchor(end);
+    const auto displacement = end.GlobalPosition() - start.GlobalPosition();
+    const auto lever1 = displacement + r1;
+
+    auto axis = object1->Transform().GlobalDirection(local_axis);
+    axis.Normalize();
+    const auto perpendicular = Vec3{.z = 1}.Cross(axis);
+
+    const auto axial_mass = EffectiveMass(object1, object2, lever1, r2, axis);
+    const auto axial_velocity = [&]() {
+        return RelativeAnchorVelocity(start, end, lever1, r2).Dot(axis);
+    };
+    const auto apply = [&](float axial_impulse) {
+        ApplyAnchorImpulse(start, end, lever1, r2, axis * axial_impulse);
+    };
+
+    if (motor.enabled)
+    {
+        apply(SolveMotor(motor, axial_velocity(), axial_mass, context));
+    }
+
+    if (limit.enabled)
+    {
+        SolveLimit(limit, displacement.Dot(axis), axial_velocity(), axial_mass, context, use_bias, apply);
+    }
+
+    // Perpendicular translation and relative rotation are solved together,
+    // since a perpendicular impulse also produces a rotation.
+    {
+        const auto arm1 = lever1.Cross(perpendicular).z;
+        const auto arm2 = r2.Cross(perpendicular).z;
+        const auto inv_inertia1 = object1->InverseInertia();
+        const auto inv_inertia2 = object2->InverseInertia();
+
+        const auto k11 = object1->InverseMass() + object2->InverseMass() + inv_inertia1 * arm1 * arm1 + inv_inertia2 * arm2 * arm2;
+        const auto k12 = inv_inertia1 * arm1 + inv_inertia2 * arm2;
+        auto k22 = inv_inertia1 + inv_inertia2;
+        if (k22 == 0.0f)
+        {
+            // Neither object can rotate, which makes the angular row meaningless.
+            k22 = 1.0f;
+        }
+
+        auto bias = Vec3{};
+        auto mass_scale = 1.0f;
+        auto impulse_scale = 0.0f;
+        if (use_bias)
+        {
+            bias = Vec3{displacement.Dot(perpendicular), RelativeAngle(start, end, reference_angle)} * context.softness.bias_rate;
+            mass_scale = context.softness.mass_scale;
+            impulse_scale = context.softness.impulse_scale;
+        }
+
+        const auto velocity = Vec3{
+            RelativeAnchorVelocity(start, end, lever1, r2).Dot(perpendicular),
+            object2->AngularVelocity().z - object1->AngularVelocity().z
+        };
+        const auto b = SolveSymmetric2x2(k11, k12, k22, velocity + bias);
+        const auto delta = -b * mass_scale - impulse * impulse_scale;
+        impulse += delta;
+
+        // The angular part of the perpendicular impulse is applied by ApplyAnchorImpulse().
+        ApplyAnchorImpulse(start, end, lever1, r2, perpendicular * delta.x);
+        ApplyAngularImpulse(start, end, delta.y);
+    }
+}
+
+void MouseJoint::WarmStart()
+{
+    anchor.object->ApplyInstantImpulse(RelativeAnchor(anchor), impulse);
+}
+
+void MouseJoint::Solve(const JointSolverContext& context)
+{
+    auto* object = anchor.object;
+    const auto r = RelativeAnchor(anchor);
+
+    // The mouse joint is a spring, so the bias is always applied.
+    const auto softness = MakeSoftness(hertz, damping_ratio, context.time_step);
+    const auto bias = (anchor.GlobalPosition() - target) * softness.bias_rate;
+
+    const auto inv_mass = object->InverseMass();
+    const auto inv_inertia = object->InverseInertia();
+    const auto k11 = inv_mass + r.y * r.y * inv_inertia;
+    const auto k12 = -r.y * r.x * inv_inertia;
+    const auto k22 = inv_mass + r.x * r.x * inv_inertia;
+
+    const auto b = SolveSymmetric2x2(k11, k12, k22, object->GlobalVelocity(r) + bias);
+    auto new_impulse = impulse - b * softness.mass_scale - impulse * softness.impulse_scale;
+
+    // Limit the force, so that a far away target doesn't fling the object.
+    const auto max_impulse = max_force * context.time_step;
+    if (new_impulse.SquaredMagnitude() > max_impulse * max_impulse)
+    {
+        new_impulse.Normalize();
+        new_impulse *= max_impulse;
+    }
+
+    object->ApplyInstantImpulse(r, new_impulse - impulse);
+    impulse = new_impulse;
+}
+
+} // namespace physics
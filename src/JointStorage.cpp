@@ -0,0 +1,298 @@
+#include "JointStorage.h"
+#include "SwapRemove.h"
+#include <algorithm>
+#include <cassert>
+
+namespace physics
+{
+
+template<typename T>
+JointId JointStorage::Append(T& joint, int body1, int body2)
+{
+    assert(body1 != body2);
+
+    auto& joints = Array<T>();
+    joint.id = m_next_id++;
+    m_slots.emplace(joint.id, JointSlot{
+        .type = TypeOf<T>(),
+        .index = static_cast<int>(joints.size()),
+        .body1 = body1,
+        .body2 = body2
+    });
+    joints.push_back(joint);
+
+    if (m_joints_of_body.size() <= std::max(body1, body2))
+    {
+        m_joints_of_body.resize(std::max(body1, body2) + 1);
+    }
+    m_joints_of_body[body1].push_back(joint.id);
+    if (body2 >= 0)
+    {
+        m_joints_of_body[body2].push_back(joint.id);
+    }
+    return joint.id;
+}
+
+template<typename T>
+void JointStorage::SwapRemove(int index)
+{
+    auto& joints = Array<T>();
+    const auto id = joints[index].id;
+    const auto slot = m_slots.at(id);
+
+    // The bodies refer to joints by their identifiers,
+    // so only the slot of the moved joint needs the new index.
+    SwapRemoveValue(m_joints_of_body[slot.body1], id);
+    if (slot.body2 >= 0)
+    {
+        SwapRemoveValue(m_joints_of_body[slot.body2], id);
+    }
+    m_slots.erase(id);
+    if (index != joints.size() - 1)
+    {
+        m_slots.at(joints.back().id).index = index;
+    }
+    SwapRemoveElement(joints, index);
+}
+
+JointId JointStorage::Add(DistanceJoint joint)
+{
+    return Append(joint, joint.start.object->BodyIndex(), joint.end.object->BodyIndex());
+}
+
+JointId JointStorage::Add(RevoluteJoint joint)
+{
+    return Append(joint, joint.start.object->BodyIndex(), joint.end.object->BodyIndex());
+}
+
+JointId JointStorage::Add(WeldJoint joint)
+{
+    return Append(joint, joint.start.object->BodyIndex(), joint.end.object->BodyIndex());
+}
+
+JointId JointStorage::Add(PrismaticJoint joint)
+{
+    return Append(joint, joint.start.object->BodyIndex(), joint.end.object->BodyIndex());
+}
+
+JointId JointStorage::Add(MouseJoint joint)
+{
+    return Append(joint, joint.anchor.object->BodyIndex(), -1);
+}
+
+void JointStorage::Remove(JointId id)
+{
+    const auto it = m_slots.find(id);
+    if (it == m_slots.end())
+    {
+        return;
+    }
+
+    const auto index = it->second.index;
+    switch (it->second.type)
+    {
+    case JointType::distance:
+        SwapRemove<DistanceJoint>(index);
+        break;
+    case JointType::revolute:
+        SwapRemove<RevoluteJoint>(index);
+        break;
+    case JointType::weld:
+        SwapRemove<WeldJoint>(index);
+        break;
+    case JointType::prismatic:
+        SwapRemove<PrismaticJoint>(index);
+        break;
+    case JointType::mouse:
+        SwapRemove<MouseJoint>(index);
+        break;
+    }
+}
+
+void JointStorage::RemoveJointsOnBody(int body)
+{
+    if (body >= m_joints_of_body.size())
+    {
+        return;
+    }
+
+    const auto& joints = m_joints_of_body[body];
+    while (!joints.empty())
+    {
+        Remove(joints.back());
+    }
+}
+
+void JointStorage::MoveBody(int from, int to)
+{
+    if (from >= m_joints_of_body.size())
+    {
+        return;
+    }
+    if (m_joints_of_body.size() <= to)
+    {
+        m_joints_of_body.resize(to + 1);
+    }
+    assert(m_joints_of_body[to].empty());
+
+    for (const auto id : m_joints_of_body[from])
+    {
+        auto& slot = m_slots.at(id);
+        if (slot.body1 == from)
+        {
+            slot.body1 = to;
+        }
+        if (slot.body2 == from)
+        {
+            slot.body2 = to;
+        }
+    }
+    std::swap(m_joints_of_body[from], m_joints_of_body[to]);
+}
+
+void JointStorage::SwapBodies(int first, int second)
+{
+    const auto max_body = std::max(first, second);
+    if (m_joints_of_body.size() <= max_body)
+    {
+        m_joints_of_body.resize(max_body + 1);
+    }
+
+    const auto swap_body = [&](int& body) {
+        body = body == first ? second : (body == second ? first : body);
+    };
+    for (const auto id : m_joints_of_body[first])
+    {
+        auto& slot = m_slots.at(id);
+        swap_body(slot.body1);
+        swap_body(slot.body2);
+    }
+    for (const auto id : m_joints_of_body[second])
+    {
+        // Joints between both bodies were already swapped above.
+        auto& slot = m_slots.at(id);
+        if (slot.body1 != first && slot.body2 != first)
+        {
+            swap_body(slot.body1);
+            swap_body(slot.body2);
+        }
+    }
+    std::swap(m_joints_of_body[first], m_joints_of_body[second]);
+}
+
+void JointStorage::WarmStart()
+{
+    for (auto& joint : m_distance_joints)
+    {
+        joint.WarmStart();
+    }
+    for (auto& joint : m_revolute_joints)
+    {
+        joint.WarmStart();
+    }
+    for (auto& joint : m_weld_joints)
+    {
+        joint.WarmStart();
+    }
+    for (auto& joint : m_prismatic_joints)
+    {
+        joint.WarmStart();
+    }
+    for (auto& joint : m_mouse_joints)
+    {
+        joint.WarmStart();
+    }
+}
+
+void JointStorage::Solve(const JointSolverContext& context, bool use_bias)
+{
+    // The mouse joint is solved first, so that the other joints
+    // have the final say on how the mechanism moves.
+    for (auto& joint : m_mouse_joints)
+    {
+        joint.Solve(context);
+    }
+    for (auto& joint : m_distance_joints)
+    {
+        joint.Solve(context, use_bias);
+    }
+    for (auto& joint : m_prismatic_joints)
+    {
+        joint.Solve(context, use_bias);
+    }
+    for (auto& joint : m_weld_joints)
+    {
+        joint.Solve(context, use_bias);
+    }
+    for (auto& joint : m_revolute_joints)
+    {
+        joint.Solve(context, use_bias);
+    }
+}
+
+void JointStorage::ClearImpulses()
+{
+    for (auto& joint : m_distance_joints)
+    {
+        joint.impulse = 0.0f;
+        joint.limit.lower_impulse = joint.limit.upper_impulse = 0.0f;
+        joint.motor.impulse = 0.0f;
+    }
+    for (auto& joint : m_revolute_joints)
+    {
+        joint.linear_impulse = {};
+        joint.limit.lower_impulse = joint.limit.upper_impulse = 0.0f;
+        joint.motor.impulse = 0.0f;
+    }
+    for (auto& joint : m_weld_joints)
+    {
+        joint.linear_impulse = {};
+        joint.angular_impulse = 0.0f;
+    }
+    for (auto& joint : m_prismatic_joints)
+    {
+        joint.impulse = {};
+        joint.limit.lower_impulse = joint.limit.upper_impulse = 0.0f;
+        joint.motor.impulse = 0.0f;
+    }
+    for (auto& joint : m_mouse_joints)
+    {
+        joint.impulse = {};
+    }
+}
+
+bool JointStorage::IsEmpty() const
+{
+    return m_distance_joints.empty()
+        && m_revolute_joints.empty()
+        && m_weld_joints.empty()
+        && m_prismatic_joints.empty()
+        && m_mouse_joints.empty();
+}
+
+const std::vector<DistanceJoint>& JointStorage::DistanceJoints() const
+{
+    return m_distance_joints;
+}
+
+const std::vector<RevoluteJoint>& JointStorage::RevoluteJoints() const
+{
+    return m_revolute_joints;
+}
+
+const std::vector<WeldJoint>& JointStorage::WeldJoints() const
+{
+    return m_weld_joints;
+}
+
+const std::vector<PrismaticJoint>& JointStorage::PrismaticJoints() const
+{
+    return m_prismatic_joints;
+}
+
+const std::vector<MouseJoint>& JointStorage::MouseJoints() const
+{
+    return m_mouse_joints;
+}
+
+} // namespace physics
@@ -4,8 +4,29 @@
 namespace physics
 {
 
-ObjectDragger::ObjectDragger(std::shared_ptr<World> world)
-    : m_world(world)
+/**
+ * @brief Maximum acceleration of the picked object when the drag strength is 1.
+ */
+constexpr float max_drag_acceleration = 10000.0f;
+
+/**
+ * @return The force limit of a mouse joint on @p object.
+ *
+ * @note An object with zero inverse mass cannot be moved by any force,
+ *       so it gets no force rather than an infinite one.
+ */
+float MaxDragForce(float drag_strength, const Rigidbody& object)
+{
+    const auto inv_mass = object.InverseMass();
+    if (inv_mass <= 0.0f)
+    {
+        return 0.0f;
+    }
+    return drag_strength * max_drag_acceleration / inv_mass;
+}
+
+ObjectDragger::ObjectDragger(std::shared_ptr<SimulationThread> simulation)
+    : m_simulation(simulation)
 {}
 
 std::string ObjectDragger::Description() const
@@ -19,53 +40,102 @@ std::string ObjectDragger::Tooltip() const
 
 void ObjectDragger::OnMouseClick(const Vec3& mouse_pos)
 {
-    if (m_picked_object = m_world->PickObject(mouse_pos))
+    const auto& snapshot = m_simulation->Snapshot();
+    m_picked_body = snapshot.PickHandle(mouse_pos);
+
+    const auto index = snapshot.Find(m_picked_body);
+    if (!index.has_value())
     {
-        // Do not select static objects.
-        if (m_picked_object->IsStatic())
-        {
-            m_picked_object.reset();
-        }
-        else
+        return;
+    }
+
+    // Do not select static objects.
+    if (snapshot.is_static[*index])
+    {
+        m_picked_body = {};
+        return;
+    }
+
+    // Record the local coordianate of the point we just clicked.
+    m_picked_offset = snapshot.transforms[*index].LocalPosition(mouse_pos);
+    m_drag_vector = {};
+
+    m_simulation->Submit([this, handle = m_picked_body, offset = m_picked_offset, mouse_pos, drag_strength = m_drag_strength](World& world) {
+        // The object might have been removed since the snapshot was taken.
+        const auto anchor = world.MakeAnchorPoint(handle, offset);
+        if (!anchor.has_value())
         {
-            // Record the local coordianate of the point we just clicked.
-            m_picked_offset = m_picked_object->Transform().LocalPosition(mouse_pos);
+            return;
         }
-    }
+
+        m_mouse_joint = world.AddJoint(MouseJoint{
+            .anchor = anchor.value(),
+            .target = mouse_pos,
+            .max_force = MaxDragForce(drag_strength, *anchor->object)
+        });
+    });
 }
 
 void ObjectDragger::OnMouseDown(const Vec3& mouse_pos)
 {
-    if (m_picked_object)
+    if (IsObjectSelected())
     {
-        m_drag_vector = mouse_pos - m_picked_object->Collider()->Transform().GlobalPosition(m_picked_offset);
+        m_drag_vector = mouse_pos - PickedPoint();
+
+        m_simulation->Submit([this, mouse_pos](World& world) {
+            if (auto* joint = world.FindMouseJoint(m_mouse_joint))
+            {
+                joint->target = mouse_pos;
+            }
+        });
     }
 }
 
 void ObjectDragger::OnMouseRelease(const Vec3& mouse_pos)
 {
-    m_picked_object.reset();
+    m_simulation->Submit([this](World& world) {
+        world.RemoveJoint(m_mouse_joint);
+        m_mouse_joint = -1;
+    });
+    m_picked_body = {};
 }
 
-void ObjectDragger::ApplyDraggingForce(float drag_strength, float time_step)
+void ObjectDragger::ConfigureDragStrength(float drag_strength)
 {
-    assert(IsObjectSelected());
+    assert(drag_strength > 0.0f);
 
-    const auto impact_point = PickedPoint() - m_picked_object->Transform().Position();
-    const auto force = DragVector() * drag_strength / m_picked_object->InverseMass();
-    m_picked_object->ApplyImpulse(impact_point, force, time_step);
+    // Called on every frame, so skip the command unless something changed.
+    if (drag_strength == m_drag_strength)
+    {
+        return;
+    }
+
+    m_drag_strength = drag_strength;
+    if (!IsObjectSelected())
+    {
+        return;
+    }
+
+    m_simulation->Submit([this, drag_strength](World& world) {
+        if (auto* joint = world.FindMouseJoint(m_mouse_joint))
+        {
+            joint->max_force = MaxDragForce(drag_strength, *joint->anchor.object);
+        }
+    });
 }
 
 bool ObjectDragger::IsObjectSelected() const
 {
-    return m_picked_object != nullptr;
+    // The handle becomes stale if the object was removed while dragging.
+    return m_simulation->Snapshot().Find(m_picked_body).has_value();
 }
 
 Vec3 ObjectDragger::PickedPoint() const
 {
     assert(IsObjectSelected());
 
-    return m_picked_object->Transform().GlobalPosition(m_picked_offset);
+    const auto& snapshot = m_simulation->Snapshot();
+    return snapshot.transforms[*snapshot.Find(m_picked_body)].GlobalPosition(m_picked_offset);
 }
 
 Vec3 ObjectDragger::DragVector() const
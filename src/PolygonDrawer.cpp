@@ -1,12 +1,13 @@
 #include "PolygonDrawer.h"
 #include "ConvexPolygon.h"
+#include "PoolAllocator.h"
 #include <cassert>
 
 namespace physics
 {
 
-PolygonDrawer::PolygonDrawer(std::shared_ptr<World> world, float draw_finish_distance)
-    : m_world(world), m_draw_finish_distance(draw_finish_distance)
+PolygonDrawer::PolygonDrawer(std::shared_ptr<SimulationThread> simulation, std::shared_ptr<ShapeCache> shape_cache, float draw_finish_distance)
+    : m_simulation(simulation), m_shape_cache(shape_cache), m_draw_finish_distance(draw_finish_distance)
 {}
 
 std::string PolygonDrawer::Description() const
@@ -66,42 +67,45 @@ bool PolygonDrawer::IsDrawingFinished(const Vec3& clicked_pos) const
 
 void PolygonDrawer::TrySpawnObject()
 {
-    try
+    // Since vertices are recorded using global coordinate,
+    // we need to adjust them w.r.t. the center of mass.
+    // This step can be thought as moving the origin of this object
+    // from global origin (0, 0) to the object's center (i.e., 'center of mass').
+    const auto center_of_mass = m_vertex_sum / m_vertices.size();
+    for (auto& vertex : m_vertices)
     {
-        // Since vertices are recorded using global coordinate,
-        // we need to adjust them w.r.t. the center of mass.
-        // This step can be thought as moving the origin of this object
-        // from global origin (0, 0) to the object's center (i.e., 'center of mass').
-        const auto center_of_mass = m_vertex_sum / m_vertices.size();
-        for (auto& vertex : m_vertices)
+        vertex -= center_of_mass;
+    }
+
+    // The object is created by the simulation, which owns the shape cache from now on.
+    m_simulation->Submit([shape_cache = m_shape_cache, vertices = m_vertices, center_of_mass](World& world) {
+        try
         {
-            vertex -= center_of_mass;
+            // The geometry will throw exception if
+            // the vertices were not ordered counter-clockwise.
+            auto polygon_shape = MakePooled<ConvexPolygon>(shape_cache->Polygon(vertices));
+            
+            auto default_mat = MaterialProperties{
+                .restitution = 0.7f,
+                .static_friction = 0.6f,
+                .dynamic_friction = 0.3f
+            };
+
+            // Estimate mass and inertia based on the polygon's surface area.
+            const auto area = polygon_shape->Area();
+            const auto mass = area;
+            const auto inertia = area * area;
+            auto object = MakePooled<Rigidbody>(polygon_shape, default_mat, mass, inertia);
+            object->Transform().SetPosition(center_of_mass);
+
+            // Add the newly created object to the simulator.
+            world.AddObject(object);
         }
-
-        // The constructor will throw exception if
-        // the vertices were not ordered counter-clockwise.
-        auto polygon_shape = std::make_shared<ConvexPolygon>(m_vertices);
-        
-        auto default_mat = MaterialProperties{
-            .restitution = 0.7f,
-            .static_friction = 0.6f,
-            .dynamic_friction = 0.3f
-        };
-
-        // Estimate mass and inertia based on the polygon's surface area.
-        const auto area = polygon_shape->Area();
-        const auto mass = area;
-        const auto inertia = area * area;
-        auto object = std::make_shared<Rigidbody>(polygon_shape, default_mat, mass, inertia);
-        object->Transform().SetPosition(center_of_mass);
-
-        // Add the newly created object to the simulator.
-        m_world->AddObject(object);
-    }
-    catch(...)
-    {
-        // TODO: handle exception.
-    }
+        catch(...)
+        {
+            // TODO: handle exception.
+        }
+    });
 }
 
 void PolygonDrawer::AppendVertex(const Vec3& vertex)
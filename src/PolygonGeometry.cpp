@@ -0,0 +1,84 @@
+#include "PolygonGeometry.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace physics
+{
+
+PolygonGeometry::PolygonGeometry(const std::vector<Vec3>& vertices)
+    : m_vertices(vertices.begin(), vertices.end())
+{
+    const auto num_vertices = vertices.size();
+    m_edges.reserve(num_vertices);
+    for (int i = 0; i < num_vertices; ++i)
+    {
+        // Record edge information.
+        const auto& curr = vertices[i];
+        const auto& next = vertices[(i + 1) % num_vertices];
+        m_edges.emplace_back(curr, next);
+
+        // Record the length of the farthest vertex as boundary radius.
+        m_boundary_radius = std::max(m_boundary_radius, curr.Magnitude());
+
+        // Assuming uniform density,
+        // the center of mass should be the average of all vertices.
+        m_center_of_mass += curr / num_vertices;
+
+        // Key idea: the magnitude of cross product between two vectors A and B
+        //           is twice the area of triangle OAB (O is the origin).
+        m_area += curr.Cross(next).z / 2.0f;
+    }
+
+    ValidateCounterClockwiseOrder();
+}
+
+bool PolygonGeometry::IsCounterClockwise(std::span<const Vec3> vertices)
+{
+    // Same edges as the constructor, so that both always agree.
+    const auto num_vertices = vertices.size();
+    for (int i = 0; i < num_vertices; ++i)
+    {
+        const auto curr = LineSegment(vertices[i], vertices[(i + 1) % num_vertices]);
+        const auto next = LineSegment(vertices[(i + 1) % num_vertices], vertices[(i + 2) % num_vertices]);
+        if (curr.Tangent().Cross(next.Tangent()).z < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PolygonGeometry::ValidateCounterClockwiseOrder() const
+{
+    if (!IsCounterClockwise(m_vertices))
+    {
+        throw std::invalid_argument("the polygon was not convex");
+    }
+}
+
+const PooledVector<Vec3>& PolygonGeometry::Vertices() const
+{
+    return m_vertices;
+}
+
+const PooledVector<LineSegment>& PolygonGeometry::Edges() const
+{
+    return m_edges;
+}
+
+float PolygonGeometry::Area() const
+{
+    return m_area;
+}
+
+Vec3 PolygonGeometry::CenterOfMass() const
+{
+    return m_center_of_mass;
+}
+
+float PolygonGeometry::BoundaryRadius() const
+{
+    return m_boundary_radius;
+}
+
+} // namespace physics
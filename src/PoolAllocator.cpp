@@ -0,0 +1,74 @@
+#include "PoolAllocator.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace physics
+{
+
+SizeClassPool& SizeClassPool::Instance()
+{
+    // Intentionally leaked, so that objects destroyed during static destruction
+    // can still return their memory.
+    static auto* pool = new SizeClassPool{};
+    return *pool;
+}
+
+void* SizeClassPool::Allocate(std::size_t size)
+{
+    if (size > max_block_size)
+    {
+        return ::operator new(size);
+    }
+
+    const auto size_class = SizeClass(size);
+    auto lock = std::lock_guard{m_mutex};
+    if (!m_free_lists[size_class])
+    {
+        Refill(size_class);
+    }
+
+    auto* block = m_free_lists[size_class];
+    m_free_lists[size_class] = block->next;
+    return block;
+}
+
+void SizeClassPool::Deallocate(void* memory, std::size_t size)
+{
+    if (size > max_block_size)
+    {
+        ::operator delete(memory);
+        return;
+    }
+
+    const auto size_class = SizeClass(size);
+    auto lock = std::lock_guard{m_mutex};
+    auto* block = static_cast<FreeBlock*>(memory);
+    block->next = m_free_lists[size_class];
+    m_free_lists[size_class] = block;
+}
+
+std::size_t SizeClassPool::SizeClass(std::size_t size)
+{
+    assert(size <= max_block_size);
+
+    const auto block_size = std::bit_ceil(std::max(size, block_alignment));
+    return std::countr_zero(block_size) - std::countr_zero(block_alignment);
+}
+
+void SizeClassPool::Refill(std::size_t size_class)
+{
+    // operator new[] aligns the chunk for any fundamental type,
+    // and every block size is a multiple of block_alignment.
+    auto& chunk = m_chunks.emplace_back(std::make_unique<std::byte[]>(chunk_size));
+
+    const auto block_size = block_alignment << size_class;
+    for (auto offset = std::size_t{0}; offset + block_size <= chunk_size; offset += block_size)
+    {
+        auto* block = reinterpret_cast<FreeBlock*>(chunk.get() + offset);
+        block->next = m_free_lists[size_class];
+        m_free_lists[size_class] = block;
+    }
+}
+
+} // namespace physics
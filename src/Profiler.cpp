@@ -0,0 +1,115 @@
+#include "Profiler.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <cassert>
+
+namespace physics
+{
+
+const char* PhaseName(StepPhase phase)
+{
+    switch (phase)
+    {
+    case StepPhase::Broadphase:
+        return "broadphase";
+    case StepPhase::Narrowphase:
+        return "narrowphase";
+    case StepPhase::ResolveCollisions:
+        return "resolve collisions";
+    case StepPhase::Update:
+        return "update";
+    case StepPhase::UpdateSubstepped:
+        return "update substepped";
+    case StepPhase::FixedStep:
+        return "fixed step";
+    }
+
+    assert(false && "unknown step phase");
+    return "";
+}
+
+NarrowphaseCounters& LocalNarrowphaseCounters()
+{
+    thread_local auto counters = NarrowphaseCounters{};
+    return counters;
+}
+
+void StepProfiler::AddTime(StepPhase phase, float milliseconds)
+{
+    m_current_times[static_cast<int>(phase)] += milliseconds;
+}
+
+StepCounters& StepProfiler::Counters()
+{
+    return m_current_counters;
+}
+
+void StepProfiler::EndStep()
+{
+    for (int phase = 0; phase < num_step_phases; ++phase)
+    {
+        m_samples[phase][m_next_sample] = m_current_times[phase];
+    }
+    m_current_times = {};
+    m_next_sample = (m_next_sample + 1) % window_size;
+    m_num_samples = std::min(m_num_samples + 1, window_size);
+
+    m_last_counters = m_current_counters;
+    m_current_counters = {};
+}
+
+int StepProfiler::NumSamples() const
+{
+    return m_num_samples;
+}
+
+PhaseStats StepProfiler::Stats(StepPhase phase) const
+{
+    if (m_num_samples == 0)
+    {
+        return {};
+    }
+
+    // The ring buffer is full once it wrapped, so the valid samples are always at the front.
+    auto samples = m_samples[static_cast<int>(phase)];
+    const auto last = samples[(m_next_sample + window_size - 1) % window_size];
+    const auto begin = samples.begin();
+    const auto end = samples.begin() + m_num_samples;
+
+    auto stats = PhaseStats{};
+    stats.last_ms = last;
+    stats.max_ms = *std::max_element(begin, end);
+
+    auto sum = 0.0f;
+    for (auto it = begin; it != end; ++it)
+    {
+        sum += *it;
+    }
+    stats.average_ms = sum / m_num_samples;
+
+    // The smallest sample which is larger than or equal to 99% of the samples.
+    const auto p99_index = std::min(m_num_samples - 1, m_num_samples * 99 / 100);
+    std::nth_element(begin, begin + p99_index, end);
+    stats.p99_ms = samples[p99_index];
+    return stats;
+}
+
+const StepCounters& StepProfiler::LastCounters() const
+{
+    return m_last_counters;
+}
+
+ScopedPhaseTimer::ScopedPhaseTimer(StepProfiler& profiler, StepPhase phase)
+    : m_profiler(profiler), m_phase(phase), m_start(std::chrono::steady_clock::now())
+{}
+
+ScopedPhaseTimer::~ScopedPhaseTimer()
+{
+    const auto end = std::chrono::steady_clock::now();
+    m_profiler.AddTime(m_phase, std::chrono::duration<float, std::milli>(end - m_start).count());
+
+    // Phases also show up in a trace, with the same timestamps.
+    Tracer::Global().Record(PhaseName(m_phase), m_start, end);
+}
+
+} // namespace physics
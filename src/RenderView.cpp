@@ -0,0 +1,68 @@
+#include "RenderView.h"
+#include "SFML/Graphics/CircleShape.hpp"
+#include "SFML/Graphics/ConvexShape.hpp"
+#include "Angle.h"
+#include "Circle.h"
+#include "ConvexPolygon.h"
+#include <cassert>
+
+namespace physics
+{
+
+void RenderView::Draw(const WorldSnapshot& snapshot, sf::RenderTarget& target)
+{
+    for (int i = 0; i < snapshot.handles.size(); ++i)
+    {
+        const auto handle = snapshot.handles[i];
+        if (handle.slot >= m_entries.size())
+        {
+            m_entries.resize(handle.slot + 1);
+        }
+
+        // The slot might have belonged to a removed object.
+        auto& entry = m_entries[handle.slot];
+        if (!entry.shape || entry.handle != handle)
+        {
+            entry.handle = handle;
+            entry.shape = CreateShape(*snapshot.colliders[i]);
+        }
+
+        // Note that SFML uses degree as unit, while our rotation is radian.
+        const auto& render_transform = snapshot.transforms[i];
+        entry.shape->setPosition(render_transform.Position().x, render_transform.Position().y);
+        entry.shape->setRotation(rad2deg(render_transform.Rotation()));
+        target.draw(*entry.shape);
+    }
+}
+
+std::unique_ptr<sf::Shape> RenderView::CreateShape(const ICollider& collider)
+{
+    auto shape = std::unique_ptr<sf::Shape>{};
+    if (const auto* circle = dynamic_cast<const Circle*>(&collider))
+    {
+        // sf::CircleShape has origin on the corner,
+        // so we should adjust it to the origin.
+        const auto radius = circle->BoundaryRadius();
+        auto circle_shape = std::make_unique<sf::CircleShape>(radius);
+        circle_shape->setOrigin({radius, radius});
+        shape = std::move(circle_shape);
+    }
+    else if (const auto* polygon = dynamic_cast<const ConvexPolygon*>(&collider))
+    {
+        const auto& vertices = polygon->Vertices();
+        auto polygon_shape = std::make_unique<sf::ConvexShape>(vertices.size());
+        for (int i = 0; i < vertices.size(); ++i)
+        {
+            polygon_shape->setPoint(i, {vertices[i].x, vertices[i].y});
+        }
+        shape = std::move(polygon_shape);
+    }
+    assert(shape && "unknown collider type");
+
+    shape->setFillColor(sf::Color::Transparent);
+    shape->setOutlineColor(sf::Color::Black);
+    shape->setOutlineThickness(2);
+    return shape;
+}
+
+} // namespace physics
@@ -1,11 +1,25 @@
 ﻿#include "Rigidbody.h"
 #include "Circle.h"
 #include "ConvexPolygon.h"
+#include "Profiler.h"
 #include <cassert>
+#include <utility>
 
 namespace physics
 {
 
+template<typename T>
+T& Rigidbody::Field(std::vector<T> BodyStorage::* column, T BodyRow::* field)
+{
+    return m_storage ? (m_storage->*column)[m_index] : m_row.*field;
+}
+
+template<typename T>
+const T& Rigidbody::Field(std::vector<T> BodyStorage::* column, T BodyRow::* field) const
+{
+    return m_storage ? (m_storage->*column)[m_index] : m_row.*field;
+}
+
 Rigidbody::Rigidbody(
     std::shared_ptr<ICollider> collider,
     const MaterialProperties& material,
@@ -14,6 +28,8 @@ Rigidbody::Rigidbody(
 )
     : m_collider(collider), m_material(material)
 {
+    m_row.transform = collider->Transform();
+
     SetMass(mass);
     SetInertia(inertia);
 }
@@ -30,12 +46,12 @@ const ICollider* Rigidbody::Collider() const
 
 const physics::Transform& Rigidbody::Transform() const
 {
-    return Collider()->Transform();
+    return Field(&BodyStorage::transforms, &BodyRow::transform);
 }
 
 physics::Transform& Rigidbody::Transform()
 {
-    return Collider()->Transform();
+    return Field(&BodyStorage::transforms, &BodyRow::transform);
 }
 
 MaterialProperties& Rigidbody::Material()
@@ -50,34 +66,93 @@ const MaterialProperties& Rigidbody::Material() const
 
 const Vec3& Rigidbody::LinearVelocity() const
 {
-    return m_velocity.linear;
+    return Field(&BodyStorage::linear_velocities, &BodyRow::linear_velocity);
 }
 
 const Vec3& Rigidbody::AngularVelocity() const
 {
-    return m_velocity.angular;
+    return Field(&BodyStorage::angular_velocities, &BodyRow::angular_velocity);
+}
+
+void Rigidbody::SetLinearVelocity(const Vec3& velocity)
+{
+    Field(&BodyStorage::linear_velocities, &BodyRow::linear_velocity) = velocity;
+}
+
+void Rigidbody::SetAngularVelocity(const Vec3& velocity)
+{
+    Field(&BodyStorage::angular_velocities, &BodyRow::angular_velocity) = velocity;
+}
+
+int Rigidbody::BodyIndex() const
+{
+    return m_index;
+}
+
+void Rigidbody::MoveToStorage(BodyStorage& storage)
+{
+    if (&storage == m_storage)
+    {
+        return;
+    }
+
+    Detach();
+    m_index = storage.Append(this, m_row);
+    m_storage = &storage;
+}
+
+void Rigidbody::SwapStorageRow(Rigidbody& other)
+{
+    assert(m_storage == other.m_storage);
+
+    m_storage->SwapRows(m_index, other.m_index);
+    std::swap(m_index, other.m_index);
+}
+
+void Rigidbody::Detach()
+{
+    if (!m_storage)
+    {
+        return;
+    }
+
+    m_row = m_storage->Row(m_index);
+
+    // Another object now lives in our old row.
+    if (auto* moved = m_storage->SwapRemove(m_index))
+    {
+        moved->m_index = m_index;
+    }
+
+    m_storage = nullptr;
+    m_index = -1;
+}
+
+void Rigidbody::SyncColliderTransform()
+{
+    Collider()->Transform() = Transform();
 }
 
 float Rigidbody::InverseMass() const
 {
-    return m_inv_mass;
+    return Field(&BodyStorage::inv_masses, &BodyRow::inv_mass);
 }
 
 float Rigidbody::InverseInertia() const
 {
-    return m_inv_inertia;
+    return Field(&BodyStorage::inv_inertias, &BodyRow::inv_inertia);
 }
 
 bool Rigidbody::IsPointInside(const Vec3& global_pos) const
 {
     // Since collider doesn't know about our transform,
     // we need to convert it to the corresponding local coordinate.
-    return Collider()->IsPointInside(Collider()->Transform().LocalPosition(global_pos));
+    return Collider()->IsPointInside(Transform().LocalPosition(global_pos));
 }
 
 bool Rigidbody::IsStatic() const
 {
-    return m_inv_mass < epsilon && m_inv_inertia < epsilon;
+    return InverseMass() < epsilon && InverseInertia() < epsilon;
 }
 
 Vec3 Rigidbody::GlobalVelocity(const Vec3& local_pos) const
@@ -85,6 +160,13 @@ Vec3 Rigidbody::GlobalVelocity(const Vec3& local_pos) const
     return LinearVelocity() + AngularVelocity().Cross(local_pos);
 }
 
+Vec3 Rigidbody::GlobalPseudoVelocity(const Vec3& local_pos) const
+{
+    const auto& linear = Field(&BodyStorage::linear_pseudo_velocities, &BodyRow::linear_pseudo_velocity);
+    const auto& angular = Field(&BodyStorage::angular_pseudo_velocities, &BodyRow::angular_pseudo_velocity);
+    return linear + angular.Cross(local_pos);
+}
+
 /**
  * @brief Calculate the inverse of given real number.
  * @return (1 / value) if the value is nonzero.
@@ -106,21 +188,35 @@ void Rigidbody::SetMass(float new_mass)
 {
     assert(new_mass >= 0.0f);
 
-    m_inv_mass = Inverse(new_mass);
+    Field(&BodyStorage::inv_masses, &BodyRow::inv_mass) = Inverse(new_mass);
 }
 
 void Rigidbody::SetInertia(float new_inertia)
 {
     assert(new_inertia >= 0.0f);
 
-    m_inv_inertia = Inverse(new_inertia);
+    Field(&BodyStorage::inv_inertias, &BodyRow::inv_inertia) = Inverse(new_inertia);
+}
+
+void Rigidbody::SetInverseMass(float inv_mass)
+{
+    assert(inv_mass >= 0.0f);
+
+    Field(&BodyStorage::inv_masses, &BodyRow::inv_mass) = inv_mass;
+}
+
+void Rigidbody::SetInverseInertia(float inv_inertia)
+{
+    assert(inv_inertia >= 0.0f);
+
+    Field(&BodyStorage::inv_inertias, &BodyRow::inv_inertia) = inv_inertia;
 }
 
 void Rigidbody::MakeObjectStatic()
 {
     // Give infinite mass and inertia.
-    m_inv_mass = 0.0f;
-    m_inv_inertia = 0.0f;
+    Field(&BodyStorage::inv_masses, &BodyRow::inv_mass) = 0.0f;
+    Field(&BodyStorage::inv_inertias, &BodyRow::inv_inertia) = 0.0f;
 }
 
 bool Rigidbody::IsOutOfBoundaryRadius(const Rigidbody& other) const
@@ -158,6 +254,7 @@ std::optional<CollisionPair> Rigidbody::CheckCollision(Rigidbody& other)
         return {};
     }
 
+    PHYSICS_PROFILE_ONLY(++LocalNarrowphaseCounters().narrowphase_tests);
     auto result = Collider()->CheckCollision(other.Collider());
     if (result)
     {
@@ -179,37 +276,36 @@ void Rigidbody::ApplyImpulse(const Vec3& rel_impact_pos, const Vec3& impulse, fl
     const auto force_over_time = impulse / delta_time;
 
     // τ = r x F
-    m_acceleration.angular += rel_impact_pos.Cross(force_over_time) * m_inv_inertia;
-    m_acceleration.linear += force_over_time * m_inv_mass;
+    Field(&BodyStorage::angular_accelerations, &BodyRow::angular_acceleration) += rel_impact_pos.Cross(force_over_time) * InverseInertia();
+    Field(&BodyStorage::linear_accelerations, &BodyRow::linear_acceleration) += force_over_time * InverseMass();
 }
 
-void Rigidbody::ApplyDamping(float linear_damping, float angular_damping)
+void Rigidbody::ApplyInstantImpulse(const Vec3& rel_impact_pos, const Vec3& impulse)
 {
-    m_velocity.linear *= (1.0f - linear_damping);
-    m_velocity.angular *= (1.0f - angular_damping);
+    // Same as ApplyImpulse(), except that we skip the division by time step
+    // and write directly to the velocity.
+    Field(&BodyStorage::angular_velocities, &BodyRow::angular_velocity) += rel_impact_pos.Cross(impulse) * InverseInertia();
+    Field(&BodyStorage::linear_velocities, &BodyRow::linear_velocity) += impulse * InverseMass();
 }
 
-void Rigidbody::Update(float delta_time)
+void Rigidbody::ApplyInstantAngularImpulse(float angular_impulse)
 {
-    auto& transform = Transform();
-    transform.AddPosition(m_velocity.linear * delta_time);
-    transform.AddRotation(m_velocity.angular.z * delta_time);
-
-    m_velocity.linear += m_acceleration.linear * delta_time;
-    m_velocity.angular += m_acceleration.angular * delta_time;
+    Field(&BodyStorage::angular_velocities, &BodyRow::angular_velocity).z += angular_impulse * InverseInertia();
+}
 
-    // Accumulated acceleration is valid only for a single time step.
-    // Reset them to zero for next time step.
-    m_acceleration.linear = {};
-    m_acceleration.angular = {};
+void Rigidbody::ApplyPseudoImpulse(const Vec3& rel_impact_pos, const Vec3& impulse)
+{
+    Field(&BodyStorage::angular_pseudo_velocities, &BodyRow::angular_pseudo_velocity) += rel_impact_pos.Cross(impulse) * InverseInertia();
+    Field(&BodyStorage::linear_pseudo_velocities, &BodyRow::linear_pseudo_velocity) += impulse * InverseMass();
+}
 
-    // Synchonize SFML representation with physical state.
-    // Note that SFML uses degree as unit, while our rotation is radian.
-    auto& shape = m_collider->SFMLShape();
+float EffectiveMass(const Rigidbody* object1, const Rigidbody* object2, const Vec3& rel_pos1, const Vec3& rel_pos2, const Vec3& direction)
+{
+    const auto inv_mass = object1->InverseMass() + object2->InverseMass()
+        + rel_pos1.Cross(direction).SquaredMagnitude() * object1->InverseInertia()
+        + rel_pos2.Cross(direction).SquaredMagnitude() * object2->InverseInertia();
 
-    auto [x, y, _] = transform.Position();
-    shape.setPosition(x, y);
-    shape.setRotation(rad2deg(transform.Rotation()));
+    return Inverse(inv_mass);
 }
 
 } // namespace physics
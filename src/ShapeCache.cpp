@@ -0,0 +1,63 @@
+#include "ShapeCache.h"
+#include <algorithm>
+#include <functional>
+
+namespace physics
+{
+
+std::shared_ptr<const PolygonGeometry> ShapeCache::Polygon(const std::vector<Vec3>& vertices)
+{
+    const auto hash = Hash(vertices);
+    auto [it, end] = m_polygons.equal_range(hash);
+    while (it != end)
+    {
+        if (auto geometry = it->second.lock())
+        {
+            if (IsSame(*geometry, vertices))
+            {
+                return geometry;
+            }
+            ++it;
+        }
+        else
+        {
+            // Nobody uses this geometry anymore.
+            it = m_polygons.erase(it);
+        }
+    }
+
+    auto geometry = std::shared_ptr<const PolygonGeometry>(MakePooled<PolygonGeometry>(vertices));
+    m_polygons.emplace(hash, geometry);
+    return geometry;
+}
+
+int ShapeCache::Size() const
+{
+    return static_cast<int>(std::count_if(m_polygons.begin(), m_polygons.end(), [](const auto& entry) {
+        return !entry.second.expired();
+    }));
+}
+
+std::size_t ShapeCache::Hash(const std::vector<Vec3>& vertices)
+{
+    // Same as boost::hash_combine().
+    auto hash = vertices.size();
+    for (const auto& vertex : vertices)
+    {
+        for (const auto value : {vertex.x, vertex.y, vertex.z})
+        {
+            hash ^= std::hash<float>{}(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+    }
+    return hash;
+}
+
+bool ShapeCache::IsSame(const PolygonGeometry& geometry, const std::vector<Vec3>& vertices)
+{
+    const auto& cached = geometry.Vertices();
+    return std::equal(cached.begin(), cached.end(), vertices.begin(), vertices.end(), [](const Vec3& a, const Vec3& b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    });
+}
+
+} // namespace physics
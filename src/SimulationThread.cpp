@@ -0,0 +1,163 @@
+#include "SimulationThread.h"
+#include "Tracer.h"
+#include <cassert>
+#include <chrono>
+
+namespace physics
+{
+
+SimulationThread::SimulationThread(std::shared_ptr<World> world)
+    : m_world(std::move(world))
+{
+    assert(m_world);
+}
+
+SimulationThread::~SimulationThread()
+{
+    Stop();
+}
+
+void SimulationThread::Start(float publish_interval)
+{
+    assert(publish_interval > 0.0f);
+
+    if (IsRunning())
+    {
+        return;
+    }
+
+    m_thread = std::jthread([this, publish_interval](std::stop_token stop_token) {
+        ThreadLoop(stop_token, publish_interval);
+    });
+}
+
+void SimulationThread::Stop()
+{
+    if (m_thread.joinable())
+    {
+        m_thread.request_stop();
+        m_thread.join();
+    }
+}
+
+bool SimulationThread::IsRunning() const
+{
+    return m_thread.joinable();
+}
+
+void SimulationThread::Update(float frame_time)
+{
+    assert(!IsRunning());
+
+    Advance(frame_time);
+}
+
+void SimulationThread::ConfigureTimeScale(float time_scale)
+{
+    assert(time_scale >= 0.0f);
+
+    m_time_scale.store(time_scale, std::memory_order_relaxed);
+}
+
+void SimulationThread::Submit(CommandQueue::Command command)
+{
+    m_commands.Push(std::move(command));
+}
+
+const WorldSnapshot& SimulationThread::AcquireSnapshot()
+{
+    if (m_ready_index.load(std::memory_order_relaxed) & ready_flag)
+    {
+        // Acquires the writes of the simulation to the snapshot.
+        m_read_index = m_ready_index.exchange(m_read_index, std::memory_order_acq_rel) & ~ready_flag;
+    }
+    return Snapshot();
+}
+
+const WorldSnapshot& SimulationThread::Snapshot() const
+{
+    return m_snapshots[m_read_index];
+}
+
+void SimulationThread::Advance(float elapsed_time)
+{
+    m_commands.Drain(*m_world);
+    m_num_steps += m_world->Step(elapsed_time * m_time_scale.load(std::memory_order_relaxed));
+    PublishSnapshot();
+}
+
+void SimulationThread::PublishSnapshot()
+{
+    PHYSICS_TRACE_SCOPE("publish snapshot");
+    const auto& world = *m_world;
+    const auto& objects = world.Objects();
+    const auto& render_transforms = world.RenderTransforms();
+
+    // Every list is overwritten in place, so the buffers stop allocating once they are large enough.
+    auto& snapshot = m_snapshots[m_write_index];
+    snapshot.num_steps = m_num_steps;
+    snapshot.handles.clear();
+    snapshot.colliders.clear();
+    snapshot.is_static.clear();
+    for (const auto& object : objects)
+    {
+        const auto handle = world.Handle(*object);
+        if (handle.slot >= m_colliders.size())
+        {
+            m_colliders.resize(handle.slot + 1);
+        }
+
+        // The slot might have belonged to a removed object.
+        auto& entry = m_colliders[handle.slot];
+        if (!entry.collider || entry.handle != handle)
+        {
+            entry.handle = handle;
+            entry.collider = object->Collider()->Clone();
+        }
+
+        snapshot.handles.push_back(handle);
+        snapshot.colliders.push_back(entry.collider);
+        snapshot.is_static.push_back(object->IsStatic());
+    }
+    snapshot.transforms.assign(render_transforms.begin(), render_transforms.end());
+
+    const auto& springs = world.Springs();
+    snapshot.springs.clear();
+    for (int i = 0; i < springs.Size(); ++i)
+    {
+        snapshot.springs.push_back({
+            .start = render_transforms[springs.bodies1[i]].GlobalPosition(springs.local_anchors1[i]),
+            .end = render_transforms[springs.bodies2[i]].GlobalPosition(springs.local_anchors2[i])
+        });
+    }
+
+    snapshot.collisions.clear();
+    for (const auto& collision : world.Collisions())
+    {
+        snapshot.collisions.push_back(collision.info);
+    }
+
+    snapshot.stats = world.Stats();
+
+    // Releases the writes above to the reader.
+    m_write_index = m_ready_index.exchange(m_write_index | ready_flag, std::memory_order_acq_rel) & ~ready_flag;
+}
+
+void SimulationThread::ThreadLoop(std::stop_token stop_token, float publish_interval)
+{
+    using Clock = std::chrono::steady_clock;
+    PHYSICS_PROFILE_ONLY(Tracer::Global().SetThreadName("simulation"));
+    const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(publish_interval));
+
+    auto previous_time = Clock::now();
+    while (!stop_token.stop_requested())
+    {
+        const auto current_time = Clock::now();
+        Advance(std::chrono::duration<float>(current_time - previous_time).count());
+        previous_time = current_time;
+
+        std::this_thread::sleep_until(current_time + interval);
+    }
+}
+
+} // namespace physics
@@ -0,0 +1,91 @@
+#include "SlotMap.h"
+#include <cassert>
+#include <utility>
+
+namespace physics
+{
+
+BodyHandle SlotMap::Insert()
+{
+    const auto dense_index = static_cast<std::uint32_t>(m_dense_to_slot.size());
+
+    // Reuse a freed slot if possible.
+    auto slot_index = m_free_head;
+    if (slot_index != BodyHandle::invalid_slot)
+    {
+        m_free_head = m_slots[slot_index].index;
+    }
+    else
+    {
+        slot_index = static_cast<std::uint32_t>(m_slots.size());
+        m_slots.push_back(Slot{.generation = 0});
+    }
+
+    auto& slot = m_slots[slot_index];
+    slot.index = dense_index;
+    slot.occupied = true;
+    m_dense_to_slot.push_back(slot_index);
+
+    return BodyHandle{slot_index, slot.generation};
+}
+
+void SlotMap::Erase(BodyHandle handle)
+{
+    const auto dense_index = DenseIndex(handle);
+    assert(dense_index >= 0);
+
+    // Mirror the swap-remove of the dense array.
+    const auto moved_slot = m_dense_to_slot.back();
+    m_dense_to_slot[dense_index] = moved_slot;
+    m_slots[moved_slot].index = dense_index;
+    m_dense_to_slot.pop_back();
+
+    // Invalidate every handle to this slot, and put it on the free list.
+    auto& slot = m_slots[handle.slot];
+    ++slot.generation;
+    slot.occupied = false;
+    slot.index = m_free_head;
+    m_free_head = handle.slot;
+}
+
+void SlotMap::Swap(int first, int second)
+{
+    std::swap(m_dense_to_slot[first], m_dense_to_slot[second]);
+    m_slots[m_dense_to_slot[first]].index = first;
+    m_slots[m_dense_to_slot[second]].index = second;
+}
+
+int SlotMap::DenseIndex(BodyHandle handle) const
+{
+    if (handle.slot >= m_slots.size())
+    {
+        return -1;
+    }
+
+    const auto& slot = m_slots[handle.slot];
+    if (!slot.occupied || slot.generation != handle.generation)
+    {
+        return -1;
+    }
+
+    return static_cast<int>(slot.index);
+}
+
+BodyHandle SlotMap::Handle(int dense_index) const
+{
+    const auto slot_index = m_dense_to_slot[dense_index];
+    return BodyHandle{slot_index, m_slots[slot_index].generation};
+}
+
+int SlotMap::Size() const
+{
+    return static_cast<int>(m_dense_to_slot.size());
+}
+
+void SlotMap::Reserve(int capacity)
+{
+    m_slots.reserve(capacity);
+    m_dense_to_slot.reserve(capacity);
+}
+
+} // namespace physics
@@ -4,8 +4,8 @@
 namespace physics
 {
 
-SpringConnector::SpringConnector(std::shared_ptr<World> world)
-    : m_world(world)
+SpringConnector::SpringConnector(std::shared_ptr<SimulationThread> simulation)
+    : m_simulation(simulation)
 {}
 
 std::string SpringConnector::Description() const
@@ -35,46 +35,57 @@ void SpringConnector::OnMouseRelease(const Vec3& mouse_pos)
 {
     if (m_spring_start.has_value())
     {
-        auto spring_end = TryPickAnchorPoint(mouse_pos);
-
-        if (spring_end.has_value())
-        {
-            // Both end points are on the same object.
-            if (m_spring_start->object.get() == spring_end->object.get())
+        const auto spring_end = TryPickAnchorPoint(mouse_pos);
+        m_simulation->Submit([start = m_spring_start.value(), end = spring_end, hertz = m_spring_hertz, damping_ratio = m_spring_damping_ratio](World& world) {
+            // The objects might have been removed since they were picked.
+            auto spring_start = world.MakeAnchorPoint(start.first, start.second);
+            auto spring_end = std::optional<AnchorPoint>{};
+            if (end.has_value())
             {
-                m_world->RemoveSpringOnObject(m_spring_start->object);
+                spring_end = world.MakeAnchorPoint(end->first, end->second);
             }
-            else
+
+            if (spring_start.has_value() && spring_end.has_value())
             {
-                const auto neutral_distance = (m_spring_start->GlobalPosition() - spring_end->GlobalPosition()).Magnitude();
-                m_world->AddSpring(Spring{
-                    .start = m_spring_start.value(),
-                    .end = spring_end.value(),
-                    .neutral_distance = neutral_distance,
-                    .coefficient = m_spring_coefficient
-                });
+                // Both end points are on the same object.
+                if (spring_start->object == spring_end->object)
+                {
+                    world.RemoveSpringOnObject(spring_start->object);
+                }
+                else
+                {
+                    const auto neutral_distance = (spring_start->GlobalPosition() - spring_end->GlobalPosition()).Magnitude();
+                    world.AddSpring(Spring{
+                        .start = spring_start.value(),
+                        .end = spring_end.value(),
+                        .neutral_distance = neutral_distance,
+                        .hertz = hertz,
+                        .damping_ratio = damping_ratio
+                    });
+                }
             }
-        }
+        });
 
         m_spring_start.reset();
     }
 }
 
-void SpringConnector::ConfigureSprintCoefficient(float coefficient)
+void SpringConnector::ConfigureSpring(float hertz, float damping_ratio)
 {
-    assert(coefficient > 0.0f);
+    assert(hertz > 0.0f);
+    assert(damping_ratio >= 0.0f);
 
-    m_spring_coefficient = coefficient;
+    m_spring_hertz = hertz;
+    m_spring_damping_ratio = damping_ratio;
 }
 
-std::optional<AnchorPoint> SpringConnector::TryPickAnchorPoint(const Vec3& mouse_pos) const
+std::optional<std::pair<BodyHandle, Vec3>> SpringConnector::TryPickAnchorPoint(const Vec3& mouse_pos) const
 {
-    if (auto object = m_world->PickObject(mouse_pos))
+    const auto& snapshot = m_simulation->Snapshot();
+    const auto handle = snapshot.PickHandle(mouse_pos);
+    if (const auto index = snapshot.Find(handle))
     {
-        return AnchorPoint{
-            .object = object,
-            .local_pos = object->Transform().LocalPosition(mouse_pos)
-        };
+        return std::pair{handle, snapshot.transforms[*index].LocalPosition(mouse_pos)};
     }
 
     return {};
@@ -0,0 +1,209 @@
+#include "SpringStorage.h"
+#include "Softness.h"
+#include "SwapRemove.h"
+#include <algorithm>
+#include <cassert>
+
+namespace physics
+{
+
+void SpringStorage::Add(const Spring& spring)
+{
+    const auto body1 = spring.start.object->BodyIndex();
+    const auto body2 = spring.end.object->BodyIndex();
+    assert(body1 != body2);
+
+    const auto index = Size();
+    bodies1.push_back(body1);
+    bodies2.push_back(body2);
+    local_anchors1.push_back(spring.start.local_pos);
+    local_anchors2.push_back(spring.end.local_pos);
+    neutral_distances.push_back(spring.neutral_distance);
+    frequencies.push_back(spring.hertz);
+    damping_ratios.push_back(spring.damping_ratio);
+    impulses.push_back(0.0f);
+
+    m_rel_anchors1.emplace_back();
+    m_rel_anchors2.emplace_back();
+    m_axes.emplace_back();
+    m_stretches.push_back(0.0f);
+    m_axial_masses.push_back(0.0f);
+
+    if (m_springs_of_body.size() <= std::max(body1, body2))
+    {
+        m_springs_of_body.resize(std::max(body1, body2) + 1);
+    }
+    m_springs_of_body[body1].push_back(index);
+    m_springs_of_body[body2].push_back(index);
+}
+
+void SpringStorage::RemoveSpringsOnBody(int body)
+{
+    if (body >= m_springs_of_body.size())
+    {
+        return;
+    }
+
+    const auto& springs = m_springs_of_body[body];
+    while (!springs.empty())
+    {
+        SwapRemove(springs.back());
+    }
+}
+
+void SpringStorage::MoveBody(int from, int to)
+{
+    if (from >= m_springs_of_body.size())
+    {
+        return;
+    }
+    if (m_springs_of_body.size() <= to)
+    {
+        m_springs_of_body.resize(to + 1);
+    }
+    assert(m_springs_of_body[to].empty());
+
+    for (const auto spring : m_springs_of_body[from])
+    {
+        if (bodies1[spring] == from)
+        {
+            bodies1[spring] = to;
+        }
+        if (bodies2[spring] == from)
+        {
+            bodies2[spring] = to;
+        }
+    }
+    std::swap(m_springs_of_body[from], m_springs_of_body[to]);
+}
+
+void SpringStorage::SwapBodies(int first, int second)
+{
+    const auto max_body = std::max(first, second);
+    if (m_springs_of_body.size() <= max_body)
+    {
+        m_springs_of_body.resize(max_body + 1);
+    }
+
+    const auto swap_body = [&](int& body) {
+        body = body == first ? second : (body == second ? first : body);
+    };
+    for (const auto spring : m_springs_of_body[first])
+    {
+        swap_body(bodies1[spring]);
+        swap_body(bodies2[spring]);
+    }
+    for (const auto spring : m_springs_of_body[second])
+    {
+        // Springs between both bodies were already swapped above.
+        if (bodies1[spring] != first && bodies2[spring] != first)
+        {
+            swap_body(bodies1[spring]);
+            swap_body(bodies2[spring]);
+        }
+    }
+    std::swap(m_springs_of_body[first], m_springs_of_body[second]);
+}
+
+int SpringStorage::Size() const
+{
+    return static_cast<int>(bodies1.size());
+}
+
+void SpringStorage::Prepare(const BodyStorage& bodies, int begin, int end)
+{
+    for (int i = begin; i < end; ++i)
+    {
+        const auto body1 = bodies1[i];
+        const auto body2 = bodies2[i];
+        const auto& transform1 = bodies.transforms[body1];
+        const auto& transform2 = bodies.transforms[body2];
+
+        // Rotate each anchor only once per pass,
+        // instead of on every access during the iterations.
+        const auto rel_anchor1 = transform1.GlobalDirection(local_anchors1[i]);
+        const auto rel_anchor2 = transform2.GlobalDirection(local_anchors2[i]);
+        const auto displacement = (transform2.Position() + rel_anchor2) - (transform1.Position() + rel_anchor1);
+
+        auto axis = displacement;
+        axis.Normalize();
+
+        // Same as EffectiveMass(), without going through Rigidbody.
+        const auto inv_axial_mass = bodies.inv_masses[body1] + bodies.inv_masses[body2]
+            + rel_anchor1.Cross(axis).SquaredMagnitude() * bodies.inv_inertias[body1]
+            + rel_anchor2.Cross(axis).SquaredMagnitude() * bodies.inv_inertias[body2];
+
+        m_rel_anchors1[i] = rel_anchor1;
+        m_rel_anchors2[i] = rel_anchor2;
+        m_axes[i] = axis;
+        m_stretches[i] = displacement.Magnitude() - neutral_distances[i];
+        m_axial_masses[i] = inv_axial_mass > 0.0f ? 1.0f / inv_axial_mass : 0.0f;
+    }
+}
+
+void SpringStorage::WarmStart(BodyStorage& bodies) const
+{
+    const auto size = Size();
+    for (int i = 0; i < size; ++i)
+    {
+        const auto axial_impulse = m_axes[i] * impulses[i];
+        bodies.ApplyInstantImpulse(bodies1[i], m_rel_anchors1[i], -axial_impulse);
+        bodies.ApplyInstantImpulse(bodies2[i], m_rel_anchors2[i], axial_impulse);
+    }
+}
+
+void SpringStorage::Solve(BodyStorage& bodies, float time_step)
+{
+    const auto size = Size();
+    for (int i = 0; i < size; ++i)
+    {
+        const auto body1 = bodies1[i];
+        const auto body2 = bodies2[i];
+        const auto& axis = m_axes[i];
+        const auto axial_velocity = (bodies.GlobalVelocity(body2, m_rel_anchors2[i]) - bodies.GlobalVelocity(body1, m_rel_anchors1[i])).Dot(axis);
+
+        // The spring constant is "mass * (2 * pi * hertz)^2", where the mass is the effective mass along the axis.
+        // Solving it as a soft constraint gives the velocity that implicit euler integration would give.
+        const auto softness = MakeSoftness(frequencies[i], damping_ratios[i], time_step);
+        const auto bias = softness.bias_rate * m_stretches[i];
+        const auto delta = -m_axial_masses[i] * softness.mass_scale * (axial_velocity + bias) - softness.impulse_scale * impulses[i];
+        impulses[i] += delta;
+
+        bodies.ApplyInstantImpulse(body1, m_rel_anchors1[i], -axis * delta);
+        bodies.ApplyInstantImpulse(body2, m_rel_anchors2[i], axis * delta);
+    }
+}
+
+void SpringStorage::SwapRemove(int index)
+{
+    const auto last = Size() - 1;
+
+    // Detach the removed spring from its bodies,
+    // and let the bodies of the last spring know its new index.
+    SwapRemoveValue(m_springs_of_body[bodies1[index]], index);
+    SwapRemoveValue(m_springs_of_body[bodies2[index]], index);
+    if (index != last)
+    {
+        for (const auto body : {bodies1[last], bodies2[last]})
+        {
+            auto& springs = m_springs_of_body[body];
+            *std::find(springs.begin(), springs.end(), last) = index;
+        }
+    }
+
+    SwapRemoveElement(bodies1, index);
+    SwapRemoveElement(bodies2, index);
+    SwapRemoveElement(local_anchors1, index);
+    SwapRemoveElement(local_anchors2, index);
+    SwapRemoveElement(neutral_distances, index);
+    SwapRemoveElement(frequencies, index);
+    SwapRemoveElement(damping_ratios, index);
+    SwapRemoveElement(impulses, index);
+    SwapRemoveElement(m_rel_anchors1, index);
+    SwapRemoveElement(m_rel_anchors2, index);
+    SwapRemoveElement(m_axes, index);
+    SwapRemoveElement(m_stretches, index);
+    SwapRemoveElement(m_axial_masses, index);
+}
+
+} // namespace physics
@@ -0,0 +1,331 @@
+#include "StressScenes.h"
+#include "Angle.h"
+#include "Circle.h"
+#include "ConvexPolygon.h"
+#include "PoolAllocator.h"
+#include "ShapeCache.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <random>
+
+namespace physics
+{
+
+// Same scale as the demo, where a meter is 60 pixels and y points down.
+constexpr auto scene_gravity = Vec3{0.0f, 9.8f * 60.0f};
+
+std::shared_ptr<Rigidbody> CreateSceneObject(std::shared_ptr<ICollider> collider, const Vec3& position, bool is_static = false)
+{
+    auto default_mat = MaterialProperties{
+        .restitution = 0.2f,
+        .static_friction = 0.6f,
+        .dynamic_friction = 0.3f
+    };
+
+    // Approximate mass and inertia based on the size, same as the demo.
+    const auto area = collider->Area();
+    const auto mass = area;
+    const auto inertia = area * area + mass * collider->CenterOfMass().SquaredMagnitude();
+
+    auto object = MakePooled<Rigidbody>(collider, default_mat, mass, inertia);
+    object->Transform().SetPosition(position);
+    if (is_static)
+    {
+        object->MakeObjectStatic();
+    }
+    return object;
+}
+
+std::vector<Vec3> BoxVertices(float half_width, float half_height)
+{
+    return {
+        {-half_width, -half_height},
+        {half_width, -half_height},
+        {half_width, half_height},
+        {-half_width, half_height}
+    };
+}
+
+std::vector<Vec3> RegularPolygonVertices(int num_vertices, float radius)
+{
+    auto vertices = std::vector<Vec3>();
+    for (int i = 0; i < num_vertices; ++i)
+    {
+        const auto [sin, cos] = DeterministicSinCos(2.0f * pi * i / num_vertices);
+        vertices.push_back({radius * cos, radius * sin});
+    }
+    return vertices;
+}
+
+/**
+ * @brief Random numbers which are the same on every platform.
+ *        std::mt19937 is fully specified, unlike the standard distributions.
+ */
+class SceneRandom
+{
+public:
+    explicit SceneRandom(std::uint32_t seed)
+        : m_engine(seed)
+    {}
+
+    // Uniform in [min, max).
+    float Range(float min, float max)
+    {
+        return min + (max - min) * static_cast<float>(m_engine() >> 8) / static_cast<float>(1 << 24);
+    }
+
+    // Uniform in [min, max].
+    int Integer(int min, int max)
+    {
+        return min + static_cast<int>(m_engine() % static_cast<std::uint32_t>(max - min + 1));
+    }
+
+private:
+    std::mt19937 m_engine;
+};
+
+int GridSide(int num_bodies)
+{
+    return std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(num_bodies)))));
+}
+
+/**
+ * @brief Boxes stacked into a triangle on a static ground, which the solver has to keep at rest.
+ */
+void BuildPyramid(World& world, int num_bodies)
+{
+    constexpr auto half_size = 10.0f;
+    constexpr auto gap = 1.0f;
+
+    // The smallest pyramid with at least num_bodies boxes, whose top rows are left out.
+    auto num_rows = 1;
+    while (num_rows * (num_rows + 1) / 2 < num_bodies)
+    {
+        ++num_rows;
+    }
+    const auto base_width = num_rows * (2.0f * half_size + gap);
+
+    auto shape_cache = ShapeCache();
+    world.ConfigureGravity(scene_gravity);
+    world.AddObject(CreateSceneObject(
+        MakePooled<ConvexPolygon>(shape_cache.Polygon(BoxVertices(base_width, 20.0f))),
+        {0.0f, 20.0f},
+        true
+    ));
+
+    const auto box = shape_cache.Polygon(BoxVertices(half_size, half_size));
+    auto num_added = 0;
+    for (int row = 0; row < num_rows && num_added < num_bodies; ++row)
+    {
+        const auto num_columns = num_rows - row;
+        const auto left = -0.5f * (num_columns - 1) * (2.0f * half_size + gap);
+        const auto y = -half_size - row * 2.0f * half_size;
+        for (int column = 0; column < num_columns && num_added < num_bodies; ++column, ++num_added)
+        {
+            world.AddObject(CreateSceneObject(
+                MakePooled<ConvexPolygon>(box),
+                {left + column * (2.0f * half_size + gap), y}
+            ));
+        }
+    }
+}
+
+/**
+ * @brief A grid of circles falling through a static funnel,
+ *        which piles up at its neck and then in a bin below.
+ */
+void BuildFunnel(World& world, int num_bodies)
+{
+    constexpr auto radius = 5.0f;
+    constexpr auto spacing = 12.0f;
+
+    const auto num_columns = GridSide(num_bodies);
+    const auto width = num_columns * spacing;
+    const auto wall_length = 0.75f * width + 100.0f;
+
+    auto shape_cache = ShapeCache();
+    world.ConfigureGravity(scene_gravity);
+
+    // Two walls leaning 45 degrees inwards, leaving a neck a few circles wide.
+    const auto wall = shape_cache.Polygon(BoxVertices(wall_length, 20.0f));
+    const auto neck = 4.0f * spacing;
+    const auto offset = wall_length * std::numbers::sqrt2_v<float> / 2.0f;
+    for (const auto side : {-1.0f, 1.0f})
+    {
+        auto object = CreateSceneObject(MakePooled<ConvexPolygon>(wall), {side * (neck + offset), -offset}, true);
+        object->Transform().SetRotation(side * -pi / 4.0f);
+        world.AddObject(object);
+    }
+
+    // A bin below the neck as wide as the funnel, so that nothing falls off the world.
+    const auto bin_half_width = neck + 2.0f * offset;
+    const auto bin_depth = bin_half_width;
+    const auto bin_wall = shape_cache.Polygon(BoxVertices(40.0f, 0.5f * bin_depth));
+    world.AddObject(CreateSceneObject(MakePooled<ConvexPolygon>(bin_wall), {-bin_half_width - 40.0f, 0.5f * bin_depth}, true));
+    world.AddObject(CreateSceneObject(MakePooled<ConvexPolygon>(bin_wall), {bin_half_width + 40.0f, 0.5f * bin_depth}, true));
+    world.AddObject(CreateSceneObject(
+        MakePooled<ConvexPolygon>(shape_cache.Polygon(BoxVertices(bin_half_width + 80.0f, 40.0f))),
+        {0.0f, bin_depth + 40.0f},
+        true
+    ));
+
+    const auto top = -2.0f * offset - 50.0f;
+    for (int i = 0; i < num_bodies; ++i)
+    {
+        const auto row = i / num_columns;
+        const auto column = i % num_columns;
+        // Every other row is shifted, so the circles don't land on top of each other.
+        const auto x = (column - 0.5f * (num_columns - 1) + 0.5f * (row % 2)) * spacing;
+        world.AddObject(CreateSceneObject(MakePooled<Circle>(radius), {x, top - row * spacing}));
+    }
+}
+
+/**
+ * @brief Polygons of every vertex count and circles, dropped into a static box.
+ */
+void BuildPile(World& world, int num_bodies)
+{
+    constexpr auto max_radius = 12.0f;
+    constexpr auto spacing = 2.0f * max_radius + 2.0f;
+
+    const auto num_columns = GridSide(num_bodies);
+    const auto half_width = 0.5f * num_columns * spacing + 20.0f;
+
+    auto shape_cache = ShapeCache();
+    world.ConfigureGravity(scene_gravity);
+
+    const auto wall = shape_cache.Polygon(BoxVertices(10.0f, half_width));
+    world.AddObject(CreateSceneObject(MakePooled<ConvexPolygon>(wall), {-half_width - 10.0f, -half_width}, true));
+    world.AddObject(CreateSceneObject(MakePooled<ConvexPolygon>(wall), {half_width + 10.0f, -half_width}, true));
+    world.AddObject(CreateSceneObject(
+        MakePooled<ConvexPolygon>(shape_cache.Polygon(BoxVertices(half_width + 20.0f, 10.0f))),
+        {0.0f, 10.0f},
+        true
+    ));
+
+    // A few sizes per vertex count, so identical shapes still share their geometry.
+    constexpr auto radii = std::array{6.0f, 9.0f, 12.0f};
+    auto random = SceneRandom(45);
+    for (int i = 0; i < num_bodies; ++i)
+    {
+        const auto row = i / num_columns;
+        const auto column = i % num_columns;
+        const auto position = Vec3{(column - 0.5f * (num_columns - 1)) * spacing, -max_radius - 5.0f - row * spacing};
+
+        // 2 vertices means a circle.
+        const auto num_vertices = random.Integer(2, 8);
+        const auto radius = radii[random.Integer(0, static_cast<int>(radii.size()) - 1)];
+        auto collider = num_vertices == 2
+            ? std::shared_ptr<ICollider>(MakePooled<Circle>(radius))
+            : std::shared_ptr<ICollider>(MakePooled<ConvexPolygon>(
+                shape_cache.Polygon(RegularPolygonVertices(num_vertices, radius))
+            ));
+
+        auto object = CreateSceneObject(std::move(collider), position);
+        object->Transform().SetRotation(random.Range(0.0f, 2.0f * pi));
+        world.AddObject(object);
+    }
+}
+
+/**
+ * @brief A square cloth of circles connected by springs to their neighbors,
+ *        which hangs from its static top row.
+ */
+void BuildLattice(World& world, int num_bodies)
+{
+    constexpr auto radius = 4.0f;
+    constexpr auto spacing = 20.0f;
+
+    const auto side = GridSide(num_bodies);
+    world.ConfigureGravity(scene_gravity);
+
+    // The top row is pinned, and the cloth starts stretched sideways so that it swings.
+    auto handles = std::vector<BodyHandle>();
+    for (int row = 0; row < side; ++row)
+    {
+        for (int column = 0; column < side; ++column)
+        {
+            const auto position = Vec3{(column - 0.5f * (side - 1)) * spacing, row * spacing * 0.5f};
+            handles.push_back(world.AddObject(CreateSceneObject(MakePooled<Circle>(radius), position, row == 0)));
+        }
+    }
+
+    const auto connect = [&world](BodyHandle handle1, BodyHandle handle2) {
+        world.AddSpring({
+            .start = *world.MakeAnchorPoint(handle1, {}),
+            .end = *world.MakeAnchorPoint(handle2, {}),
+            .neutral_distance = spacing,
+            .hertz = 8.0f,
+            .damping_ratio = 0.2f
+        });
+    };
+    for (int row = 0; row < side; ++row)
+    {
+        for (int column = 0; column < side; ++column)
+        {
+            const auto index = row * side + column;
+            if (column + 1 < side)
+            {
+                connect(handles[index], handles[index + 1]);
+            }
+            if (row + 1 < side)
+            {
+                connect(handles[index], handles[index + side]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Objects scattered over a large area without gravity, which rarely touch each other.
+ *        The cost is dominated by the broadphase and integration instead of the solver.
+ */
+void BuildSparse(World& world, int num_bodies)
+{
+    // About one object per 200x200 pixels.
+    constexpr auto cell_size = 200.0f;
+    const auto half_extent = 0.5f * GridSide(num_bodies) * cell_size;
+
+    auto shape_cache = ShapeCache();
+    world.ConfigureGravity({});
+
+    const auto box = shape_cache.Polygon(BoxVertices(8.0f, 8.0f));
+    auto random = SceneRandom(5);
+    for (int i = 0; i < num_bodies; ++i)
+    {
+        auto collider = i % 2 == 0
+            ? std::shared_ptr<ICollider>(MakePooled<Circle>(8.0f))
+            : std::shared_ptr<ICollider>(MakePooled<ConvexPolygon>(box));
+        auto object = CreateSceneObject(std::move(collider), {
+            random.Range(-half_extent, half_extent),
+            random.Range(-half_extent, half_extent)
+        });
+        object->SetLinearVelocity({random.Range(-50.0f, 50.0f), random.Range(-50.0f, 50.0f)});
+        world.AddObject(object);
+    }
+}
+
+constexpr auto stress_scenes = std::array{
+    StressScene{"pyramid", "boxes stacked into a pyramid", BuildPyramid},
+    StressScene{"funnel", "circles raining into a funnel", BuildFunnel},
+    StressScene{"pile", "mixed polygons and circles piled in a box", BuildPile},
+    StressScene{"lattice", "cloth of circles connected by springs", BuildLattice},
+    StressScene{"sparse", "objects scattered over a large area without gravity", BuildSparse}
+};
+
+std::span<const StressScene> StressScenes()
+{
+    return stress_scenes;
+}
+
+const StressScene* FindStressScene(std::string_view name)
+{
+    const auto it = std::find_if(stress_scenes.begin(), stress_scenes.end(), [name](const StressScene& scene) {
+        return name == scene.name;
+    });
+    return it != stress_scenes.end() ? &*it : nullptr;
+}
+
+} // namespace physics
@@ -0,0 +1,208 @@
+#include "Tracer.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace physics
+{
+
+/**
+ * @return @p nanoseconds in microseconds with three decimals, which is the unit of Chrome trace events.
+ */
+std::string Microseconds(std::int64_t nanoseconds)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%lld.%03lld",
+        static_cast<long long>(nanoseconds / 1000),
+        static_cast<long long>(nanoseconds % 1000));
+    return buffer;
+}
+
+Tracer::Tracer()
+    : m_epoch(Clock::now())
+{}
+
+Tracer::~Tracer()
+{
+    if (!m_exit_path.empty())
+    {
+        WriteChromeTrace(m_exit_path);
+    }
+}
+
+Tracer& Tracer::Global()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::Enable()
+{
+    {
+        auto lock = std::scoped_lock(m_mutex);
+        if (!m_slots)
+        {
+            m_slots = std::make_unique<Slot[]>(capacity);
+        }
+    }
+
+    // Releases the buffer to the threads which see the tracer enabled.
+    m_enabled.store(true, std::memory_order_release);
+}
+
+void Tracer::Disable()
+{
+    m_enabled.store(false, std::memory_order_relaxed);
+}
+
+bool Tracer::IsEnabled() const
+{
+    return m_enabled.load(std::memory_order_acquire);
+}
+
+void Tracer::Record(const char* name, Clock::time_point start, Clock::time_point end)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+
+    // Every event gets its own slot, so concurrent writers only meet
+    // if one of them was preempted for a whole lap of the ring buffer.
+    const auto index = m_next_event.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = m_slots[index % capacity];
+
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(start - m_epoch).count(), std::memory_order_relaxed);
+    slot.duration_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), std::memory_order_relaxed);
+    slot.thread_id.store(ThreadId(), std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::SetThreadName(std::string name)
+{
+    const auto thread_id = ThreadId();
+
+    auto lock = std::scoped_lock(m_mutex);
+    const auto it = std::find_if(m_thread_names.begin(), m_thread_names.end(), [thread_id](const auto& entry) {
+        return entry.first == thread_id;
+    });
+    if (it != m_thread_names.end())
+    {
+        it->second = std::move(name);
+    }
+    else
+    {
+        m_thread_names.emplace_back(thread_id, std::move(name));
+    }
+}
+
+void Tracer::WriteChromeTrace(std::ostream& out) const
+{
+    struct Event
+    {
+        const char* name;
+        std::int64_t start_ns;
+        std::int64_t duration_ns;
+        std::uint32_t thread_id;
+    };
+
+    auto lock = std::scoped_lock(m_mutex);
+
+    auto events = std::vector<Event>();
+    if (m_slots)
+    {
+        for (std::size_t i = 0; i < capacity; ++i)
+        {
+            const auto& slot = m_slots[i];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence == 0)
+            {
+                continue;
+            }
+
+            const auto event = Event{
+                .name = slot.name.load(std::memory_order_relaxed),
+                .start_ns = slot.start_ns.load(std::memory_order_relaxed),
+                .duration_ns = slot.duration_ns.load(std::memory_order_relaxed),
+                .thread_id = slot.thread_id.load(std::memory_order_relaxed)
+            };
+
+            // Skip the slot if a writer started overwriting it while we were reading.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                events.push_back(event);
+            }
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.start_ns < b.start_ns;
+    });
+
+    // Complete events ("X") carry both the begin and the end of a scope,
+    // so an event never loses its other half when the ring buffer wraps around.
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    auto is_first = true;
+    for (const auto& [thread_id, name] : m_thread_names)
+    {
+        out << (is_first ? "" : ",\n");
+        out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread_id
+            << ", \"args\": {\"name\": \"" << name << "\"}}";
+        is_first = false;
+    }
+    for (const auto& event : events)
+    {
+        out << (is_first ? "" : ",\n");
+        out << "{\"name\": \"" << event.name << "\", \"cat\": \"physics\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread_id
+            << ", \"ts\": " << Microseconds(event.start_ns)
+            << ", \"dur\": " << Microseconds(event.duration_ns) << "}";
+        is_first = false;
+    }
+    out << "\n]}\n";
+}
+
+bool Tracer::WriteChromeTrace(const std::string& path) const
+{
+    auto file = std::ofstream(path);
+    if (!file)
+    {
+        return false;
+    }
+    WriteChromeTrace(file);
+    return static_cast<bool>(file);
+}
+
+void Tracer::WriteOnExit(std::string path)
+{
+    auto lock = std::scoped_lock(m_mutex);
+    m_exit_path = std::move(path);
+}
+
+std::uint32_t Tracer::ThreadId()
+{
+    static auto next_thread_id = std::atomic<std::uint32_t>(1);
+    thread_local const auto thread_id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+    return thread_id;
+}
+
+TraceScope::TraceScope(const char* name)
+    : m_name(name), m_is_recording(Tracer::Global().IsEnabled())
+{
+    if (m_is_recording)
+    {
+        m_start = Tracer::Clock::now();
+    }
+}
+
+TraceScope::~TraceScope()
+{
+    if (m_is_recording)
+    {
+        Tracer::Global().Record(m_name, m_start, Tracer::Clock::now());
+    }
+}
+
+} // namespace physics
@@ -0,0 +1,662 @@
+#include "TrajectoryFile.h"
+#include "Tracer.h"
+#include "WorldFile.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <sstream>
+#include <type_traits>
+
+namespace physics
+{
+
+constexpr auto trajectory_file_magic = std::array<char, 8>{'P', 'H', 'Y', 'S', 'T', 'R', 'A', 'J'};
+constexpr std::uint32_t trajectory_file_byte_order = 0x01020304;
+
+// Position, rotation, linear velocity and angular velocity on the plane.
+constexpr int trajectory_values_per_object = 6;
+
+static_assert(std::is_trivially_copyable_v<TrajectoryFileHeader> && std::is_standard_layout_v<TrajectoryFileHeader>);
+static_assert(std::is_trivially_copyable_v<TrajectoryFileScene> && std::is_standard_layout_v<TrajectoryFileScene>);
+static_assert(std::is_trivially_copyable_v<TrajectoryFileChunk> && std::is_standard_layout_v<TrajectoryFileChunk>);
+
+/**
+ * @return The precision of each value of an object, in the order they are stored.
+ */
+std::array<float, trajectory_values_per_object> TrajectoryValuePrecisions(const TrajectoryFileHeader& header)
+{
+    return {
+        header.position_precision,
+        header.position_precision,
+        header.rotation_precision,
+        header.velocity_precision,
+        header.velocity_precision,
+        header.rotation_precision
+    };
+}
+
+/**
+ * @return @p value in steps of @p precision, clamped to the range of the integer.
+ */
+std::int32_t QuantizeTrajectoryValue(float value, float precision)
+{
+    const auto steps = std::round(static_cast<double>(value) / precision);
+    if (std::isnan(steps))
+    {
+        return 0;
+    }
+    constexpr auto min_steps = static_cast<double>(std::numeric_limits<std::int32_t>::min());
+    constexpr auto max_steps = static_cast<double>(std::numeric_limits<std::int32_t>::max());
+    return static_cast<std::int32_t>(std::clamp(steps, min_steps, max_steps));
+}
+
+float DequantizeTrajectoryValue(std::int32_t steps, float precision)
+{
+    return static_cast<float>(static_cast<double>(steps) * precision);
+}
+
+/**
+ * @brief Append the difference of two quantized values as a zigzag-encoded variable-length integer,
+ *        which takes a single byte for the small differences of smoothly moving or resting objects.
+ */
+void AppendTrajectoryDelta(std::vector<std::byte>& bytes, std::int32_t value, std::int32_t previous)
+{
+    const auto delta = static_cast<std::int64_t>(value) - previous;
+    auto zigzag = (static_cast<std::uint64_t>(delta) << 1) ^ static_cast<std::uint64_t>(delta >> 63);
+    while (zigzag >= 0x80)
+    {
+        bytes.push_back(static_cast<std::byte>(zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    bytes.push_back(static_cast<std::byte>(zigzag));
+}
+
+/**
+ * @brief Add the difference stored at @p cursor to @p value, and move the cursor past it.
+ * @return False if the bytes end in the middle of the integer, or it is too long.
+ */
+bool ReadTrajectoryDelta(std::span<const std::byte> bytes, std::size_t& cursor, std::int32_t& value)
+{
+    auto zigzag = std::uint64_t{0};
+    for (auto shift = 0; shift < 64; shift += 7)
+    {
+        if (cursor == bytes.size())
+        {
+            return false;
+        }
+        const auto byte = std::to_integer<std::uint64_t>(bytes[cursor++]);
+        zigzag |= (byte & 0x7f) << shift;
+        if (byte < 0x80)
+        {
+            const auto delta = static_cast<std::int64_t>(zigzag >> 1) ^ -static_cast<std::int64_t>(zigzag & 1);
+            value = static_cast<std::int32_t>(value + delta);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Overwrite @p stored with @p value.
+ * @return True if they differed in any bit, which catches every change of a float, even to NaN.
+ *
+ * @note Only for records of 4-byte fields without padding.
+ */
+template<typename T>
+bool AssignIfChanged(T& stored, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % 4 == 0);
+    if (std::memcmp(&stored, &value, sizeof(T)) == 0)
+    {
+        return false;
+    }
+    stored = value;
+    return true;
+}
+
+template<typename T>
+void WriteTrajectoryRecords(std::ostream& out, std::span<T> records)
+{
+    out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size_bytes()));
+}
+
+template<typename T>
+bool ReadTrajectoryRecords(std::istream& in, std::span<T> records)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size_bytes())));
+}
+
+std::unique_ptr<TrajectoryRecorder> TrajectoryRecorder::Open(const std::string& path, const TrajectoryRecorderOptions& options)
+{
+    assert(options.position_precision > 0.0f);
+    assert(options.rotation_precision > 0.0f);
+    assert(options.velocity_precision > 0.0f);
+    assert(options.frames_per_chunk > 0);
+
+    auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        return {};
+    }
+    return std::unique_ptr<TrajectoryRecorder>(new TrajectoryRecorder(std::move(out), options));
+}
+
+TrajectoryRecorder::TrajectoryRecorder(std::ofstream out, const TrajectoryRecorderOptions& options)
+    : m_header{
+        .magic = trajectory_file_magic,
+        .version = trajectory_file_version,
+        .byte_order = trajectory_file_byte_order,
+        .fixed_time_step = 0.0f,
+        .position_precision = options.position_precision,
+        .rotation_precision = options.rotation_precision,
+        .velocity_precision = options.velocity_precision,
+        .num_frames = 0,
+        .index_offset = 0,
+        .num_scenes = 0,
+        .num_chunks = 0
+    }
+    , m_frames_per_chunk(options.frames_per_chunk)
+    , m_out(std::move(out))
+{
+    // Holds the place of the header, which is written again by Finish().
+    WriteTrajectoryRecords(m_out, std::span(&m_header, 1));
+    m_file_size = sizeof(TrajectoryFileHeader);
+
+    m_writer = std::jthread([this](std::stop_token stop_token) {
+        WriterLoop(stop_token);
+    });
+}
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+    Finish();
+}
+
+void TrajectoryRecorder::Record(const World& world)
+{
+    PHYSICS_TRACE_SCOPE("record trajectory");
+    auto lock = std::lock_guard(m_record_mutex);
+    if (m_is_finished)
+    {
+        return;
+    }
+
+    if (m_num_frames.load(std::memory_order_relaxed) == 0)
+    {
+        m_header.fixed_time_step = world.FixedTimeStep();
+    }
+
+    // The frames refer to the objects by their order,
+    // so a new scene starts a new chunk as well.
+    if (IsNewScene(world))
+    {
+        FlushChunk();
+
+        auto scene = std::ostringstream();
+        WriteWorldFile(world, scene);
+        const auto scene_bytes = scene.str();
+
+        auto block = Block{.bytes = TakeBuffer(), .is_scene = true};
+        block.bytes.resize(scene_bytes.size());
+        std::memcpy(block.bytes.data(), scene_bytes.data(), scene_bytes.size());
+        Push(std::move(block));
+    }
+
+    if (m_chunk.num_frames == static_cast<std::uint32_t>(m_frames_per_chunk))
+    {
+        FlushChunk();
+    }
+    if (m_chunk.num_frames == 0)
+    {
+        m_chunk.bytes = TakeBuffer();
+        m_chunk.first_frame = m_num_frames.load(std::memory_order_relaxed);
+        std::ranges::fill(m_previous_values, 0);
+    }
+
+    const auto precisions = TrajectoryValuePrecisions(m_header);
+    const auto& objects = world.Objects();
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        const auto& transform = objects[i]->Transform();
+        const auto& linear_velocity = objects[i]->LinearVelocity();
+        const auto values = std::array<float, trajectory_values_per_object>{
+            transform.Position().x,
+            transform.Position().y,
+            transform.Rotation(),
+            linear_velocity.x,
+            linear_velocity.y,
+            objects[i]->AngularVelocity().z
+        };
+
+        auto* previous = &m_previous_values[i * trajectory_values_per_object];
+        for (int value = 0; value < trajectory_values_per_object; ++value)
+        {
+            const auto quantized = QuantizeTrajectoryValue(values[value], precisions[value]);
+            AppendTrajectoryDelta(m_chunk.bytes, quantized, previous[value]);
+            previous[value] = quantized;
+        }
+    }
+
+    ++m_chunk.num_frames;
+    m_num_frames.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool TrajectoryRecorder::Finish()
+{
+    auto lock = std::lock_guard(m_record_mutex);
+    if (m_is_finished)
+    {
+        return !m_failed;
+    }
+    m_is_finished = true;
+
+    // The writer drains the queue before it stops.
+    FlushChunk();
+    m_writer.request_stop();
+    m_writer.join();
+
+    m_header.num_frames = m_num_frames.load(std::memory_order_relaxed);
+    m_header.index_offset = m_file_size;
+    m_header.num_scenes = m_scenes.size();
+    m_header.num_chunks = m_chunks.size();
+    WriteTrajectoryRecords(m_out, std::span(m_scenes));
+    WriteTrajectoryRecords(m_out, std::span(m_chunks));
+    m_out.seekp(0);
+    WriteTrajectoryRecords(m_out, std::span(&m_header, 1));
+    m_out.close();
+
+    m_failed = m_failed || !m_out;
+    return !m_failed;
+}
+
+std::uint64_t TrajectoryRecorder::NumFrames() const
+{
+    return m_num_frames.load(std::memory_order_relaxed);
+}
+
+bool TrajectoryRecorder::IsNewScene(const World& world)
+{
+    const auto& objects = world.Objects();
+    const auto& springs = world.Springs();
+    auto is_new = !m_has_scene || objects.size() != m_scene_objects.size() || springs.Size() != m_scene_springs.size();
+    m_has_scene = true;
+
+    m_scene_objects.resize(objects.size());
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        const auto object = SceneObject{
+            .handle = world.Handle(*objects[i]),
+            .inv_mass = objects[i]->InverseMass(),
+            .inv_inertia = objects[i]->InverseInertia(),
+            .material = objects[i]->Material()
+        };
+        is_new = AssignIfChanged(m_scene_objects[i], object) || is_new;
+    }
+
+    m_scene_springs.resize(springs.Size());
+    for (int i = 0; i < springs.Size(); ++i)
+    {
+        const auto spring = SceneSpring{
+            .body1 = springs.bodies1[i],
+            .body2 = springs.bodies2[i],
+            .local_anchor1 = springs.local_anchors1[i],
+            .local_anchor2 = springs.local_anchors2[i],
+            .neutral_distance = springs.neutral_distances[i],
+            .hertz = springs.frequencies[i],
+            .damping_ratio = springs.damping_ratios[i]
+        };
+        is_new = AssignIfChanged(m_scene_springs[i], spring) || is_new;
+    }
+
+    if (is_new)
+    {
+        m_previous_values.resize(objects.size() * trajectory_values_per_object);
+    }
+    return is_new;
+}
+
+void TrajectoryRecorder::FlushChunk()
+{
+    if (m_chunk.num_frames == 0)
+    {
+        return;
+    }
+    Push(std::move(m_chunk));
+    m_chunk = Block{};
+}
+
+std::vector<std::byte> TrajectoryRecorder::TakeBuffer()
+{
+    auto lock = std::lock_guard(m_queue_mutex);
+    if (m_free_buffers.empty())
+    {
+        return {};
+    }
+    auto buffer = std::move(m_free_buffers.back());
+    m_free_buffers.pop_back();
+    buffer.clear();
+    return buffer;
+}
+
+void TrajectoryRecorder::Push(Block block)
+{
+    {
+        auto lock = std::lock_guard(m_queue_mutex);
+        m_pending.push_back(std::move(block));
+    }
+    m_wake.notify_one();
+}
+
+void TrajectoryRecorder::WriterLoop(std::stop_token stop_token)
+{
+    PHYSICS_PROFILE_ONLY(Tracer::Global().SetThreadName("trajectory writer"));
+
+    auto blocks = std::vector<Block>();
+    while (true)
+    {
+        {
+            auto lock = std::unique_lock(m_queue_mutex);
+            // Returns false only once stopped with nothing left to write.
+            if (!m_wake.wait(lock, stop_token, [this] { return !m_pending.empty(); }))
+            {
+                return;
+            }
+            std::swap(blocks, m_pending);
+        }
+
+        PHYSICS_TRACE_SCOPE("write trajectory");
+        for (const auto& block : blocks)
+        {
+            if (block.is_scene)
+            {
+                m_scenes.push_back({.offset = m_file_size, .size = block.bytes.size()});
+            }
+            else
+            {
+                assert(!m_scenes.empty());
+                m_chunks.push_back({
+                    .first_frame = block.first_frame,
+                    .offset = m_file_size,
+                    .size = block.bytes.size(),
+                    .num_frames = block.num_frames,
+                    .scene = static_cast<std::uint32_t>(m_scenes.size() - 1)
+                });
+            }
+            WriteTrajectoryRecords(m_out, std::span(block.bytes));
+            m_file_size += block.bytes.size();
+        }
+        m_failed = m_failed || !m_out;
+
+        {
+            auto lock = std::lock_guard(m_queue_mutex);
+            for (auto& block : blocks)
+            {
+                m_free_buffers.push_back(std::move(block.bytes));
+            }
+        }
+        blocks.clear();
+    }
+}
+
+std::unique_ptr<TrajectoryReader> TrajectoryReader::Open(const std::string& path)
+{
+    auto in = std::ifstream(path, std::ios::binary | std::ios::ate);
+    if (!in)
+    {
+        return {};
+    }
+    const auto size = static_cast<std::uint64_t>(in.tellg());
+    in.seekg(0);
+
+    auto header = TrajectoryFileHeader{};
+    if (size < sizeof(header) || !ReadTrajectoryRecords(in, std::span(&header, 1)))
+    {
+        return {};
+    }
+
+    // The time step and the precisions are divisors, and an unfinished recording has no index.
+    const auto is_positive = [](float value) { return value > 0.0f && std::isfinite(value); };
+    if (header.magic != trajectory_file_magic ||
+        header.version != trajectory_file_version ||
+        header.byte_order != trajectory_file_byte_order ||
+        !is_positive(header.fixed_time_step) ||
+        !is_positive(header.position_precision) ||
+        !is_positive(header.rotation_precision) ||
+        !is_positive(header.velocity_precision) ||
+        header.index_offset < sizeof(header) ||
+        header.index_offset > size)
+    {
+        return {};
+    }
+
+    // Compared by division, so that corrupted counts cannot overflow.
+    const auto index_size = size - header.index_offset;
+    if (header.num_scenes > index_size / sizeof(TrajectoryFileScene) ||
+        header.num_chunks > index_size / sizeof(TrajectoryFileChunk) ||
+        header.num_scenes * sizeof(TrajectoryFileScene) + header.num_chunks * sizeof(TrajectoryFileChunk) != index_size)
+    {
+        return {};
+    }
+
+    auto reader = std::unique_ptr<TrajectoryReader>(new TrajectoryReader(std::move(in), header));
+    reader->m_scenes.resize(header.num_scenes);
+    reader->m_chunks.resize(header.num_chunks);
+    reader->m_in.seekg(static_cast<std::streamoff>(header.index_offset));
+    if (!ReadTrajectoryRecords(reader->m_in, std::span(reader->m_scenes)) ||
+        !ReadTrajectoryRecords(reader->m_in, std::span(reader->m_chunks)))
+    {
+        return {};
+    }
+
+    // Every block lies before the index, and the chunks cover the frames in order without gaps.
+    const auto is_inside = [&](std::uint64_t offset, std::uint64_t block_size) {
+        return offset <= header.index_offset && block_size <= header.index_offset - offset;
+    };
+    for (const auto& scene : reader->m_scenes)
+    {
+        if (!is_inside(scene.offset, scene.size))
+        {
+            return {};
+        }
+    }
+    auto num_frames = std::uint64_t{0};
+    for (const auto& chunk : reader->m_chunks)
+    {
+        if (!is_inside(chunk.offset, chunk.size) ||
+            chunk.scene >= header.num_scenes ||
+            chunk.first_frame != num_frames ||
+            chunk.num_frames == 0)
+        {
+            return {};
+        }
+        num_frames += chunk.num_frames;
+    }
+    if (num_frames != header.num_frames)
+    {
+        return {};
+    }
+    return reader;
+}
+
+TrajectoryReader::TrajectoryReader(std::ifstream in, const TrajectoryFileHeader& header)
+    : m_in(std::move(in))
+    , m_header(header)
+    , m_scene(std::make_unique<World>())
+{}
+
+std::uint64_t TrajectoryReader::NumFrames() const
+{
+    return m_header.num_frames;
+}
+
+float TrajectoryReader::FixedTimeStep() const
+{
+    return m_header.fixed_time_step;
+}
+
+bool TrajectoryReader::Seek(std::uint64_t frame)
+{
+    assert(frame < NumFrames());
+    PHYSICS_TRACE_SCOPE("seek trajectory");
+
+    const auto it = std::ranges::upper_bound(m_chunks, frame, {}, &TrajectoryFileChunk::first_frame);
+    const auto chunk = static_cast<int>(it - m_chunks.begin()) - 1;
+    const auto num_required = static_cast<std::uint32_t>(frame - m_chunks[chunk].first_frame) + 1;
+
+    // Deltas only go forward, so going back restarts from the first frame of the chunk.
+    if (chunk != m_chunk_index || m_num_decoded > num_required)
+    {
+        if (!LoadChunk(chunk))
+        {
+            return false;
+        }
+    }
+    while (m_num_decoded < num_required)
+    {
+        if (!DecodeFrame())
+        {
+            m_chunk_index = -1;
+            return false;
+        }
+    }
+    m_frame = frame;
+    return true;
+}
+
+std::uint64_t TrajectoryReader::Frame() const
+{
+    return m_frame;
+}
+
+const World& TrajectoryReader::Scene() const
+{
+    return *m_scene;
+}
+
+void TrajectoryReader::FillSnapshot(WorldSnapshot& snapshot) const
+{
+    const auto& objects = m_scene->Objects();
+
+    snapshot.num_steps = m_frame;
+    snapshot.handles.clear();
+    snapshot.colliders.clear();
+    snapshot.transforms.clear();
+    snapshot.is_static.clear();
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        snapshot.handles.push_back(m_scene->Handle(*objects[i]));
+        snapshot.colliders.push_back(m_colliders[i]);
+        snapshot.transforms.push_back(objects[i]->Transform());
+        snapshot.is_static.push_back(objects[i]->IsStatic());
+    }
+
+    const auto& springs = m_scene->Springs();
+    snapshot.springs.clear();
+    for (int i = 0; i < springs.Size(); ++i)
+    {
+        snapshot.springs.push_back({
+            .start = snapshot.transforms[springs.bodies1[i]].GlobalPosition(springs.local_anchors1[i]),
+            .end = snapshot.transforms[springs.bodies2[i]].GlobalPosition(springs.local_anchors2[i])
+        });
+    }
+
+    snapshot.collisions.clear();
+    snapshot.stats = {};
+}
+
+bool TrajectoryReader::LoadScene(std::uint32_t scene)
+{
+    PHYSICS_TRACE_SCOPE("load trajectory scene");
+    const auto& entry = m_scenes[scene];
+
+    // A single allocation for the whole world file, whose elements align every record.
+    auto buffer = std::vector<std::uint64_t>((entry.size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+    m_in.seekg(static_cast<std::streamoff>(entry.offset));
+    if (!m_in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(entry.size)))
+    {
+        m_in.clear();
+        return false;
+    }
+    const auto view = WorldFileView::Open(std::as_bytes(std::span(buffer)).first(entry.size));
+    if (!view)
+    {
+        return false;
+    }
+
+    // The world is reused rather than replaced, so the new objects never get the handles of the old ones.
+    auto& objects = m_scene->Objects();
+    while (!objects.empty())
+    {
+        m_scene->RemoveObject(objects.back());
+    }
+    LoadWorld(*view, *m_scene);
+
+    m_colliders.clear();
+    for (const auto& object : m_scene->Objects())
+    {
+        m_colliders.push_back(object->Collider()->Clone());
+    }
+    m_scene_index = scene;
+    return true;
+}
+
+bool TrajectoryReader::LoadChunk(int chunk)
+{
+    m_chunk_index = -1;
+
+    const auto& entry = m_chunks[chunk];
+    if (entry.scene != m_scene_index && !LoadScene(entry.scene))
+    {
+        return false;
+    }
+
+    m_chunk_bytes.resize(entry.size);
+    m_in.seekg(static_cast<std::streamoff>(entry.offset));
+    if (!ReadTrajectoryRecords(m_in, std::span(m_chunk_bytes)))
+    {
+        m_in.clear();
+        return false;
+    }
+
+    m_chunk_index = chunk;
+    m_cursor = 0;
+    m_num_decoded = 0;
+    m_values.assign(m_scene->Objects().size() * trajectory_values_per_object, 0);
+    return true;
+}
+
+bool TrajectoryReader::DecodeFrame()
+{
+    const auto precisions = TrajectoryValuePrecisions(m_header);
+    const auto& objects = m_scene->Objects();
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        auto* values = &m_values[i * trajectory_values_per_object];
+        for (int value = 0; value < trajectory_values_per_object; ++value)
+        {
+            if (!ReadTrajectoryDelta(m_chunk_bytes, m_cursor, values[value]))
+            {
+                return false;
+            }
+        }
+
+        auto& object = *objects[i];
+        object.Transform().SetPosition({
+            DequantizeTrajectoryValue(values[0], precisions[0]),
+            DequantizeTrajectoryValue(values[1], precisions[1])
+        });
+        object.Transform().SetRotation(DequantizeTrajectoryValue(values[2], precisions[2]));
+        object.SetLinearVelocity({
+            DequantizeTrajectoryValue(values[3], precisions[3]),
+            DequantizeTrajectoryValue(values[4], precisions[4])
+        });
+        object.SetAngularVelocity({0.0f, 0.0f, DequantizeTrajectoryValue(values[5], precisions[5])});
+    }
+    ++m_num_decoded;
+    return true;
+}
+
+} // namespace physics
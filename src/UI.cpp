@@ -31,6 +31,23 @@ void UI::DrawUI()
     ImGui::Checkbox("resolve collision", &m_enable_collision);
     ImGui::Checkbox("auto update", &m_enable_update);
     m_update_one_step = m_enable_update ? false : ImGui::Button("manual update");
+    ImGui::Checkbox("simulation thread", &m_enable_simulation_thread);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Step the world on a dedicated thread instead of the render loop.");
+    }
+    ImGui::NewLine();
+
+    ImGui::SeparatorText("Solver");
+    ImGui::Checkbox("substepping", &m_enable_substepping);
+    if (m_enable_substepping)
+    {
+        ImGui::SliderInt("substeps", &m_substep_count, 1, 16);
+    }
+    else
+    {
+        ImGui::Checkbox("split impulse", &m_enable_split_impulse);
+    }
     ImGui::NewLine();
 
     ImGui::SeparatorText("Gravity");
@@ -42,7 +59,8 @@ void UI::DrawUI()
     ImGui::NewLine();
 
     ImGui::SeparatorText("Spring");
-    ImGui::SliderFloat("spring coefficient", &m_spring_coefficient, 1000.0f, 50000.0f);
+    ImGui::SliderFloat("spring frequency", &m_spring_hertz, 0.1f, 30.0f);
+    ImGui::SliderFloat("spring damping ratio", &m_spring_damping_ratio, 0.0f, 2.0f);
     ImGui::NewLine();
 
     
@@ -51,9 +69,106 @@ void UI::DrawUI()
     ImGui::SliderFloat("angular damping", &m_angular_damping, 0.0f, 0.1f);
     ImGui::NewLine();
 
+    ImGui::SeparatorText("Trajectory");
+    if (!m_enable_replay)
+    {
+        ImGui::Checkbox("record", &m_enable_recording);
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Record every step into a file, which is written on a background thread.");
+        }
+    }
+    if (!m_enable_recording)
+    {
+        ImGui::Checkbox("replay", &m_enable_replay);
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Draw the recorded steps instead of the simulation, which is paused meanwhile.");
+        }
+    }
+    m_replay_frame_changed = false;
+    if (m_enable_replay)
+    {
+        if (m_num_replay_frames > 0)
+        {
+            ImGui::Checkbox("play", &m_play_replay);
+            m_replay_frame_changed = ImGui::SliderInt("frame", &m_replay_frame, 0, m_num_replay_frames - 1);
+        }
+        else
+        {
+            ImGui::Text("Nothing recorded yet.");
+        }
+    }
+    ImGui::NewLine();
+
+    m_save_trace = false;
+    if (ImGui::CollapsingHeader("Profiler"))
+    {
+        DrawProfiler();
+    }
+
     ImGui::End();
 }
 
+void UI::DrawProfiler()
+{
+    ImGui::Checkbox("record trace", &m_enable_tracing);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Record every phase and job into a ring buffer, which can be saved as a Chrome trace.");
+    }
+    if (m_enable_tracing)
+    {
+        ImGui::SameLine();
+        m_save_trace = ImGui::Button("save trace");
+    }
+
+    const auto& allocations = m_step_stats.allocations;
+    ImGui::Text("heap allocations: %zu", allocations.heap_allocations);
+    ImGui::Text("arena bytes: %zu", allocations.arena_bytes);
+
+    if (!m_step_stats.enabled)
+    {
+        ImGui::Text("Build with PHYSICS_PROFILE to see the phases.");
+        return;
+    }
+
+    ImGui::Text("over the last %d steps, in ms", m_step_stats.num_samples);
+    if (ImGui::BeginTable("phases", 5))
+    {
+        ImGui::TableSetupColumn("phase");
+        ImGui::TableSetupColumn("last");
+        ImGui::TableSetupColumn("average");
+        ImGui::TableSetupColumn("max");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableHeadersRow();
+        for (int phase = 0; phase < num_step_phases; ++phase)
+        {
+            const auto& stats = m_step_stats.phases[phase];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", PhaseName(static_cast<StepPhase>(phase)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.last_ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.average_ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.max_ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.p99_ms);
+        }
+        ImGui::EndTable();
+    }
+
+    const auto& counters = m_step_stats.counters;
+    ImGui::Text("candidate pairs: %llu", static_cast<unsigned long long>(counters.candidate_pairs));
+    ImGui::Text("narrowphase tests: %llu", static_cast<unsigned long long>(counters.narrowphase_tests));
+    ImGui::Text("SAT axes: %llu", static_cast<unsigned long long>(counters.sat_axes));
+    ImGui::Text("contacts: %llu", static_cast<unsigned long long>(counters.contacts));
+    ImGui::Text("solver iterations: %llu", static_cast<unsigned long long>(counters.solver_iterations));
+    ImGui::Text("awake bodies: %llu", static_cast<unsigned long long>(counters.awake_bodies));
+}
+
 void UI::HandleMouseAction()
 {
     // Do nothing if no action is registered yet.
@@ -83,6 +198,17 @@ void UI::AddMouseActionType(std::shared_ptr<IMouseAction> mouse_action)
     m_mouse_actions.push_back(mouse_action);
 }
 
+void UI::SetStepStats(const StepStats& stats)
+{
+    m_step_stats = stats;
+}
+
+void UI::SetReplayFrame(int frame, int num_frames)
+{
+    m_replay_frame = frame;
+    m_num_replay_frames = num_frames;
+}
+
 bool UI::IsGravityEnabled() const
 {
     return m_enable_gravity;
@@ -93,11 +219,71 @@ bool UI::IsUpdateRequired() const
     return m_enable_update || m_update_one_step;
 }
 
+bool UI::IsSingleStepRequired() const
+{
+    return m_update_one_step;
+}
+
 bool UI::IsCollisionEnabled() const
 {
     return m_enable_collision;
 }
 
+bool UI::IsSubsteppingEnabled() const
+{
+    return m_enable_substepping;
+}
+
+int UI::SubstepCount() const
+{
+    return m_substep_count;
+}
+
+int UI::ReplayFrame() const
+{
+    return m_replay_frame;
+}
+
+bool UI::IsSplitImpulseEnabled() const
+{
+    return m_enable_split_impulse;
+}
+
+bool UI::IsSimulationThreadEnabled() const
+{
+    return m_enable_simulation_thread;
+}
+
+bool UI::IsTracingEnabled() const
+{
+    return m_enable_tracing;
+}
+
+bool UI::IsTraceSaveRequired() const
+{
+    return m_save_trace;
+}
+
+bool UI::IsRecordingEnabled() const
+{
+    return m_enable_recording;
+}
+
+bool UI::IsReplayEnabled() const
+{
+    return m_enable_replay;
+}
+
+bool UI::IsReplayPlaying() const
+{
+    return m_play_replay;
+}
+
+bool UI::IsReplayFrameChanged() const
+{
+    return m_replay_frame_changed;
+}
+
 float UI::TimeScale() const
 {
     return m_time_scale;
@@ -123,9 +309,14 @@ float UI::AngularDamping() const
     return m_angular_damping;
 }
 
-float UI::SpringCoefficient() const
+float UI::SpringFrequency() const
+{
+    return m_spring_hertz;
+}
+
+float UI::SpringDampingRatio() const
 {
-    return m_spring_coefficient;
+    return m_spring_damping_ratio;
 }
 
 Vec3 UI::MousePosition() const
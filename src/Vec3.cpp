@@ -132,8 +132,8 @@ void Vec3::Normalize()
 
 void Vec3::Rotate(Radian angle)
 {
-    const auto cos = std::cos(angle);
-    const auto sin = std::sin(angle);
+    // Rotation is everywhere, so it must not depend on the platform's math library.
+    const auto [sin, cos] = DeterministicSinCos(angle);
 
     // Warning: directly assigning new value corrupts the calculation of y!
     const auto new_x = x * cos - y * sin;
@@ -1,9 +1,94 @@
 #include "World.h"
+#include "AllocationCounter.h"
+#include "Broadphase.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <optional>
 
 namespace physics
 {
 
+/**
+ * @brief Invoke @p func(chunk_begin, chunk_end) over contiguous chunks of range [@p begin, @p end),
+ *        which are run as jobs of @p jobs.
+ *        Each chunk shows up as @p name in a trace.
+ *
+ * @note Each chunk covers at least a few thousand rows,
+ *       since processing fewer rows is cheaper than scheduling a job.
+ *       There are a few chunks per thread, so that idle threads have something to steal.
+ */
+template<typename Func>
+void ForEachChunk(JobSystem& jobs, const char* name, int begin, int end, Func&& func)
+{
+    constexpr auto min_chunk_size = 4096;
+    constexpr auto chunks_per_thread = 4;
+    const auto count = end - begin;
+    const auto num_chunks = std::clamp(count / min_chunk_size, 1, jobs.ThreadCount() * chunks_per_thread);
+    const auto chunk_size = (count + num_chunks - 1) / num_chunks;
+
+    jobs.ParallelFor(num_chunks, num_chunks, [&](int chunk) {
+        PHYSICS_TRACE_SCOPE(name);
+        const auto chunk_begin = begin + chunk * chunk_size;
+        func(chunk_begin, std::min(chunk_begin + chunk_size, end));
+    });
+}
+
+/**
+ * @brief Append @p value after the first @p size elements of @p values,
+ *        moving them into an array of @p arena twice as large when full.
+ *
+ * @note The previous array is left behind until the arena is reset.
+ */
+template<typename T>
+void AppendToArena(std::span<T>& values, std::size_t& size, const T& value, FrameArena& arena)
+{
+    if (size == values.size())
+    {
+        auto grown = arena.AllocateArray<T>(std::max<std::size_t>(16, values.size() * 2));
+        std::uninitialized_copy_n(values.begin(), size, grown.begin());
+        values = grown;
+    }
+    std::construct_at(&values[size++], value);
+}
+
+/**
+ * @brief Mix @p value into @p hash, following 64-bit FNV-1a.
+ */
+void HashValue(std::uint64_t& hash, std::uint64_t value)
+{
+    constexpr auto fnv_prime = std::uint64_t{0x100000001b3};
+    for (int i = 0; i < 8; ++i)
+    {
+        hash = (hash ^ ((value >> (i * 8)) & 0xff)) * fnv_prime;
+    }
+}
+
+void HashValue(std::uint64_t& hash, float value)
+{
+    HashValue(hash, std::uint64_t{std::bit_cast<std::uint32_t>(value)});
+}
+
+void HashValue(std::uint64_t& hash, const Vec3& value)
+{
+    HashValue(hash, value.x);
+    HashValue(hash, value.y);
+    HashValue(hash, value.z);
+}
+
+World::~World()
+{
+    // Objects might outlive this instance, so they need their state back.
+    for (const auto& obj : m_objects)
+    {
+        obj->Detach();
+    }
+}
+
 std::vector<std::shared_ptr<Rigidbody>>& World::Objects()
 {
     return m_objects;
@@ -14,16 +99,108 @@ const std::vector<std::shared_ptr<Rigidbody>>& World::Objects() const
     return m_objects;
 }
 
-const std::vector<Spring>& World::Springs() const
+const std::vector<physics::Transform>& World::RenderTransforms() const
+{
+    return m_render_transforms;
+}
+
+const SpringStorage& World::Springs() const
 {
     return m_springs;
 }
 
+const JointStorage& World::Joints() const
+{
+    return m_joints;
+}
+
 const std::vector<CollisionPair>& World::Collisions() const
 {
     return m_collisions;
 }
 
+const StepAllocationStats& World::LastStepAllocations() const
+{
+    return m_last_step_allocations;
+}
+
+StepStats World::Stats() const
+{
+    auto stats = StepStats{};
+#ifdef PHYSICS_PROFILE
+    stats.enabled = true;
+#endif
+    stats.num_samples = m_profiler.NumSamples();
+    for (int phase = 0; phase < num_step_phases; ++phase)
+    {
+        stats.phases[phase] = m_profiler.Stats(static_cast<StepPhase>(phase));
+    }
+    stats.counters = m_profiler.LastCounters();
+    stats.allocations = m_last_step_allocations;
+    return stats;
+}
+
+WorldConfig World::Config() const
+{
+    return WorldConfig{
+        .fixed_time_step = m_fixed_time_step,
+        .max_steps_per_frame = m_max_steps_per_frame,
+        .gravity = m_gravity,
+        .use_substepping = m_use_substepping,
+        .resolve_collisions = m_resolve_collisions,
+        .penetration_allowance = m_penetration_allowance,
+        .correction_ratio = m_correction_ratio,
+        .correction_mode = m_correction_mode,
+        .correction_iterations = m_correction_iterations,
+        .deterministic = m_deterministic,
+        .linear_damping = m_linear_damping,
+        .angular_damping = m_angular_damping,
+        .max_linear_speed = m_max_linear_speed,
+        .max_angular_speed = m_max_angular_speed,
+        .num_substeps = m_num_substeps,
+        .contact_hertz = m_contact_hertz,
+        .contact_damping_ratio = m_contact_damping_ratio,
+        .max_push_velocity = m_max_push_velocity,
+        .joint_hertz = m_joint_hertz,
+        .joint_damping_ratio = m_joint_damping_ratio,
+        .joint_iterations = m_joint_iterations
+    };
+}
+
+void World::Configure(const WorldConfig& config)
+{
+    ConfigureFixedTimeStep(config.fixed_time_step, config.max_steps_per_frame);
+    ConfigureGravity(config.gravity);
+    ConfigurePipeline(config.use_substepping, config.resolve_collisions);
+    ConfigurePositionalCorrection(config.penetration_allowance, config.correction_ratio);
+    ConfigurePositionalCorrectionMode(config.correction_mode, config.correction_iterations);
+    ConfigureDeterminism(config.deterministic);
+    ConfigureDamping(config.linear_damping, config.angular_damping);
+    ConfigureMaxVelocity(config.max_linear_speed, config.max_angular_speed);
+    ConfigureSubstepping(config.num_substeps, config.contact_hertz, config.contact_damping_ratio, config.max_push_velocity);
+    ConfigureJoints(config.joint_hertz, config.joint_damping_ratio, config.joint_iterations);
+}
+
+void World::ConfigureFixedTimeStep(float fixed_time_step, int max_steps_per_frame)
+{
+    assert(fixed_time_step > 0.0f);
+    assert(max_steps_per_frame > 0);
+
+    m_fixed_time_step = fixed_time_step;
+    m_max_steps_per_frame = max_steps_per_frame;
+}
+
+void World::ConfigureGravity(const Vec3& gravity)
+{
+    m_gravity = gravity;
+}
+
+void World::ConfigurePipeline(bool use_substepping, bool resolve_collisions)
+{
+    m_use_substepping = use_substepping;
+    m_resolve_collisions = resolve_collisions;
+}
+
 void World::ConfigurePositionalCorrection(float penetration_allowance, float correction_ratio)
 {
     assert(penetration_allowance >= 0.0f);
@@ -33,6 +210,45 @@ void World::ConfigurePositionalCorrection(float penetration_allowance, float cor
     m_correction_ratio = correction_ratio;
 }
 
+void World::ConfigurePositionalCorrectionMode(PositionalCorrectionMode mode, int num_iterations)
+{
+    assert(num_iterations > 0);
+
+    m_correction_mode = mode;
+    m_correction_iterations = num_iterations;
+}
+
+void World::ConfigureJoints(float joint_hertz, float joint_damping_ratio, int num_iterations)
+{
+    assert(joint_hertz >= 0.0f);
+    assert(joint_damping_ratio >= 0.0f);
+    assert(num_iterations > 0);
+
+    m_joint_hertz = joint_hertz;
+    m_joint_damping_ratio = joint_damping_ratio;
+    m_joint_iterations = num_iterations;
+}
+
+void World::ConfigureThreadCount(int num_threads)
+{
+    assert(num_threads > 0);
+
+    ConfigureJobSystem(std::make_shared<JobSystem>(num_threads));
+}
+
+void World::ConfigureJobSystem(std::shared_ptr<JobSystem> jobs)
+{
+    assert(jobs);
+
+    m_jobs = std::move(jobs);
+    m_thread_arenas = std::vector<FrameArena>(m_jobs->ThreadCount());
+}
+
+void World::ConfigureDeterminism(bool deterministic)
+{
+    m_deterministic = deterministic;
+}
+
 void World::ConfigureDamping(float linear_damping, float angular_damping)
 {
     assert(linear_damping >= 0.0f && linear_damping < 1.0f);
@@ -42,33 +258,191 @@ void World::ConfigureDamping(float linear_damping, float angular_damping)
     m_angular_damping = angular_damping;
 }
 
-void World::AddObject(std::shared_ptr<Rigidbody> object)
+void World::ConfigureMaxVelocity(float max_linear_speed, float max_angular_speed)
+{
+    assert(max_linear_speed > 0.0f);
+    assert(max_angular_speed > 0.0f);
+
+    m_max_linear_speed = max_linear_speed;
+    m_max_angular_speed = max_angular_speed;
+}
+
+void World::ConfigureSubstepping(int num_substeps, float contact_hertz, float contact_damping_ratio, float max_push_velocity)
+{
+    assert(num_substeps > 0);
+    assert(contact_hertz >= 0.0f);
+    assert(contact_damping_ratio >= 0.0f);
+    assert(max_push_velocity >= 0.0f);
+
+    m_num_substeps = num_substeps;
+    m_contact_hertz = contact_hertz;
+    m_contact_damping_ratio = contact_damping_ratio;
+    m_max_push_velocity = max_push_velocity;
+}
+
+void World::ConfigureStepCallback(std::function<void(const World&)> callback)
+{
+    m_step_callback = std::move(callback);
+}
+
+BodyHandle World::AddObject(std::shared_ptr<Rigidbody> object)
 {
+    return AddObject(std::move(object), m_num_added_objects);
+}
+
+BodyHandle World::AddObject(std::shared_ptr<Rigidbody> object, std::uint64_t id)
+{
+    // The object is appended to every list, so the indices stay in sync.
+    object->MoveToStorage(m_bodies);
     m_objects.push_back(object);
+    m_body_ids.push_back(id);
+    m_previous_transforms.push_back(object->Transform());
+    m_render_transforms.push_back(object->Transform());
+
+    // Ids handed out later must not collide with explicit ones, e.g., of a loaded world.
+    m_num_added_objects = std::max(m_num_added_objects, id + 1);
+    return m_slots.Insert();
+}
+
+void World::ReserveObjects(int num_objects)
+{
+    m_objects.reserve(num_objects);
+    m_bodies.Reserve(num_objects);
+    m_slots.Reserve(num_objects);
+    m_body_ids.reserve(num_objects);
+    m_previous_transforms.reserve(num_objects);
+    m_render_transforms.reserve(num_objects);
 }
 
 void World::RemoveObject(const std::shared_ptr<Rigidbody>& object)
 {
-    m_objects.erase(std::find(m_objects.begin(), m_objects.end(), object));
+    RemoveObject(Handle(*object));
+}
+
+bool World::RemoveObject(BodyHandle handle)
+{
+    const auto index = m_slots.DenseIndex(handle);
+    if (index < 0)
+    {
+        return false;
+    }
+
+    // Keep the object alive until everything refering to it is gone.
+    const auto object = m_objects[index];
+    m_joints.RemoveJointsOnBody(index);
+    RemoveSpringOnObject(object.get());
+
+    // BodyStorage fills the hole with its last row,
+    // so the other lists must do the same to stay in sync.
+    object->Detach();
+    if (index != m_bodies.Size())
+    {
+        m_springs.MoveBody(m_bodies.Size(), index);
+        m_joints.MoveBody(m_bodies.Size(), index);
+    }
+    m_objects[index] = m_objects.back();
+    m_objects.pop_back();
+    m_body_ids[index] = m_body_ids.back();
+    m_body_ids.pop_back();
+    m_previous_transforms[index] = m_previous_transforms.back();
+    m_previous_transforms.pop_back();
+    m_render_transforms[index] = m_render_transforms.back();
+    m_render_transforms.pop_back();
+    m_slots.Erase(handle);
+    return true;
+}
+
+Rigidbody* World::Object(BodyHandle handle)
+{
+    const auto index = m_slots.DenseIndex(handle);
+    return index >= 0 ? m_objects[index].get() : nullptr;
+}
+
+const Rigidbody* World::Object(BodyHandle handle) const
+{
+    const auto index = m_slots.DenseIndex(handle);
+    return index >= 0 ? m_objects[index].get() : nullptr;
+}
+
+BodyHandle World::Handle(const Rigidbody& object) const
+{
+    const auto index = object.BodyIndex();
+    assert(index < m_objects.size() && m_objects[index].get() == &object);
+
+    return m_slots.Handle(index);
+}
+
+std::uint64_t World::BodyId(const Rigidbody& object) const
+{
+    // Note: Handle() asserts that the object belongs to this instance.
+    assert(Handle(object) != BodyHandle{});
+
+    return m_body_ids[object.BodyIndex()];
+}
+
+std::optional<AnchorPoint> World::MakeAnchorPoint(BodyHandle handle, const Vec3& local_pos)
+{
+    if (auto* object = Object(handle))
+    {
+        return AnchorPoint{
+            .object = object,
+            .local_pos = local_pos
+        };
+    }
+
+    return {};
 }
 
 void World::AddSpring(const Spring& spring)
 {
-    m_springs.push_back(spring);
+    // Springs refer to the objects by their index in m_bodies.
+    // Note: Handle() asserts that the object belongs to this instance.
+    assert(Handle(*spring.start.object) != Handle(*spring.end.object));
+
+    m_springs.Add(spring);
 }
 
-void World::RemoveSpringOnObject(const std::shared_ptr<Rigidbody>& object)
+void World::RemoveSpringOnObject(const Rigidbody* object)
 {
-    // Returns true for a spring connected to the specified object.
-    const auto pred = [&object](const auto& spring){
-        return spring.start.object == object || spring.end.object == object;
-    };
+    // Note: Handle() asserts that the object belongs to this instance.
+    assert(Handle(*object) != BodyHandle{});
 
-    // Note: erase-remove idiom!
-    m_springs.erase(
-        std::remove_if(m_springs.begin(), m_springs.end(), pred),
-        m_springs.end()
-    );
+    m_springs.RemoveSpringsOnBody(object->BodyIndex());
+}
+
+JointId World::AddJoint(const DistanceJoint& joint)
+{
+    return m_joints.Add(joint);
+}
+
+JointId World::AddJoint(const RevoluteJoint& joint)
+{
+    return m_joints.Add(joint);
+}
+
+JointId World::AddJoint(const WeldJoint& joint)
+{
+    return m_joints.Add(joint);
+}
+
+JointId World::AddJoint(const PrismaticJoint& joint)
+{
+    return m_joints.Add(joint);
+}
+
+JointId World::AddJoint(const MouseJoint& joint)
+{
+    return m_joints.Add(joint);
+}
+
+void World::RemoveJoint(JointId id)
+{
+    m_joints.Remove(id);
+}
+
+MouseJoint* World::FindMouseJoint(JointId id)
+{
+    return m_joints.Find<MouseJoint>(id);
 }
 
 std::shared_ptr<Rigidbody> World::PickObject(const Vec3& pos)
@@ -83,24 +457,227 @@ std::shared_ptr<Rigidbody> World::PickObject(const Vec3& pos)
     return {};
 }
 
+BodyHandle World::PickHandle(const Vec3& pos) const
+{
+    for (int i = 0; i < m_objects.size(); ++i)
+    {
+        if (m_objects[i]->IsPointInside(pos))
+        {
+            return m_slots.Handle(i);
+        }
+    }
+    return {};
+}
+
+int World::Step(float frame_time)
+{
+    const auto heap_allocations_before = HeapAllocationCount();
+    m_time_accumulator += frame_time;
+
+    auto num_steps = 0;
+    while (m_time_accumulator >= m_fixed_time_step && num_steps < m_max_steps_per_frame)
+    {
+        FixedStep();
+        m_time_accumulator -= m_fixed_time_step;
+        ++num_steps;
+    }
+
+    // We couldn't keep up with the elapsed time.
+    // Carrying the debt over would only make the next frame even slower,
+    // so the simulation just runs slower than real time instead.
+    if (m_time_accumulator >= m_fixed_time_step)
+    {
+        m_time_accumulator = std::fmod(m_time_accumulator, m_fixed_time_step);
+    }
+
+    InterpolateRenderTransforms(m_time_accumulator / m_fixed_time_step);
+
+    m_last_step_allocations.heap_allocations = HeapAllocationCount() - heap_allocations_before;
+    m_last_step_allocations.arena_bytes = m_frame_arena.BytesUsed();
+    for (const auto& arena : m_thread_arenas)
+    {
+        m_last_step_allocations.arena_bytes += arena.BytesUsed();
+    }
+    return num_steps;
+}
+
+float World::FixedTimeStep() const
+{
+    return m_fixed_time_step;
+}
+
+std::uint64_t World::StateHash() const
+{
+    auto order = std::vector<int>(m_objects.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return m_body_ids[a] < m_body_ids[b];
+    });
+
+    auto hash = std::uint64_t{0xcbf29ce484222325};
+    for (const auto index : order)
+    {
+        HashValue(hash, m_body_ids[index]);
+        HashValue(hash, m_bodies.transforms[index].Position());
+        HashValue(hash, m_bodies.transforms[index].Rotation());
+        HashValue(hash, m_bodies.linear_velocities[index]);
+        HashValue(hash, m_bodies.angular_velocities[index]);
+    }
+    return hash;
+}
+
+void World::ClearHistory()
+{
+    std::ranges::fill(m_springs.impulses, 0.0f);
+    m_joints.ClearImpulses();
+    m_time_accumulator = 0.0f;
+    m_previous_transforms = m_bodies.transforms;
+    m_render_transforms = m_bodies.transforms;
+}
+
+void World::FixedStep()
+{
+    {
+        PHYSICS_PROFILE_SCOPE(m_profiler, StepPhase::FixedStep);
+
+        m_previous_transforms = m_bodies.transforms;
+
+        CheckCollisions();
+
+        if (!m_use_substepping && m_resolve_collisions)
+        {
+            ResolveCollisions(m_fixed_time_step);
+        }
+
+        if (m_use_substepping)
+        {
+            UpdateSubstepped(m_fixed_time_step, m_resolve_collisions);
+        }
+        else
+        {
+            Update(m_fixed_time_step);
+        }
+    }
+
+    PHYSICS_PROFILE_ONLY(m_profiler.Counters().awake_bodies = m_bodies.Size() - m_num_static_bodies);
+    PHYSICS_PROFILE_ONLY(m_profiler.EndStep());
+
+    if (m_step_callback)
+    {
+        m_step_callback(*this);
+    }
+}
+
+void World::InterpolateRenderTransforms(float alpha)
+{
+    for (int i = 0; i < m_objects.size(); ++i)
+    {
+        const auto& previous = m_previous_transforms[i];
+        const auto& current = m_bodies.transforms[i];
+
+        auto& render_transform = m_render_transforms[i];
+        render_transform.SetPosition(previous.Position() + (current.Position() - previous.Position()) * alpha);
+        render_transform.SetRotation(previous.Rotation() + (current.Rotation() - previous.Rotation()) * alpha);
+    }
+}
+
 void World::CheckCollisions()
 {
+    PHYSICS_TRACE_SCOPE("check collisions");
+    PHYSICS_PROFILE_ONLY(auto broadphase_timer = std::optional<ScopedPhaseTimer>(std::in_place, m_profiler, StepPhase::Broadphase));
+
     // Clear previous collision records.
+    // Everything in the frame arena belongs to the previous time step as well.
     m_collisions.clear();
+    m_frame_arena.Reset();
+    for (auto& arena : m_thread_arenas)
+    {
+        arena.Reset();
+    }
+    m_contact_constraints = {};
+
+    // Candidate pairs refer to the objects by index,
+    // so ordering the objects by id also orders pairs, collisions and contacts.
+    if (m_deterministic)
+    {
+        SortBodiesById();
+    }
+
+    // Colliders keep their own copy of the transform.
+    for (const auto& obj : m_objects)
+    {
+        obj->SyncColliderTransform();
+    }
 
-    // Iterate over all possible pairs.
-    const auto num_obj = m_objects.size();
-    for (int i = 0; i < num_obj; ++i)
+    // Skip the pairs which are obviously too far from each other.
+    auto radii = m_frame_arena.AllocateArray<float>(m_objects.size());
+    for (int i = 0; i < m_objects.size(); ++i)
     {
-        for (int j = i + 1; j < num_obj; ++j)
+        radii[i] = m_objects[i]->Collider()->BoundaryRadius();
+    }
+    const auto pairs = FindCandidatePairs(m_bodies.transforms, radii, m_frame_arena);
+    PHYSICS_PROFILE_ONLY(m_profiler.Counters().candidate_pairs += pairs.size());
+    PHYSICS_PROFILE_ONLY(broadphase_timer.reset());
+    PHYSICS_PROFILE_SCOPE(m_profiler, StepPhase::Narrowphase);
+
+    // Each job tests a contiguous range of pairs,
+    // and records the collisions in the arena of the thread it runs on.
+    // Every thread outside the pool has thread index 0, and several of them may help with this loop
+    // while waiting for their own jobs, so they take turns with the arena of index 0.
+    const auto num_pairs = static_cast<int>(pairs.size());
+    const auto num_chunks = std::clamp(m_jobs->ThreadCount() * 4, 1, std::max(num_pairs, 1));
+    const auto chunk_size = (num_pairs + num_chunks - 1) / num_chunks;
+    auto chunk_collisions = m_frame_arena.AllocateArray<std::span<CollisionPair>>(num_chunks);
+    PHYSICS_PROFILE_ONLY(auto chunk_counters = m_frame_arena.AllocateArray<NarrowphaseCounters>(num_chunks));
+    m_jobs->ParallelFor(num_chunks, num_chunks, [&](int chunk) {
+        PHYSICS_TRACE_SCOPE("narrowphase chunk");
+        const auto thread_index = m_jobs->ThreadIndex();
+        auto& arena = m_thread_arenas[thread_index];
+        auto outside_lock = thread_index == 0 ? std::unique_lock(m_outside_arena_mutex) : std::unique_lock<std::mutex>();
+        PHYSICS_PROFILE_ONLY(const auto counters_before = LocalNarrowphaseCounters());
+        auto collisions = std::span<CollisionPair>{};
+        auto num_collisions = std::size_t{0};
+
+        const auto begin = std::min(chunk * chunk_size, num_pairs);
+        const auto end = std::min(begin + chunk_size, num_pairs);
+        for (int i = begin; i < end; ++i)
         {
             // Record every collision occurrance.
-            if (auto collision = m_objects[i]->CheckCollision(*m_objects[j]))
+            if (auto collision = m_objects[pairs[i].first]->CheckCollision(*m_objects[pairs[i].second]))
             {
-                m_collisions.push_back(collision.value());
+                AppendToArena(collisions, num_collisions, collision.value(), arena);
             }
         }
+        std::construct_at(&chunk_collisions[chunk], collisions.first(num_collisions));
+
+        // The thread's counters also include other chunks it ran, so only the difference belongs to this chunk.
+        PHYSICS_PROFILE_ONLY(const auto& counters_after = LocalNarrowphaseCounters());
+        PHYSICS_PROFILE_ONLY(std::construct_at(&chunk_counters[chunk], NarrowphaseCounters{
+            .narrowphase_tests = counters_after.narrowphase_tests - counters_before.narrowphase_tests,
+            .sat_axes = counters_after.sat_axes - counters_before.sat_axes
+        }));
+    });
+
+    // Pairs are sorted by their key, and so are the chunks.
+    // Concatenating the chunks in order gives the same list as a single thread,
+    // regardless of the number of threads and which thread ran each chunk.
+    for (const auto& collisions : chunk_collisions)
+    {
+        m_collisions.insert(m_collisions.end(), collisions.begin(), collisions.end());
     }
+
+#ifdef PHYSICS_PROFILE
+    auto& counters = m_profiler.Counters();
+    for (const auto& chunk : chunk_counters)
+    {
+        counters.narrowphase_tests += chunk.narrowphase_tests;
+        counters.sat_axes += chunk.sat_axes;
+    }
+    for (const auto& collision : m_collisions)
+    {
+        counters.contacts += collision.info.contacts.size();
+    }
+#endif
 }
 
 Vec3 RelativeImpactVelocity(const Rigidbody* object1, const Rigidbody* object2, const Vec3& rel_impact_pos1, const Vec3& rel_impact_pos2)
@@ -138,8 +715,59 @@ float CalculateCollisionImpulseMagnitude(const Rigidbody* object1, const Rigidbo
     return -(1 + restitution) * velocity_along_normal / denominator;
 }
 
+/**
+ * @brief Find the normal impulse magnitude of both contact points at once,
+ *        so that the relative impact velocity of each point follows
+ *        the Newton's law of restitution after the collision.
+ * 
+ * @return Impulse magnitude for each contact point.
+ *         Empty if the collision doesn't have exactly two contact points,
+ *         or the points are too close to be solved together.
+ * 
+ * @see ContactBlockMatrix
+ */
+std::optional<std::array<float, 2>> CalculateBlockImpulseMagnitudes(const CollisionPair& collision, float restitution)
+{
+    const auto& contacts = collision.info.contacts;
+    if (contacts.size() != 2)
+    {
+        return {};
+    }
+
+    const auto* object1 = collision.object1;
+    const auto* object2 = collision.object2;
+    const auto rel_impact_pos1 = std::array{
+        contacts[0] - object1->Transform().Position(),
+        contacts[1] - object1->Transform().Position()
+    };
+    const auto rel_impact_pos2 = std::array{
+        contacts[0] - object2->Transform().Position(),
+        contacts[1] - object2->Transform().Position()
+    };
+
+    const auto matrix = ContactBlockMatrix(object1, object2, rel_impact_pos1, rel_impact_pos2, collision.info.normal);
+    if (!matrix.IsWellConditioned())
+    {
+        return {};
+    }
+
+    // We want "velocity after = -restitution * velocity before" on both points,
+    // where "velocity after = velocity before + K * impulse".
+    const auto& normal = collision.info.normal;
+    const auto velocity_along_normal1 = RelativeImpactVelocity(object1, object2, rel_impact_pos1[0], rel_impact_pos2[0]).Dot(normal);
+    const auto velocity_along_normal2 = RelativeImpactVelocity(object1, object2, rel_impact_pos1[1], rel_impact_pos2[1]).Dot(normal);
+
+    return matrix.Solve(
+        (1 + restitution) * velocity_along_normal1,
+        (1 + restitution) * velocity_along_normal2
+    );
+}
+
 void World::ResolveCollisions(float delta_time)
 {
+    PHYSICS_PROFILE_SCOPE(m_profiler, StepPhase::ResolveCollisions);
+    PHYSICS_PROFILE_ONLY(m_profiler.Counters().solver_iterations += 1);
+
     for (const auto& collision : m_collisions)
     {
         // Shorthand notation for objects in contact.
@@ -149,14 +777,37 @@ void World::ResolveCollisions(float delta_time)
         // Choose the physical constants like friction coefficient.
         const auto coef = object1->Material().Average(object2->Material());
 
-        for (const auto& contact : collision.info.contacts)
+        // Two contact points of the same collision are coupled:
+        // an impulse on one point also changes the velocity of the other one.
+        // Solve them together if possible, instead of treating them independently.
+        const auto block_impulse_magnitudes = CalculateBlockImpulseMagnitudes(collision, coef.restitution);
+
+        const auto num_contacts = collision.info.contacts.size();
+        for (int i = 0; i < num_contacts; ++i)
         {
+            const auto& contact = collision.info.contacts[i];
+
             // Local coordinates of the position where
             // the collision impulse will be applied to.
             const auto rel_impact_pos1 = contact - object1->Transform().Position();
             const auto rel_impact_pos2 = contact - object2->Transform().Position();
 
-            const auto normal_impulse_magnitude = CalculateCollisionImpulseMagnitude(object1, object2, rel_impact_pos1, rel_impact_pos2, collision.info.normal, coef.restitution);
+            // Reason for dividing impulse for this contact point by contact size:
+            //   We might have multiple impact points per collision!
+            //   To approximate total energy conservation,
+            //   the average impulse of all local impulse per impact point must be used.
+            //
+            // - example scenario -
+            // Suppose two parallel squares are colliding horizontally.
+            // If one square is smaller, we will have two contact points on an overlapping edge.
+            // This means we apply impulse on two corners!
+            // Since each impulse magnitude j is calculated for complete resolution,
+            // we need to divide each impulse by 2 so that the sum of them gives the right answer.
+            //
+            // The block solver, on the other hand, already gives the share of each point.
+            const auto normal_impulse_magnitude = block_impulse_magnitudes
+                ? block_impulse_magnitudes->at(i)
+                : CalculateCollisionImpulseMagnitude(object1, object2, rel_impact_pos1, rel_impact_pos2, collision.info.normal, coef.restitution) / num_contacts;
             const auto normal_impulse = collision.info.normal * normal_impulse_magnitude;
 
             // Leave the objects if they already moving away.
@@ -202,7 +853,7 @@ void World::ResolveCollisions(float delta_time)
             // How can we calculate the right amount of force?
             // Well, use the same formula as the regular collision impact!
             // Replacing collision normal to collision tangent, and coefficient of restitution to 0 will work.
-            auto tangential_impulse_magnitude = CalculateCollisionImpulseMagnitude(object1, object2, rel_impact_pos1, rel_impact_pos2, friction_direction, 0.0f);
+            auto tangential_impulse_magnitude = CalculateCollisionImpulseMagnitude(object1, object2, rel_impact_pos1, rel_impact_pos2, friction_direction, 0.0f) / num_contacts;
 
             // If the force required to make tangential contact velocity
             // is greater than the maximum static friction force,
@@ -213,19 +864,7 @@ void World::ResolveCollisions(float delta_time)
                 tangential_impulse_magnitude = normal_impulse_magnitude * coef.dynamic_friction;
             }
             const auto tangential_impulse = friction_direction * tangential_impulse_magnitude;
-
-            // Reason for dividing impulse for this contact point by contact size:
-            //   We might have multiple impact points per collision!
-            //   To approximate total energy conservation,
-            //   the average impulse of all local impulse per impact point must be used.
-            //
-            // - example scenario -
-            // Suppose two parallel squares are colliding horizontally.
-            // If one square is smaller, we will have two contact points on an overlapping edge.
-            // This means we apply impulse on two corners!
-            // Since each impulse magnitude j is calculated for complete resolution,
-            // we need to divide each impulse by 2 so that the sum of them gives the right answer.
-            const auto total_impulse = (normal_impulse + tangential_impulse) / collision.info.contacts.size();
+            const auto total_impulse = normal_impulse + tangential_impulse;
 
             // Due to the law of action and reaction,
             // the magnitude of impulse is same but the direction is opposite.
@@ -234,7 +873,8 @@ void World::ResolveCollisions(float delta_time)
         }
 
         // Perform positional correction.
-        if (collision.info.penetration_depth > m_penetration_allowance)
+        if (m_correction_mode == PositionalCorrectionMode::Direct
+            && collision.info.penetration_depth > m_penetration_allowance)
         {
             const auto required_translation =
                 // The direction where we need separation.
@@ -253,21 +893,276 @@ void World::ResolveCollisions(float delta_time)
             object2->Transform().AddPosition(required_translation * (1.0f - inv_mass_ratio));
         }
     }
+
+    if (m_correction_mode == PositionalCorrectionMode::SplitImpulse)
+    {
+        SolvePseudoVelocities(delta_time);
+        PHYSICS_PROFILE_ONLY(m_profiler.Counters().solver_iterations += m_correction_iterations);
+    }
+}
+
+void World::BuildContactConstraints()
+{
+    m_contact_constraints = m_frame_arena.AllocateArray<ContactConstraint>(m_collisions.size());
+    for (int i = 0; i < m_collisions.size(); ++i)
+    {
+        std::construct_at(&m_contact_constraints[i], m_collisions[i]);
+    }
+}
+
+void World::SolvePseudoVelocities(float delta_time)
+{
+    BuildContactConstraints();
+
+    // Constraints in the same batch never write to the same object,
+    // so each batch can be distributed over multiple threads.
+    // Batches themselves are processed in order, just like a Gauss-Seidel iteration.
+    const auto batches = PartitionIntoBatches(m_contact_constraints, m_bodies.Size(), m_frame_arena);
+    const auto inv_time_step = 1.0f / delta_time;
+    for (int i = 0; i < m_correction_iterations; ++i)
+    {
+        for (int b = 0; b < batches.Count(); ++b)
+        {
+            PHYSICS_TRACE_SCOPE("split impulse batch");
+            const auto batch = batches.Batch(b);
+            m_jobs->ParallelFor(batch.size(), m_jobs->ThreadCount(), [&](int j) {
+                m_contact_constraints[batch[j]].SolvePseudoVelocity(inv_time_step, m_penetration_allowance, m_correction_ratio);
+            });
+        }
+    }
 }
 
 void World::Update(float delta_time)
 {
-    for (auto& spring : m_springs)
+    PHYSICS_PROFILE_SCOPE(m_profiler, StepPhase::Update);
+    PHYSICS_PROFILE_ONLY(m_profiler.Counters().solver_iterations += m_joint_iterations);
+
+    PartitionStaticBodies();
+
+    // Springs and joints correct the velocity right before it is used to move the objects.
+    // The accelerations are added afterwards, and will be corrected on the next Update().
+    const auto context = MakeJointSolverContext(delta_time);
+    PrepareSprings();
+    WarmStartJoints();
+    for (int i = 0; i < m_joint_iterations; ++i)
     {
-        spring.ApplyImpulse(delta_time);
+        SolveJoints(context, true);
     }
 
-    for (const auto& obj : m_objects)
+    // Streams through the dynamic rows at once.
+    const auto params = MakeIntegrationParameters();
+    ForEachChunk(*m_jobs, "integrate", m_num_static_bodies, m_bodies.Size(), [&](int begin, int end) {
+        m_bodies.Integrate(begin, end, params, delta_time);
+    });
+}
+
+void World::WarmStartJoints()
+{
+    m_springs.WarmStart(m_bodies);
+    m_joints.WarmStart();
+}
+
+void World::SolveJoints(const JointSolverContext& context, bool use_bias)
+{
+    // Springs are physical forces rather than error correction,
+    // so they are solved regardless of use_bias.
+    m_springs.Solve(m_bodies, context.time_step);
+    m_joints.Solve(context, use_bias);
+}
+
+void World::PrepareSprings()
+{
+    // Springs don't depend on each other until they are solved.
+    ForEachChunk(*m_jobs, "prepare springs", 0, m_springs.Size(), [&](int begin, int end) {
+        m_springs.Prepare(m_bodies, begin, end);
+    });
+}
+
+JointSolverContext World::MakeJointSolverContext(float time_step) const
+{
+    // Same as contacts, a stiffer spring cannot be simulated with such time step.
+    const auto inv_time_step = 1.0f / time_step;
+    const auto joint_hertz = std::min(m_joint_hertz, 0.25f * inv_time_step);
+
+    return JointSolverContext{
+        .time_step = time_step,
+        .inv_time_step = inv_time_step,
+        .softness = MakeSoftness(joint_hertz, m_joint_damping_ratio, time_step)
+    };
+}
+
+IntegrationParameters World::MakeIntegrationParameters() const
+{
+    return IntegrationParameters{
+        .gravity = m_gravity,
+        .linear_damping = m_linear_damping,
+        .angular_damping = m_angular_damping,
+        .max_linear_speed = m_max_linear_speed,
+        .max_angular_speed = m_max_angular_speed
+    };
+}
+
+void World::PartitionStaticBodies()
+{
+    // Static rows go to the front and dynamic rows to the back,
+    // swapping only the rows found on the wrong side.
+    auto first = 0;
+    auto last = m_bodies.Size() - 1;
+    while (true)
     {
-        obj->Update(delta_time);
-        obj->ApplyDamping(m_linear_damping, m_angular_damping);
+        while (first <= last && m_bodies.IsStaticRow(first))
+        {
+            ++first;
+        }
+        while (first <= last && !m_bodies.IsStaticRow(last))
+        {
+            --last;
+        }
+        if (first >= last)
+        {
+            break;
+        }
+        SwapBodies(first, last);
     }
+
+    m_num_static_bodies = first;
 }
 
+void World::SwapBodies(int first, int second)
+{
+    m_objects[first]->SwapStorageRow(*m_objects[second]);
+    std::swap(m_objects[first], m_objects[second]);
+    std::swap(m_body_ids[first], m_body_ids[second]);
+    std::swap(m_previous_transforms[first], m_previous_transforms[second]);
+    std::swap(m_render_transforms[first], m_render_transforms[second]);
+    m_slots.Swap(first, second);
+    m_springs.SwapBodies(first, second);
+    m_joints.SwapBodies(first, second);
+}
+
+void World::SortBodiesById()
+{
+    const auto is_before = [this](int a, int b) {
+        // Static rows go first.
+        const auto is_static_a = m_bodies.IsStaticRow(a);
+        const auto is_static_b = m_bodies.IsStaticRow(b);
+        if (is_static_a != is_static_b)
+        {
+            return is_static_a;
+        }
+        return m_body_ids[a] < m_body_ids[b];
+    };
+
+    const auto num_bodies = m_bodies.Size();
+    auto is_sorted = true;
+    for (int i = 1; i < num_bodies && is_sorted; ++i)
+    {
+        is_sorted = !is_before(i, i - 1);
+    }
+    if (!is_sorted)
+    {
+        // order[i] is the row which goes to row i.
+        auto order = m_frame_arena.AllocateArray<int>(num_bodies);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), is_before);
+
+        // Every swap puts one row in place, while tracking where the others went.
+        auto current_row = m_frame_arena.AllocateArray<int>(num_bodies);
+        auto original_row = m_frame_arena.AllocateArray<int>(num_bodies);
+        std::iota(current_row.begin(), current_row.end(), 0);
+        std::iota(original_row.begin(), original_row.end(), 0);
+        for (int i = 0; i < num_bodies; ++i)
+        {
+            const auto row = current_row[order[i]];
+            if (row == i)
+            {
+                continue;
+            }
+
+            SwapBodies(i, row);
+            current_row[original_row[i]] = row;
+            original_row[row] = original_row[i];
+            current_row[order[i]] = i;
+            original_row[i] = order[i];
+        }
+    }
+
+    // Ids are unique, so the order is the same no matter where the objects started.
+    // Checked even if nothing moved, since an already sorted list may hold the same id twice.
+    assert(std::adjacent_find(m_body_ids.begin(), m_body_ids.end()) == m_body_ids.end());
+}
+
+void World::UpdateSubstepped(float delta_time, bool resolve_collisions)
+{
+    PHYSICS_PROFILE_SCOPE(m_profiler, StepPhase::UpdateSubstepped);
+    PHYSICS_PROFILE_ONLY(m_profiler.Counters().solver_iterations += m_num_substeps);
+
+    PartitionStaticBodies();
+
+    const auto substep = delta_time / m_num_substeps;
+    const auto inv_substep = 1.0f / substep;
+
+    // A spring stiffer than a quarter of the substep rate cannot be simulated properly.
+    const auto contact_hertz = std::min(m_contact_hertz, 0.25f * inv_substep);
+    const auto softness = MakeSoftness(contact_hertz, m_contact_damping_ratio, substep);
+    const auto joint_context = MakeJointSolverContext(substep);
+
+    // Prepare the contacts only once.
+    // From now on, we rely on the cached anchors instead of collision detection.
+    m_contact_constraints = {};
+    if (resolve_collisions)
+    {
+        BuildContactConstraints();
+    }
+
+    // Springs are prepared again whenever the positions move,
+    // which is once per substep, since integrating the velocities leaves the positions as they are.
+    PrepareSprings();
+    for (int i = 0; i < m_num_substeps; ++i)
+    {
+        // External forces were accumulated for the whole time step.
+        // They are applied on every substep along with gravity, and cleared at the end.
+        ForEachChunk(*m_jobs, "integrate velocities", m_num_static_bodies, m_bodies.Size(), [&](int begin, int end) {
+            m_bodies.IntegrateVelocities(begin, end, m_gravity, substep);
+        });
+
+        // Start from the impulses found on the previous substep,
+        // and then push overlapping objects apart.
+        // Springs and joints go first, so that contacts have the final say on the velocity.
+        WarmStartJoints();
+        for (auto& contact : m_contact_constraints)
+        {
+            contact.WarmStart();
+        }
+        SolveJoints(joint_context, true);
+        for (auto& contact : m_contact_constraints)
+        {
+            contact.Solve(softness, inv_substep, m_penetration_allowance, m_max_push_velocity, true);
+        }
+
+        ForEachChunk(*m_jobs, "integrate positions", m_num_static_bodies, m_bodies.Size(), [&](int begin, int end) {
+            m_bodies.IntegratePositions(begin, end, substep);
+        });
+        PrepareSprings();
+
+        // Remove the velocity added by the position error.
+        // Otherwise, it would remain as a kinetic energy and objects would jitter.
+        SolveJoints(joint_context, false);
+        for (auto& contact : m_contact_constraints)
+        {
+            contact.Solve(softness, inv_substep, m_penetration_allowance, m_max_push_velocity, false);
+        }
+    }
+
+    for (auto& contact : m_contact_constraints)
+    {
+        contact.ApplyRestitution(m_restitution_threshold);
+    }
+
+    const auto params = MakeIntegrationParameters();
+    ForEachChunk(*m_jobs, "finish velocities", m_num_static_bodies, m_bodies.Size(), [&](int begin, int end) {
+        m_bodies.FinishVelocities(begin, end, params);
+    });
+}
 
 } // namespace physics
@@ -0,0 +1,159 @@
+#include "WorldBatch.h"
+#include <cassert>
+
+namespace physics
+{
+
+/**
+ * @brief Add a copy of every object, spring and joint of @p source to the empty @p target.
+ * @return Handles of the copies in the order of source.Objects().
+ */
+std::vector<BodyHandle> CopyScene(const World& source, World& target)
+{
+    const auto& objects = source.Objects();
+
+    // Copies in the order of the source, to remap the references of springs and joints.
+    auto copies = std::vector<Rigidbody*>{};
+    auto handles = std::vector<BodyHandle>{};
+    for (const auto& object : objects)
+    {
+        // The inverses are copied as they are, since inverting the mass twice may round differently.
+        auto copy = std::make_shared<Rigidbody>(object->Collider()->Clone(), object->Material(), 0.0f, 0.0f);
+        copy->SetInverseMass(object->InverseMass());
+        copy->SetInverseInertia(object->InverseInertia());
+        copy->Transform() = object->Transform();
+        copy->SetLinearVelocity(object->LinearVelocity());
+        copy->SetAngularVelocity(object->AngularVelocity());
+
+        copies.push_back(copy.get());
+        handles.push_back(target.AddObject(copy, source.BodyId(*object)));
+    }
+
+    const auto& springs = source.Springs();
+    for (int i = 0; i < springs.Size(); ++i)
+    {
+        target.AddSpring(Spring{
+            .start = {copies[springs.bodies1[i]], springs.local_anchors1[i]},
+            .end = {copies[springs.bodies2[i]], springs.local_anchors2[i]},
+            .neutral_distance = springs.neutral_distances[i],
+            .hertz = springs.frequencies[i],
+            .damping_ratio = springs.damping_ratios[i]
+        });
+    }
+
+    // Mouse joints belong to the user dragging an object, so they are not copied.
+    const auto copy_joints = [&](const auto& joints) {
+        for (auto joint : joints)
+        {
+            joint.start.object = copies[joint.start.object->BodyIndex()];
+            joint.end.object = copies[joint.end.object->BodyIndex()];
+            target.AddJoint(joint);
+        }
+    };
+    const auto& joints = source.Joints();
+    copy_joints(joints.DistanceJoints());
+    copy_joints(joints.RevoluteJoints());
+    copy_joints(joints.WeldJoints());
+    copy_joints(joints.PrismaticJoints());
+
+    return handles;
+}
+
+WorldBatch::WorldBatch(const World& scene, int num_worlds, std::shared_ptr<JobSystem> jobs)
+    : m_num_worlds(num_worlds), m_worlds(std::make_unique<World[]>(num_worlds)), m_jobs(std::move(jobs))
+{
+    assert(num_worlds > 0);
+    assert(m_jobs);
+
+    for (const auto& object : scene.Objects())
+    {
+        m_initial_transforms.push_back(object->Transform());
+        m_initial_linear_velocities.push_back(object->LinearVelocity());
+        m_initial_angular_velocities.push_back(object->AngularVelocity());
+    }
+
+    for (int i = 0; i < num_worlds; ++i)
+    {
+        m_handles = CopyScene(scene, m_worlds[i]);
+    }
+
+    m_poses.resize(static_cast<std::size_t>(num_worlds) * m_handles.size());
+    for (int i = 0; i < num_worlds; ++i)
+    {
+        PublishPoses(i);
+    }
+}
+
+int WorldBatch::Size() const
+{
+    return m_num_worlds;
+}
+
+int WorldBatch::ObjectsPerWorld() const
+{
+    return static_cast<int>(m_handles.size());
+}
+
+World& WorldBatch::At(int world)
+{
+    return m_worlds[world];
+}
+
+const World& WorldBatch::At(int world) const
+{
+    return m_worlds[world];
+}
+
+void WorldBatch::Step()
+{
+    // A job per world keeps every world on a single thread from start to end,
+    // and gives idle threads plenty of worlds to steal.
+    m_jobs->ParallelFor(m_num_worlds, m_num_worlds, [&](int i) {
+        auto& world = m_worlds[i];
+        world.Step(world.FixedTimeStep());
+        PublishPoses(i);
+    });
+}
+
+void WorldBatch::Reset()
+{
+    m_jobs->ParallelFor(m_num_worlds, m_num_worlds, [&](int i) {
+        Reset(i);
+    });
+}
+
+void WorldBatch::Reset(int world)
+{
+    auto& target = m_worlds[world];
+    for (int i = 0; i < m_handles.size(); ++i)
+    {
+        auto* object = target.Object(m_handles[i]);
+        object->Transform() = m_initial_transforms[i];
+        object->SetLinearVelocity(m_initial_linear_velocities[i]);
+        object->SetAngularVelocity(m_initial_angular_velocities[i]);
+    }
+    target.ClearHistory();
+    PublishPoses(world);
+}
+
+std::span<const Transform> WorldBatch::Poses() const
+{
+    return m_poses;
+}
+
+std::span<const Transform> WorldBatch::Poses(int world) const
+{
+    return Poses().subspan(static_cast<std::size_t>(world) * m_handles.size(), m_handles.size());
+}
+
+void WorldBatch::PublishPoses(int world)
+{
+    const auto& source = m_worlds[world];
+    auto poses = std::span(m_poses).subspan(static_cast<std::size_t>(world) * m_handles.size(), m_handles.size());
+    for (int i = 0; i < m_handles.size(); ++i)
+    {
+        poses[i] = source.Object(m_handles[i])->Transform();
+    }
+}
+
+} // namespace physics
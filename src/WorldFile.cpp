@@ -0,0 +1,481 @@
+#include "WorldFile.h"
+#include "Circle.h"
+#include "ConvexPolygon.h"
+#include "PoolAllocator.h"
+#include <cassert>
+#include <fstream>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+namespace physics
+{
+
+constexpr auto world_file_magic = std::array<char, 8>{'P', 'H', 'Y', 'S', 'W', 'R', 'L', 'D'};
+constexpr std::uint32_t world_file_byte_order = 0x01020304;
+
+// Records are used in place, so they must be plain bytes with a fixed layout.
+static_assert(std::is_trivially_copyable_v<WorldFileHeader> && std::is_standard_layout_v<WorldFileHeader>);
+static_assert(std::is_trivially_copyable_v<WorldFileConfig> && std::is_standard_layout_v<WorldFileConfig>);
+static_assert(std::is_trivially_copyable_v<WorldFileBody> && std::is_standard_layout_v<WorldFileBody>);
+static_assert(std::is_trivially_copyable_v<WorldFileSpring> && std::is_standard_layout_v<WorldFileSpring>);
+static_assert(sizeof(WorldFileBody) == 64, "a body should fill a single cache line");
+static_assert(sizeof(WorldFileHeader) % world_file_alignment == 0);
+
+/**
+ * @return The size of the record stored in each section, in the order of WorldFileSection.
+ */
+constexpr std::array<std::size_t, num_world_file_sections> WorldFileRecordSizes()
+{
+    return {
+        sizeof(WorldFileConfig),
+        sizeof(WorldFileVec2),
+        sizeof(WorldFilePolygon),
+        sizeof(WorldFileBody),
+        sizeof(WorldFileSpring)
+    };
+}
+
+std::uint64_t AlignWorldFileOffset(std::uint64_t offset)
+{
+    return (offset + world_file_alignment - 1) / world_file_alignment * world_file_alignment;
+}
+
+WorldFileVec2 ToWorldFileVec2(const Vec3& v)
+{
+    return {v.x, v.y};
+}
+
+Vec3 ToVec3(const WorldFileVec2& v)
+{
+    return {v.x, v.y};
+}
+
+WorldFileConfig ToWorldFileConfig(const WorldConfig& config)
+{
+    return WorldFileConfig{
+        .fixed_time_step = config.fixed_time_step,
+        .max_steps_per_frame = config.max_steps_per_frame,
+        .gravity = ToWorldFileVec2(config.gravity),
+        .use_substepping = config.use_substepping,
+        .resolve_collisions = config.resolve_collisions,
+        .penetration_allowance = config.penetration_allowance,
+        .correction_ratio = config.correction_ratio,
+        .correction_mode = static_cast<std::uint32_t>(config.correction_mode),
+        .correction_iterations = config.correction_iterations,
+        .deterministic = config.deterministic,
+        .linear_damping = config.linear_damping,
+        .angular_damping = config.angular_damping,
+        .max_linear_speed = config.max_linear_speed,
+        .max_angular_speed = config.max_angular_speed,
+        .num_substeps = config.num_substeps,
+        .contact_hertz = config.contact_hertz,
+        .contact_damping_ratio = config.contact_damping_ratio,
+        .max_push_velocity = config.max_push_velocity,
+        .joint_hertz = config.joint_hertz,
+        .joint_damping_ratio = config.joint_damping_ratio,
+        .joint_iterations = config.joint_iterations
+    };
+}
+
+WorldConfig ToWorldConfig(const WorldFileConfig& config)
+{
+    return WorldConfig{
+        .fixed_time_step = config.fixed_time_step,
+        .max_steps_per_frame = config.max_steps_per_frame,
+        .gravity = ToVec3(config.gravity),
+        .use_substepping = config.use_substepping != 0,
+        .resolve_collisions = config.resolve_collisions != 0,
+        .penetration_allowance = config.penetration_allowance,
+        .correction_ratio = config.correction_ratio,
+        .correction_mode = static_cast<PositionalCorrectionMode>(config.correction_mode),
+        .correction_iterations = config.correction_iterations,
+        .deterministic = config.deterministic != 0,
+        .linear_damping = config.linear_damping,
+        .angular_damping = config.angular_damping,
+        .max_linear_speed = config.max_linear_speed,
+        .max_angular_speed = config.max_angular_speed,
+        .num_substeps = config.num_substeps,
+        .contact_hertz = config.contact_hertz,
+        .contact_damping_ratio = config.contact_damping_ratio,
+        .max_push_velocity = config.max_push_velocity,
+        .joint_hertz = config.joint_hertz,
+        .joint_damping_ratio = config.joint_damping_ratio,
+        .joint_iterations = config.joint_iterations
+    };
+}
+
+/**
+ * @return True if World::Configure() accepts @p config.
+ *
+ * @note Written so that NaN fails every comparison.
+ */
+bool IsValidWorldFileConfig(const WorldFileConfig& config)
+{
+    const auto is_fraction = [](float value) {
+        return value >= 0.0f && value < 1.0f;
+    };
+    return config.fixed_time_step > 0.0f
+        && config.max_steps_per_frame > 0
+        && config.penetration_allowance >= 0.0f
+        && config.correction_ratio >= 0.0f && config.correction_ratio <= 1.0f
+        && config.correction_mode <= static_cast<std::uint32_t>(PositionalCorrectionMode::SplitImpulse)
+        && config.correction_iterations > 0
+        && is_fraction(config.linear_damping)
+        && is_fraction(config.angular_damping)
+        && config.max_linear_speed > 0.0f
+        && config.max_angular_speed > 0.0f
+        && config.num_substeps > 0
+        && config.contact_hertz >= 0.0f
+        && config.contact_damping_ratio >= 0.0f
+        && config.max_push_velocity >= 0.0f
+        && config.joint_hertz >= 0.0f
+        && config.joint_damping_ratio >= 0.0f
+        && config.joint_iterations > 0;
+}
+
+WorldFileView::WorldFileView(std::span<const std::byte> data)
+    : m_data(data)
+{}
+
+std::optional<WorldFileView> WorldFileView::Open(std::span<const std::byte> data)
+{
+    if (data.size() < sizeof(WorldFileHeader) || reinterpret_cast<std::uintptr_t>(data.data()) % alignof(WorldFileHeader) != 0)
+    {
+        return {};
+    }
+
+    const auto& header = *reinterpret_cast<const WorldFileHeader*>(data.data());
+    if (header.magic != world_file_magic
+        || header.version != world_file_version
+        || header.byte_order != world_file_byte_order
+        || header.file_size != data.size())
+    {
+        return {};
+    }
+
+    const auto record_sizes = WorldFileRecordSizes();
+    for (int i = 0; i < num_world_file_sections; ++i)
+    {
+        // Divides instead of multiplying the count, which could overflow.
+        const auto& section = header.sections[i];
+        if (section.record_size != record_sizes[i]
+            || section.offset % world_file_alignment != 0
+            || section.offset > data.size()
+            || section.count > (data.size() - section.offset) / section.record_size)
+        {
+            return {};
+        }
+    }
+    if (header.sections[static_cast<int>(WorldFileSection::Config)].count != 1)
+    {
+        return {};
+    }
+
+    // From here on, the sections can be read. Check the references between them.
+    const auto view = WorldFileView(data);
+    if (!IsValidWorldFileConfig(view.Config()))
+    {
+        return {};
+    }
+
+    // PolygonGeometry throws on vertices in the wrong order,
+    // which must be found before LoadWorld() touches the world.
+    const auto num_vertices = view.Vertices().size();
+    auto vertices = std::vector<Vec3>();
+    for (const auto& polygon : view.Polygons())
+    {
+        if (polygon.num_vertices < 3 || polygon.first_vertex > num_vertices || polygon.num_vertices > num_vertices - polygon.first_vertex)
+        {
+            return {};
+        }
+
+        vertices.clear();
+        for (const auto& vertex : view.Vertices().subspan(polygon.first_vertex, polygon.num_vertices))
+        {
+            vertices.push_back(ToVec3(vertex));
+        }
+        if (!PolygonGeometry::IsCounterClockwise(vertices))
+        {
+            return {};
+        }
+    }
+
+    const auto num_polygons = view.Polygons().size();
+    for (const auto& body : view.Bodies())
+    {
+        const auto is_valid_shape = body.shape == WorldFileShape::Circle
+            ? body.radius > 0.0f
+            : body.shape == WorldFileShape::Polygon && body.polygon < num_polygons;
+        if (!is_valid_shape || !(body.inv_mass >= 0.0f) || !(body.inv_inertia >= 0.0f))
+        {
+            return {};
+        }
+    }
+
+    const auto num_bodies = view.Bodies().size();
+    for (const auto& spring : view.Springs())
+    {
+        if (spring.body1 >= num_bodies || spring.body2 >= num_bodies || spring.body1 == spring.body2)
+        {
+            return {};
+        }
+    }
+
+    return view;
+}
+
+template<typename T>
+std::span<const T> WorldFileView::Section(WorldFileSection section) const
+{
+    const auto& entry = reinterpret_cast<const WorldFileHeader*>(m_data.data())->sections[static_cast<int>(section)];
+    return {reinterpret_cast<const T*>(m_data.data() + entry.offset), static_cast<std::size_t>(entry.count)};
+}
+
+const WorldFileConfig& WorldFileView::Config() const
+{
+    return Section<WorldFileConfig>(WorldFileSection::Config).front();
+}
+
+std::span<const WorldFileVec2> WorldFileView::Vertices() const
+{
+    return Section<WorldFileVec2>(WorldFileSection::Vertices);
+}
+
+std::span<const WorldFilePolygon> WorldFileView::Polygons() const
+{
+    return Section<WorldFilePolygon>(WorldFileSection::Polygons);
+}
+
+std::span<const WorldFileBody> WorldFileView::Bodies() const
+{
+    return Section<WorldFileBody>(WorldFileSection::Bodies);
+}
+
+std::span<const WorldFileSpring> WorldFileView::Springs() const
+{
+    return Section<WorldFileSpring>(WorldFileSection::Springs);
+}
+
+/**
+ * @brief Pad the file up to @p entry, then write @p records there.
+ *
+ * @param position The number of bytes written so far, which is updated.
+ */
+template<typename T>
+void WriteWorldFileSection(std::ostream& out, std::uint64_t& position, const WorldFileSectionEntry& entry, std::span<const T> records)
+{
+    constexpr auto padding = std::array<char, world_file_alignment>{};
+    out.write(padding.data(), static_cast<std::streamsize>(entry.offset - position));
+    out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size_bytes()));
+    position = entry.offset + records.size_bytes();
+}
+
+void WriteWorldFile(const World& world, std::ostream& out)
+{
+    const auto config = ToWorldFileConfig(world.Config());
+
+    // Polygons are shared by their geometry, which ShapeCache already deduplicated,
+    // and otherwise by their vertices, for polygons created from the same list separately.
+    auto vertices = std::vector<WorldFileVec2>();
+    auto polygons = std::vector<WorldFilePolygon>();
+    auto polygon_of_geometry = std::unordered_map<const PolygonGeometry*, std::uint32_t>();
+    auto polygon_of_vertices = std::unordered_map<std::string_view, std::uint32_t>();
+
+    const auto find_polygon = [&](const PolygonGeometry& geometry) {
+        if (const auto it = polygon_of_geometry.find(&geometry); it != polygon_of_geometry.end())
+        {
+            return it->second;
+        }
+
+        const auto first_vertex = vertices.size();
+        for (const auto& vertex : geometry.Vertices())
+        {
+            vertices.push_back(ToWorldFileVec2(vertex));
+        }
+
+        // The key refers to the geometry, which every body of the world keeps alive.
+        const auto& geometry_vertices = geometry.Vertices();
+        const auto key = std::string_view(reinterpret_cast<const char*>(geometry_vertices.data()), geometry_vertices.size() * sizeof(Vec3));
+        const auto [it, is_new] = polygon_of_vertices.emplace(key, static_cast<std::uint32_t>(polygons.size()));
+        if (is_new)
+        {
+            polygons.push_back({static_cast<std::uint32_t>(first_vertex), static_cast<std::uint32_t>(geometry_vertices.size())});
+        }
+        else
+        {
+            vertices.resize(first_vertex);
+        }
+        polygon_of_geometry.emplace(&geometry, it->second);
+        return it->second;
+    };
+
+    auto bodies = std::vector<WorldFileBody>();
+    bodies.reserve(world.Objects().size());
+    for (const auto& object : world.Objects())
+    {
+        auto body = WorldFileBody{
+            .id = world.BodyId(*object),
+            .shape = WorldFileShape::Circle,
+            .polygon = 0,
+            .radius = 0.0f,
+            .position = ToWorldFileVec2(object->Transform().Position()),
+            .rotation = object->Transform().Rotation(),
+            .linear_velocity = ToWorldFileVec2(object->LinearVelocity()),
+            .angular_velocity = object->AngularVelocity().z,
+            .inv_mass = object->InverseMass(),
+            .inv_inertia = object->InverseInertia(),
+            .material = object->Material()
+        };
+        if (const auto* polygon = dynamic_cast<const ConvexPolygon*>(object->Collider()))
+        {
+            body.shape = WorldFileShape::Polygon;
+            body.polygon = find_polygon(*polygon->Geometry());
+        }
+        else
+        {
+            body.radius = object->Collider()->BoundaryRadius();
+        }
+        bodies.push_back(body);
+    }
+
+    // Springs already refer to the bodies by their index in World::Objects().
+    const auto& spring_storage = world.Springs();
+    auto springs = std::vector<WorldFileSpring>();
+    springs.reserve(spring_storage.Size());
+    for (int i = 0; i < spring_storage.Size(); ++i)
+    {
+        springs.push_back({
+            .body1 = static_cast<std::uint32_t>(spring_storage.bodies1[i]),
+            .body2 = static_cast<std::uint32_t>(spring_storage.bodies2[i]),
+            .local_anchor1 = ToWorldFileVec2(spring_storage.local_anchors1[i]),
+            .local_anchor2 = ToWorldFileVec2(spring_storage.local_anchors2[i]),
+            .neutral_distance = spring_storage.neutral_distances[i],
+            .hertz = spring_storage.frequencies[i],
+            .damping_ratio = spring_storage.damping_ratios[i]
+        });
+    }
+
+    auto header = WorldFileHeader{};
+    header.magic = world_file_magic;
+    header.version = world_file_version;
+    header.byte_order = world_file_byte_order;
+
+    const auto counts = std::array<std::size_t, num_world_file_sections>{1, vertices.size(), polygons.size(), bodies.size(), springs.size()};
+    const auto record_sizes = WorldFileRecordSizes();
+    auto offset = AlignWorldFileOffset(sizeof(WorldFileHeader));
+    for (int i = 0; i < num_world_file_sections; ++i)
+    {
+        header.sections[i] = WorldFileSectionEntry{
+            .offset = offset,
+            .count = counts[i],
+            .record_size = static_cast<std::uint32_t>(record_sizes[i]),
+            .reserved = 0
+        };
+        offset = AlignWorldFileOffset(offset + counts[i] * record_sizes[i]);
+    }
+    header.file_size = header.sections.back().offset + counts.back() * record_sizes.back();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    auto position = std::uint64_t(sizeof(header));
+    const auto& sections = header.sections;
+    WriteWorldFileSection(out, position, sections[static_cast<int>(WorldFileSection::Config)], std::span(&config, 1));
+    WriteWorldFileSection(out, position, sections[static_cast<int>(WorldFileSection::Vertices)], std::span<const WorldFileVec2>(vertices));
+    WriteWorldFileSection(out, position, sections[static_cast<int>(WorldFileSection::Polygons)], std::span<const WorldFilePolygon>(polygons));
+    WriteWorldFileSection(out, position, sections[static_cast<int>(WorldFileSection::Bodies)], std::span<const WorldFileBody>(bodies));
+    WriteWorldFileSection(out, position, sections[static_cast<int>(WorldFileSection::Springs)], std::span<const WorldFileSpring>(springs));
+}
+
+bool WriteWorldFile(const World& world, const std::string& path)
+{
+    auto file = std::ofstream(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    WriteWorldFile(world, file);
+    return static_cast<bool>(file);
+}
+
+void LoadWorld(const WorldFileView& file, World& world)
+{
+    assert(world.Objects().empty());
+
+    world.Configure(ToWorldConfig(file.Config()));
+
+    const auto file_vertices = file.Vertices();
+    auto geometries = std::vector<std::shared_ptr<const PolygonGeometry>>();
+    auto vertices = std::vector<Vec3>();
+    geometries.reserve(file.Polygons().size());
+    for (const auto& polygon : file.Polygons())
+    {
+        vertices.clear();
+        for (const auto& vertex : file_vertices.subspan(polygon.first_vertex, polygon.num_vertices))
+        {
+            vertices.push_back(ToVec3(vertex));
+        }
+        geometries.push_back(MakePooled<PolygonGeometry>(vertices));
+    }
+
+    // Springs refer to the bodies by their order in the file.
+    auto objects = std::vector<Rigidbody*>();
+    objects.reserve(file.Bodies().size());
+    world.ReserveObjects(static_cast<int>(file.Bodies().size()));
+    for (const auto& body : file.Bodies())
+    {
+        auto collider = body.shape == WorldFileShape::Polygon
+            ? std::shared_ptr<ICollider>(MakePooled<ConvexPolygon>(geometries[body.polygon]))
+            : std::shared_ptr<ICollider>(MakePooled<Circle>(body.radius));
+
+        // The inverses are restored as they were, since inverting the mass twice may round differently.
+        auto object = MakePooled<Rigidbody>(collider, body.material, 0.0f, 0.0f);
+        object->SetInverseMass(body.inv_mass);
+        object->SetInverseInertia(body.inv_inertia);
+        object->Transform().SetPosition(ToVec3(body.position));
+        object->Transform().SetRotation(body.rotation);
+        object->SetLinearVelocity(ToVec3(body.linear_velocity));
+        object->SetAngularVelocity({0.0f, 0.0f, body.angular_velocity});
+
+        objects.push_back(object.get());
+        world.AddObject(std::move(object), body.id);
+    }
+
+    for (const auto& spring : file.Springs())
+    {
+        world.AddSpring(Spring{
+            .start = {objects[spring.body1], ToVec3(spring.local_anchor1)},
+            .end = {objects[spring.body2], ToVec3(spring.local_anchor2)},
+            .neutral_distance = spring.neutral_distance,
+            .hertz = spring.hertz,
+            .damping_ratio = spring.damping_ratio
+        });
+    }
+}
+
+bool ReadWorldFile(const std::string& path, World& world)
+{
+    auto file = std::ifstream(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        return false;
+    }
+    const auto size = static_cast<std::size_t>(file.tellg());
+    file.seekg(0);
+
+    // A single allocation for the whole file, whose elements align every record.
+    auto buffer = std::vector<std::uint64_t>((size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size)))
+    {
+        return false;
+    }
+
+    const auto view = WorldFileView::Open(std::as_bytes(std::span(buffer)).first(size));
+    if (!view)
+    {
+        return false;
+    }
+    LoadWorld(*view, world);
+    return true;
+}
+
+} // namespace physics
@@ -0,0 +1,30 @@
+#include "WorldSnapshot.h"
+
+namespace physics
+{
+
+std::optional<int> WorldSnapshot::Find(BodyHandle handle) const
+{
+    for (int i = 0; i < handles.size(); ++i)
+    {
+        if (handles[i] == handle)
+        {
+            return i;
+        }
+    }
+    return {};
+}
+
+BodyHandle WorldSnapshot::PickHandle(const Vec3& pos) const
+{
+    for (int i = 0; i < handles.size(); ++i)
+    {
+        if (colliders[i]->IsPointInside(transforms[i].LocalPosition(pos)))
+        {
+            return handles[i];
+        }
+    }
+    return {};
+}
+
+} // namespace physics
@@ -0,0 +1,569 @@
+#include "AllocationCounter.h"
+#include "BenchReport.h"
+#include "PoolAllocator.h"
+#include "StressScenes.h"
+#include "Tracer.h"
+#include "World.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace physics;
+
+/**
+ * @brief Options given on the command line.
+ */
+struct BenchOptions
+{
+    std::vector<const StressScene*> scenes;
+    BenchSettings settings;
+
+    // Empty to skip the JSON report, "-" to print it instead of the table.
+    std::string json_path;
+
+    // Empty to disable tracing.
+    std::string trace_path;
+
+    // A report to compare against, which is overwritten instead if update_baseline is set.
+    std::string baseline_path;
+    bool update_baseline = false;
+    RegressionLimits limits;
+};
+
+void PrintUsage()
+{
+    std::cout <<
+        "Usage: physics_bench [options]\n"
+        "\n"
+        "Steps each stress scene headless for a number of frames,\n"
+        "and reports steps per second, the time of each phase and peak memory.\n"
+        "\n"
+        "Options:\n"
+        "  --scene NAME               Scene to run, repeatable. Runs every scene if omitted.\n"
+        "  --bodies N                 Dynamic objects per scene. (default: 1000)\n"
+        "  --frames N                 Measured frames, one fixed step each. (default: 600)\n"
+        "  --warmup N                 Frames stepped before measuring. (default: 60)\n"
+        "  --threads N                Threads of the parallel stages. (default: 1)\n"
+        "  --solver NAME              substepped or sequential. (default: substepped)\n"
+        "  --substeps N               Substeps per step of the substepped solver. (default: 4)\n"
+        "  --split-impulse            Correct positions with split impulse instead of moving objects directly.\n"
+        "  --correction-iterations N  Split impulse iterations. (default: 4)\n"
+        "  --joint-iterations N       Spring and joint iterations. (default: 8)\n"
+        "  --deterministic            Order objects by id before every collision detection.\n"
+        "  --json PATH                Also write the results as JSON, or print them instead of the table if PATH is -.\n"
+        "  --trace PATH               Record a Chrome trace of the last steps, which is written to PATH on exit.\n"
+        "\n"
+        "Regression check:\n"
+        "  --compare PATH             Compare the median times and heap allocations against the JSON results in PATH,\n"
+        "                             and exit with 1 if anything got worse. The settings must match the baseline.\n"
+        "  --update-baseline          Write the results to the --compare PATH instead of comparing.\n"
+        "  --tolerance FRACTION       How much slower a median may get, e.g., 0.1 for 10%. (default: 0.1)\n"
+        "  --min-difference MS        Ignore differences smaller than this. (default: 0.02)\n"
+        "\n"
+        "  --help                     Show this message.\n"
+        "\n"
+        "Scenes:\n";
+    for (const auto& scene : StressScenes())
+    {
+        std::printf("  %-26s %s\n", scene.name, scene.description);
+    }
+}
+
+bool ParseInt(std::string_view text, int min, int& value)
+{
+    const auto end = text.data() + text.size();
+    const auto [ptr, error] = std::from_chars(text.data(), end, value);
+    return error == std::errc() && ptr == end && value >= min;
+}
+
+bool ParseNonNegative(std::string_view text, double& value)
+{
+    const auto end = text.data() + text.size();
+    const auto [ptr, error] = std::from_chars(text.data(), end, value);
+    return error == std::errc() && ptr == end && value >= 0.0;
+}
+
+/**
+ * @return False if the arguments are invalid, in which case the reason is printed.
+ */
+bool ParseOptions(int argc, char** argv, BenchOptions& options, bool& show_help)
+{
+    auto& settings = options.settings;
+    const auto int_options = std::array<std::pair<std::string_view, int*>, 7>{{
+        {"--bodies", &settings.num_bodies},
+        {"--frames", &settings.num_frames},
+        {"--warmup", &settings.num_warmup_frames},
+        {"--threads", &settings.num_threads},
+        {"--substeps", &settings.num_substeps},
+        {"--correction-iterations", &settings.num_correction_iterations},
+        {"--joint-iterations", &settings.num_joint_iterations}
+    }};
+    const auto string_options = std::array<std::string_view, 7>{
+        "--scene", "--solver", "--json", "--trace", "--compare", "--tolerance", "--min-difference"
+    };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto arg = std::string_view(argv[i]);
+        if (arg == "--help" || arg == "-h")
+        {
+            show_help = true;
+            return true;
+        }
+        if (arg == "--split-impulse")
+        {
+            settings.correction_mode = PositionalCorrectionMode::SplitImpulse;
+            continue;
+        }
+        if (arg == "--deterministic")
+        {
+            settings.deterministic = true;
+            continue;
+        }
+        if (arg == "--update-baseline")
+        {
+            options.update_baseline = true;
+            continue;
+        }
+
+        // Every other option takes a value.
+        const auto int_option = std::find_if(int_options.begin(), int_options.end(), [arg](const auto& option) {
+            return option.first == arg;
+        });
+        if (int_option == int_options.end() && std::find(string_options.begin(), string_options.end(), arg) == string_options.end())
+        {
+            std::cerr << "unknown option: " << arg << "\n";
+            return false;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "missing value of " << arg << "\n";
+            return false;
+        }
+        const auto value = std::string_view(argv[++i]);
+
+        if (arg == "--scene")
+        {
+            const auto scene = FindStressScene(value);
+            if (!scene)
+            {
+                std::cerr << "unknown scene: " << value << "\n";
+                return false;
+            }
+            options.scenes.push_back(scene);
+            continue;
+        }
+        if (arg == "--solver")
+        {
+            if (value != "substepped" && value != "sequential")
+            {
+                std::cerr << "unknown solver: " << value << "\n";
+                return false;
+            }
+            settings.use_substepping = value == "substepped";
+            continue;
+        }
+        if (arg == "--json")
+        {
+            options.json_path = value;
+            continue;
+        }
+        if (arg == "--trace")
+        {
+            options.trace_path = value;
+            continue;
+        }
+        if (arg == "--compare")
+        {
+            options.baseline_path = value;
+            continue;
+        }
+        if (arg == "--tolerance" || arg == "--min-difference")
+        {
+            auto& limit = arg == "--tolerance" ? options.limits.tolerance : options.limits.min_difference_ms;
+            if (!ParseNonNegative(value, limit))
+            {
+                std::cerr << "invalid value of " << arg << ": " << value << "\n";
+                return false;
+            }
+            continue;
+        }
+
+        // Only warmup may be zero.
+        const auto min = arg == "--warmup" ? 0 : 1;
+        if (!ParseInt(value, min, *int_option->second))
+        {
+            std::cerr << "invalid value of " << arg << ": " << value << "\n";
+            return false;
+        }
+    }
+
+    if (options.update_baseline && options.baseline_path.empty())
+    {
+        std::cerr << "--update-baseline needs the path given by --compare\n";
+        return false;
+    }
+
+    if (options.scenes.empty())
+    {
+        for (const auto& scene : StressScenes())
+        {
+            options.scenes.push_back(&scene);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Start measuring the high-water mark again, so that every scene reports its own peak.
+ *
+ * @note Only Linux can reset it. Elsewhere, the peak includes the scenes that ran before.
+ */
+void ResetPeakMemory()
+{
+#if defined(__linux__)
+    if (auto clear_refs = std::ofstream("/proc/self/clear_refs"))
+    {
+        clear_refs << "5";
+    }
+#endif
+}
+
+std::uint64_t PeakMemoryBytes()
+{
+#if defined(_WIN32)
+    auto counters = PROCESS_MEMORY_COUNTERS{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#elif defined(__unix__) || defined(__APPLE__)
+#if defined(__linux__)
+    // Unlike getrusage(), this is the peak since ResetPeakMemory().
+    auto status = std::ifstream("/proc/self/status");
+    auto line = std::string();
+    while (std::getline(status, line))
+    {
+        if (line.starts_with("VmHWM:"))
+        {
+            return std::stoull(line.substr(6)) * 1024;
+        }
+    }
+#endif
+    auto usage = rusage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+void ConfigureWorld(World& world, const BenchSettings& settings)
+{
+    world.ConfigureThreadCount(settings.num_threads);
+    world.ConfigurePipeline(settings.use_substepping, true);
+    world.ConfigureSubstepping(settings.num_substeps, 30.0f, 10.0f, 30.0f);
+    world.ConfigurePositionalCorrectionMode(settings.correction_mode, settings.num_correction_iterations);
+    world.ConfigureJoints(60.0f, 2.0f, settings.num_joint_iterations);
+    world.ConfigureDeterminism(settings.deterministic);
+}
+
+/**
+ * @return Heap allocations of replacing every object of @p world with a new one,
+ *         i.e., despawning it and spawning the same body again.
+ *
+ * @note Springs and joints are removed along with the old bodies.
+ */
+std::uint64_t CountRespawnAllocations(World& world)
+{
+    auto handles = std::vector<BodyHandle>();
+    for (const auto& object : world.Objects())
+    {
+        handles.push_back(world.Handle(*object));
+    }
+
+    const auto start = HeapAllocationCount();
+    for (const auto handle : handles)
+    {
+        const auto* object = world.Object(handle);
+        auto collider = object->Collider()->Clone();
+        const auto material = object->Material();
+        const auto transform = object->Transform();
+        const auto inv_mass = object->InverseMass();
+        const auto inv_inertia = object->InverseInertia();
+        const auto id = world.BodyId(*object);
+
+        world.RemoveObject(handle);
+        auto respawned = MakePooled<Rigidbody>(std::move(collider), material, 0.0f, 0.0f);
+        respawned->SetInverseMass(inv_mass);
+        respawned->SetInverseInertia(inv_inertia);
+        respawned->Transform() = transform;
+        world.AddObject(std::move(respawned), id);
+    }
+    return HeapAllocationCount() - start;
+}
+
+SceneResult RunScene(const StressScene& scene, const BenchSettings& settings)
+{
+    using Clock = std::chrono::steady_clock;
+
+    ResetPeakMemory();
+
+    auto world = World();
+    ConfigureWorld(world, settings);
+    scene.build(world, settings.num_bodies);
+
+    auto result = SceneResult();
+    result.name = scene.name;
+    result.num_objects = static_cast<int>(world.Objects().size());
+    result.num_springs = world.Springs().Size();
+
+    // Every frame runs exactly one fixed step.
+    const auto frame_time = world.FixedTimeStep();
+    for (int frame = 0; frame < settings.num_warmup_frames; ++frame)
+    {
+        world.Step(frame_time);
+    }
+
+    auto step_samples = std::vector<float>();
+    auto phase_samples = std::array<std::vector<float>, num_step_phases>();
+    step_samples.reserve(settings.num_frames);
+    for (auto& samples : phase_samples)
+    {
+        samples.reserve(settings.num_frames);
+    }
+
+    auto total_time = Clock::duration::zero();
+    for (int frame = 0; frame < settings.num_frames; ++frame)
+    {
+        const auto start = Clock::now();
+        world.Step(frame_time);
+        const auto elapsed = Clock::now() - start;
+
+        total_time += elapsed;
+        step_samples.push_back(std::chrono::duration<float, std::milli>(elapsed).count());
+
+        // Read outside of the measured time, since it sorts the samples of the profiler.
+        const auto stats = world.Stats();
+        result.heap_allocations += stats.allocations.heap_allocations;
+        result.has_phases = stats.enabled;
+        if (stats.enabled)
+        {
+            for (int phase = 0; phase < num_step_phases; ++phase)
+            {
+                phase_samples[phase].push_back(stats.phases[phase].last_ms);
+            }
+            result.counters = stats.counters;
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(total_time).count();
+    result.steps_per_second = result.seconds > 0.0 ? settings.num_frames / result.seconds : 0.0;
+    result.step = Summarize(step_samples);
+    for (int phase = 0; phase < num_step_phases; ++phase)
+    {
+        result.phases[phase] = Summarize(phase_samples[phase]);
+    }
+    result.peak_memory_bytes = PeakMemoryBytes();
+    result.state_hash = world.StateHash();
+
+    // Last, since the new bodies change the order and lose the springs.
+    result.respawn_heap_allocations = CountRespawnAllocations(world);
+    return result;
+}
+
+void PrintTable(const BenchReport& report)
+{
+    const auto& settings = report.settings;
+    std::printf("bodies %d, frames %d (+%d warmup), threads %d, %s solver, %s correction%s\n\n",
+        settings.num_bodies,
+        settings.num_frames,
+        settings.num_warmup_frames,
+        settings.num_threads,
+        settings.use_substepping ? "substepped" : "sequential",
+        settings.correction_mode == PositionalCorrectionMode::SplitImpulse ? "split impulse" : "direct",
+        settings.deterministic ? ", deterministic" : "");
+
+    std::printf("%-10s %8s %8s %12s %10s %10s %10s %10s %12s\n",
+        "scene", "objects", "springs", "steps/s", "avg ms", "median ms", "p99 ms", "max ms", "peak MiB");
+    for (const auto& result : report.scenes)
+    {
+        std::printf("%-10s %8d %8d %12.1f %10.3f %10.3f %10.3f %10.3f %12.1f\n",
+            result.name.c_str(),
+            result.num_objects,
+            result.num_springs,
+            result.steps_per_second,
+            result.step.average_ms,
+            result.step.median_ms,
+            result.step.p99_ms,
+            result.step.max_ms,
+            result.peak_memory_bytes / (1024.0 * 1024.0));
+    }
+
+    for (const auto& result : report.scenes)
+    {
+        if (!result.has_phases)
+        {
+            continue;
+        }
+
+        std::printf("\n%s: %s\n", result.name.c_str(), FindStressScene(result.name)->description);
+        std::printf("  %-20s %10s %10s %10s %10s\n", "phase", "avg ms", "median ms", "p99 ms", "max ms");
+        for (int phase = 0; phase < num_step_phases; ++phase)
+        {
+            std::printf("  %-20s %10.3f %10.3f %10.3f %10.3f\n",
+                PhaseName(static_cast<StepPhase>(phase)),
+                result.phases[phase].average_ms,
+                result.phases[phase].median_ms,
+                result.phases[phase].p99_ms,
+                result.phases[phase].max_ms);
+        }
+
+        const auto& counters = result.counters;
+        std::printf("  last step: %llu candidate pairs, %llu narrowphase tests, %llu SAT axes, %llu contacts, %llu solver iterations\n",
+            static_cast<unsigned long long>(counters.candidate_pairs),
+            static_cast<unsigned long long>(counters.narrowphase_tests),
+            static_cast<unsigned long long>(counters.sat_axes),
+            static_cast<unsigned long long>(counters.contacts),
+            static_cast<unsigned long long>(counters.solver_iterations));
+        if (report.counts_allocations)
+        {
+            std::printf("  heap allocations over %d frames: %llu, respawning every object: %llu\n",
+                settings.num_frames,
+                static_cast<unsigned long long>(result.heap_allocations),
+                static_cast<unsigned long long>(result.respawn_heap_allocations));
+        }
+    }
+
+    if (!report.scenes.empty() && !report.scenes.front().has_phases)
+    {
+        std::printf("\nPhases are not reported, since the library was built without PHYSICS_PROFILE.\n");
+    }
+}
+
+bool WriteReportFile(const std::string& path, const BenchReport& report)
+{
+    auto file = std::ofstream(path);
+    if (!file)
+    {
+        std::cerr << "failed to write " << path << "\n";
+        return false;
+    }
+    WriteBenchReport(file, report);
+    return true;
+}
+
+/**
+ * @return The exit code of the regression check.
+ */
+int CompareWithBaseline(const BenchOptions& options, const BenchReport& report)
+{
+    auto file = std::ifstream(options.baseline_path);
+    const auto baseline = file ? ReadBenchReport(file) : std::nullopt;
+    if (!baseline)
+    {
+        std::cerr << "failed to read the baseline " << options.baseline_path << "\n";
+        return 2;
+    }
+    if (baseline->settings != report.settings)
+    {
+        std::cerr << "the baseline " << options.baseline_path << " was recorded with other settings,"
+                  << " run with the same options or refresh it with --update-baseline\n";
+        return 2;
+    }
+
+    std::cout << "\ncomparing against " << options.baseline_path << "\n";
+    const auto num_regressions = CompareBenchReports(*baseline, report, options.limits, std::cout);
+    return num_regressions == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    auto options = BenchOptions();
+    auto show_help = false;
+    if (!ParseOptions(argc, argv, options, show_help))
+    {
+        std::cerr << "run with --help to see the options\n";
+        return 2;
+    }
+    if (show_help)
+    {
+        PrintUsage();
+        return 0;
+    }
+
+    // Once the ring buffer is full, it only keeps the latest events, so trace a single scene to capture all of it.
+    if (!options.trace_path.empty())
+    {
+        Tracer::Global().SetThreadName("main");
+        Tracer::Global().Enable();
+        Tracer::Global().WriteOnExit(options.trace_path);
+    }
+
+    const auto json_only = options.json_path == "-";
+
+    auto report = BenchReport();
+    report.settings = options.settings;
+    report.counts_allocations = IsCountingHeapAllocations();
+    for (const auto scene : options.scenes)
+    {
+        if (!json_only)
+        {
+            std::cerr << "running " << scene->name << "...\n";
+        }
+        report.scenes.push_back(RunScene(*scene, options.settings));
+    }
+
+    if (json_only)
+    {
+        WriteBenchReport(std::cout, report);
+    }
+    else
+    {
+        PrintTable(report);
+    }
+
+    if (!options.json_path.empty() && !json_only && !WriteReportFile(options.json_path, report))
+    {
+        return 2;
+    }
+
+    if (options.update_baseline)
+    {
+        if (!WriteReportFile(options.baseline_path, report))
+        {
+            return 2;
+        }
+        std::cerr << "updated the baseline " << options.baseline_path << "\n";
+        return 0;
+    }
+    if (!options.baseline_path.empty())
+    {
+        return CompareWithBaseline(options, report);
+    }
+    return 0;
+}
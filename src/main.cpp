@@ -2,15 +2,32 @@
 #include "imgui-SFML.h"
 #include "Circle.h"
 #include "ConvexPolygon.h"
+#include "PoolAllocator.h"
 #include "Gizmo.h"
-#include "world.h"
+#include "SimulationThread.h"
+#include "World.h"
 #include "UI.h"
 #include "ObjectDragger.h"
 #include "PolygonDrawer.h"
+#include "RenderView.h"
+#include "ShapeCache.h"
 #include "SpringConnector.h"
+#include "Tracer.h"
+#include "TrajectoryFile.h"
 
 using namespace physics;
 
+/**
+ * @brief Converts the gravity strength of the UI, which is the velocity gained per frame at 60 FPS,
+ *        into the acceleration per second used by World::ConfigureGravity().
+ */
+constexpr float gravity_per_second_scale = 60.0f;
+
+/**
+ * @brief The file written by "record" and read by "replay".
+ */
+constexpr auto trajectory_path = "physics_trajectory.bin";
+
 /*
 TODO:
 - add description about the math stuff used to derive equation for impulse magnitude...
@@ -30,7 +47,33 @@ std::shared_ptr<Rigidbody> CreateObject(std::shared_ptr<ICollider> collider)
     const auto mass = area;
     const auto inertia = area * area + mass * collider->CenterOfMass().SquaredMagnitude();
 
-    return std::make_shared<Rigidbody>(collider, default_mat, mass, inertia);
+    return MakePooled<Rigidbody>(collider, default_mat, mass, inertia);
+}
+
+/**
+ * @brief Options of the UI applied to the world.
+ *        Compared on every frame, so that a command is submitted only when something changed.
+ */
+struct WorldSettings
+{
+    PositionalCorrectionMode correction_mode;
+    int num_substeps;
+    bool use_substepping;
+    bool resolve_collisions;
+    float linear_damping;
+    float angular_damping;
+    float gravity;
+
+    bool operator==(const WorldSettings& other) const = default;
+};
+
+void ApplySettings(World& world, const WorldSettings& settings)
+{
+    world.ConfigurePositionalCorrectionMode(settings.correction_mode, 4);
+    world.ConfigureSubstepping(settings.num_substeps, 30.0f, 10.0f, 30.0f);
+    world.ConfigurePipeline(settings.use_substepping, settings.resolve_collisions);
+    world.ConfigureDamping(settings.linear_damping, settings.angular_damping);
+    world.ConfigureGravity({0, settings.gravity});
 }
 
 int main()
@@ -40,48 +83,60 @@ int main()
     if (!ImGui::SFML::Init(window)) return -1;
 
     auto gizmo = Gizmo();
+    auto render_view = RenderView();
     auto world = std::make_shared<World>();
-    auto dragger = std::make_shared<ObjectDragger>(world);
-    auto drawer = std::make_shared<PolygonDrawer>(world);
-    auto spring = std::make_shared<SpringConnector>(world);
+    auto simulation = std::make_shared<SimulationThread>(world);
+    auto dragger = std::make_shared<ObjectDragger>(simulation);
+    auto shape_cache = std::make_shared<ShapeCache>();
+    auto drawer = std::make_shared<PolygonDrawer>(simulation, shape_cache);
+    auto spring = std::make_shared<SpringConnector>(simulation);
 
     auto ui = UI();
     ui.AddMouseActionType(dragger);
     ui.AddMouseActionType(drawer);
     ui.AddMouseActionType(spring);
 
-    auto object1 = CreateObject(std::make_shared<Circle>(20.0f));
+    auto object1 = CreateObject(MakePooled<Circle>(20.0f));
     object1->Transform().SetPosition({100, 310});
     // object1->SetInertia(0.0f);
     world->AddObject(object1);
 
-    auto object2 = CreateObject(std::make_shared<ConvexPolygon>(std::vector<Vec3>{
+    auto object2 = CreateObject(MakePooled<ConvexPolygon>(shape_cache->Polygon({
         {-20.0f, -20.0f},
         {20.0f, -20.0f},
         {20.0f, 20.0f},
         {-20.0f, 20.0f}
-    }));
+    })));
     object2->Transform().SetPosition({150, 400});
     world->AddObject(object2);
 
-    auto object3 = CreateObject(std::make_shared<ConvexPolygon>(std::vector<Vec3>{
+    auto object3 = CreateObject(MakePooled<ConvexPolygon>(shape_cache->Polygon({
         {-50.0f, -50.0f},
         {50.0f, -50.0f},
         {50.0f, 50.0f}
-    }));
+    })));
     object3->Transform().SetPosition({500, 400});
     world->AddObject(object3);
 
-    auto object4 = CreateObject(std::make_shared<ConvexPolygon>(std::vector<Vec3>{
+    auto object4 = CreateObject(MakePooled<ConvexPolygon>(shape_cache->Polygon({
         {-400.0f, -30.0f},
         {400.0f, -30.0f},
         {400.0f, 30.0f},
         {-400.0f, 30.0f}
-    }));
+    })));
     object4->Transform().SetPosition({400, 500});
     object4->MakeObjectStatic();
     world->AddObject(object4);
 
+    auto applied_settings = std::optional<WorldSettings>{};
+
+    auto is_recording = false;
+    auto recorder = std::shared_ptr<TrajectoryRecorder>();
+    auto is_replaying = false;
+    auto replay = std::unique_ptr<TrajectoryReader>();
+    auto replay_snapshot = WorldSnapshot();
+    auto replay_time = 0.0f;
+
     sf::Clock deltaClock;
     while (window.isOpen())
     {
@@ -97,57 +152,156 @@ int main()
         // UI and object dragging.
         auto delta_time = deltaClock.restart();
         ImGui::SFML::Update(window, delta_time);
+        ui.SetStepStats(simulation->Snapshot().stats);
         ui.Update();
-        spring->ConfigureSprintCoefficient(ui.SpringCoefficient());
+        spring->ConfigureSpring(ui.SpringFrequency(), ui.SpringDampingRatio());
+        dragger->ConfigureDragStrength(ui.DragStrength());
 
-        auto time_step = delta_time.asSeconds() * ui.TimeScale();
-
-        // Update
-        world->CheckCollisions();
-        if (ui.IsUpdateRequired())
+        // The trace covers every thread, including the simulation thread and the workers.
+        auto& tracer = Tracer::Global();
+        if (ui.IsTracingEnabled() != tracer.IsEnabled())
         {
-            if (ui.IsCollisionEnabled())
+            if (ui.IsTracingEnabled())
             {
-                world->ResolveCollisions(time_step);
+                tracer.Enable();
             }
-
-            if (dragger->IsObjectSelected())
+            else
             {
-                dragger->ApplyDraggingForce(ui.DragStrength(), time_step);
+                tracer.Disable();
             }
+        }
+        if (ui.IsTraceSaveRequired())
+        {
+            tracer.WriteChromeTrace("physics_trace.json");
+        }
 
-            if (ui.IsGravityEnabled())
+        // Every fixed step is recorded on the thread which steps the world,
+        // while the file is written on a thread of its own.
+        if (ui.IsRecordingEnabled() != is_recording)
+        {
+            is_recording = ui.IsRecordingEnabled();
+            if (is_recording)
             {
-                for (auto& object : world->Objects())
+                recorder = TrajectoryRecorder::Open(trajectory_path);
+                if (recorder)
                 {
-                    if (object->InverseMass() > 0.0f)
-                    {
-                        object->ApplyImpulse({}, Vec3{0, ui.GravityStrength() / object->InverseMass()}, time_step);
-                    }
+                    simulation->Submit([recorder](World& world) {
+                        world.ConfigureStepCallback([recorder](const World& world) {
+                            recorder->Record(world);
+                        });
+                    });
                 }
             }
+            else if (recorder)
+            {
+                // Finished right away, so that the file can be replayed on the next frame.
+                // Steps recorded before the callback is removed are ignored.
+                recorder->Finish();
+                simulation->Submit([](World& world) {
+                    world.ConfigureStepCallback({});
+                });
+                recorder.reset();
+            }
+        }
+        if (ui.IsReplayEnabled() != is_replaying)
+        {
+            is_replaying = ui.IsReplayEnabled();
+            replay = is_replaying ? TrajectoryReader::Open(trajectory_path) : nullptr;
+            replay_time = 0.0f;
+        }
+
+        // The world belongs to the simulation from now on,
+        // which steps it either right here or on its own thread.
+        if (ui.IsSimulationThreadEnabled() != simulation->IsRunning())
+        {
+            if (ui.IsSimulationThreadEnabled())
+            {
+                simulation->Start();
+            }
+            else
+            {
+                simulation->Stop();
+            }
+        }
 
-            world->ConfigureDamping(ui.LinearDamping(), ui.AngularDamping());
-            world->Update(time_step);
+        const auto settings = WorldSettings{
+            .correction_mode = ui.IsSplitImpulseEnabled() ? PositionalCorrectionMode::SplitImpulse : PositionalCorrectionMode::Direct,
+            .num_substeps = ui.SubstepCount(),
+            .use_substepping = ui.IsSubsteppingEnabled(),
+            .resolve_collisions = ui.IsCollisionEnabled(),
+            .linear_damping = ui.LinearDamping(),
+            .angular_damping = ui.AngularDamping(),
+            .gravity = ui.IsGravityEnabled() ? ui.GravityStrength() * gravity_per_second_scale : 0.0f
+        };
+        if (!applied_settings.has_value() || settings != applied_settings.value())
+        {
+            simulation->Submit([settings](World& world) {
+                ApplySettings(world, settings);
+            });
+            applied_settings = settings;
+        }
+
+        // Manual update always advances exactly one step, regardless of the time scale.
+        // The simulation is paused during a replay.
+        const auto is_auto_update = ui.IsUpdateRequired() && !ui.IsSingleStepRequired() && !is_replaying;
+        simulation->ConfigureTimeScale(is_auto_update ? ui.TimeScale() : 0.0f);
+        if (ui.IsSingleStepRequired() && !is_replaying)
+        {
+            simulation->Submit([](World& world) {
+                world.Step(world.FixedTimeStep());
+            });
         }
 
+        if (!simulation->IsRunning())
+        {
+            simulation->Update(delta_time.asSeconds());
+        }
+
+        // A replay draws the recorded frames instead, which only have to be decoded.
+        auto is_replay_drawn = false;
+        if (replay && replay->NumFrames() > 0)
+        {
+            const auto time_step = replay->FixedTimeStep();
+            if (ui.IsReplayPlaying() && !ui.IsReplayFrameChanged())
+            {
+                replay_time += delta_time.asSeconds() * ui.TimeScale();
+            }
+            else
+            {
+                replay_time = ui.ReplayFrame() * time_step;
+            }
+
+            // Playing starts over after the last frame.
+            auto frame = static_cast<std::uint64_t>(replay_time / time_step);
+            if (frame >= replay->NumFrames())
+            {
+                frame = 0;
+                replay_time = 0.0f;
+            }
+            is_replay_drawn = replay->Seek(frame);
+            if (is_replay_drawn)
+            {
+                replay->FillSnapshot(replay_snapshot);
+            }
+        }
+        ui.SetReplayFrame(
+            is_replay_drawn ? static_cast<int>(replay->Frame()) : 0,
+            is_replay_drawn ? static_cast<int>(replay->NumFrames()) : 0
+        );
+        const auto& snapshot = is_replay_drawn ? replay_snapshot : simulation->AcquireSnapshot();
+
         // Prepare rendering.
         window.clear(sf::Color::White);
 
-        // Draw all objects.
-        for (auto& object : world->Objects())
+        // Draw all objects, placed on the interpolated transform.
+        render_view.Draw(snapshot, window);
+
+        // Orientation of all objects.
+        for (const auto& render_transform : snapshot.transforms)
         {
-            // Collider.
-            auto& shape = object->Collider()->SFMLShape();
-            shape.setFillColor(sf::Color::Transparent);
-            shape.setOutlineColor(sf::Color::Black);
-            shape.setOutlineThickness(2);
-            window.draw(shape);
-
-            // Orientation.
             window.draw(gizmo.Direction(
-                object->Transform().Position(),
-                object->Transform().GlobalDirection({1, 0})
+                render_transform.Position(),
+                render_transform.GlobalDirection({1, 0})
             ));
         }
 
@@ -167,22 +321,20 @@ int main()
         }
 
         // Draw gizmo for spring connections.
-        for (const auto& spring : world->Springs())
+        for (const auto& segment : snapshot.springs)
         {
-            const auto start = spring.start.GlobalPosition();
-            const auto end = spring.end.GlobalPosition();
-            window.draw(gizmo.Point(start, sf::Color::Green));
-            window.draw(gizmo.Point(end, sf::Color::Green));
-            window.draw(gizmo.Line(start, end, sf::Color::Green));
+            window.draw(gizmo.Point(segment.start, sf::Color::Green));
+            window.draw(gizmo.Point(segment.end, sf::Color::Green));
+            window.draw(gizmo.Line(segment.start, segment.end, sf::Color::Green));
         }
 
         // Draw contact points for all collisions.
-        for (const auto& collision : world->Collisions())
+        for (const auto& collision : snapshot.collisions)
         {
-            for (const auto& contact : collision.info.contacts)
+            for (const auto& contact : collision.contacts)
             {
                 window.draw(gizmo.Point(contact, sf::Color::Red));
-                window.draw(gizmo.Direction(contact, collision.info.normal));
+                window.draw(gizmo.Direction(contact, collision.normal));
             }
         }
 
@@ -192,6 +344,11 @@ int main()
         // Update screen.
         window.display();
     }
+    simulation->Stop();
+    if (recorder)
+    {
+        recorder->Finish();
+    }
     ImGui::SFML::Shutdown();
 
     return 0;
@@ -0,0 +1,495 @@
+#include "Angle.h"
+#include "Circle.h"
+#include "ConvexPolygon.h"
+#include "LineSegment.h"
+#include "Transform.h"
+#include "Vec3.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace physics;
+
+/**
+ * @brief Make the compiler keep the computation of @p value, which the benchmark never reads.
+ */
+#if defined(_MSC_VER)
+volatile const void* escaped_result = nullptr;
+
+template <typename T>
+inline void KeepResult(const T& value)
+{
+    escaped_result = &value;
+    _ReadWriteBarrier();
+}
+#else
+template <typename T>
+inline void KeepResult(const T& value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+#endif
+
+/**
+ * @brief Random inputs, which are the same on every run and platform.
+ *        std::mt19937 is fully specified, unlike the standard distributions.
+ */
+class InputRandom
+{
+public:
+    explicit InputRandom(std::uint32_t seed)
+        : m_engine(seed)
+    {}
+
+    // Uniform in [min, max).
+    float Range(float min, float max)
+    {
+        return min + (max - min) * static_cast<float>(m_engine() >> 8) / static_cast<float>(1 << 24);
+    }
+
+    Vec3 Point(float extent)
+    {
+        return {Range(-extent, extent), Range(-extent, extent)};
+    }
+
+private:
+    std::mt19937 m_engine;
+};
+
+// Every benchmark cycles through this many inputs, which stay in the L1 and L2 caches,
+// so the branch predictor can't learn a single input and the loads don't measure memory.
+constexpr int num_inputs = 256;
+
+constexpr auto vertex_counts = {3, 4, 8, 16, 32};
+
+// How deep the bounding circles of a pair overlap, as a fraction of the sum of their radii.
+// At 0 they just touch, so most polygon pairs are separated and SAT exits early.
+constexpr auto overlap_ratios = {0.0f, 0.1f, 0.5f};
+
+/**
+ * @brief A benchmark runs the operation under test @p num_iterations times.
+ */
+struct MicroBenchmark
+{
+    std::string name;
+    std::function<void(int num_iterations)> run;
+};
+
+std::shared_ptr<ConvexPolygon> CreateRegularPolygon(int num_vertices, float radius, InputRandom& random)
+{
+    // Counter-clockwise, starting at a random angle so the edges aren't aligned between pairs.
+    const auto start_angle = random.Range(0.0f, 2.0f * pi);
+    auto vertices = std::vector<Vec3>();
+    for (int i = 0; i < num_vertices; ++i)
+    {
+        const auto [sin, cos] = DeterministicSinCos(start_angle + 2.0f * pi * i / num_vertices);
+        vertices.push_back({radius * cos, radius * sin});
+    }
+    return std::make_shared<ConvexPolygon>(vertices);
+}
+
+/**
+ * @brief Place @p collider2 next to @p collider1 in a random direction,
+ *        so that their bounding circles overlap by @p overlap_ratio.
+ */
+void PlacePair(ICollider& collider1, ICollider& collider2, float overlap_ratio, InputRandom& random)
+{
+    const auto [sin, cos] = DeterministicSinCos(random.Range(0.0f, 2.0f * pi));
+    const auto distance = (1.0f - overlap_ratio) * (collider1.BoundaryRadius() + collider2.BoundaryRadius());
+
+    collider1.Transform().SetPosition(random.Point(100.0f));
+    collider1.Transform().SetRotation(random.Range(0.0f, 2.0f * pi));
+    collider2.Transform().SetPosition(collider1.Transform().Position() + Vec3{cos, sin} * distance);
+    collider2.Transform().SetRotation(random.Range(0.0f, 2.0f * pi));
+}
+
+std::string ParameterName(const char* function, int num_vertices)
+{
+    return std::string(function) + "/" + std::to_string(num_vertices);
+}
+
+std::string OverlapName(const std::string& prefix, float overlap_ratio)
+{
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "/%.2f", overlap_ratio);
+    return prefix + buffer;
+}
+
+void AddVec3Benchmarks(std::vector<MicroBenchmark>& benchmarks)
+{
+    auto random = InputRandom(1);
+    auto vectors = std::make_shared<std::vector<Vec3>>();
+    auto angles = std::make_shared<std::vector<Radian>>();
+    for (int i = 0; i < num_inputs + 1; ++i)
+    {
+        vectors->push_back(random.Point(100.0f));
+        angles->push_back(random.Range(-pi, pi));
+    }
+
+    benchmarks.push_back({"Vec3::operator+ and operator*", [vectors](int num_iterations) {
+        for (int i = 0; i < num_iterations; ++i)
+        {
+            const auto index = i % num_inputs;
+            KeepResult((*vectors)[index] + (*vectors)[index + 1] * 0.5f);
+        }
+    }});
+    benchmarks.push_back({"Vec3::Dot", [vectors](int num_iterations) {
+        for (int i = 0; i < num_iterations; ++i)
+        {
+            const auto index = i % num_inputs;
+            KeepResult((*vectors)[index].Dot((*vectors)[index + 1]));
+        }
+    }});
+    benchmarks.push_back({"Vec3::Cross", [vectors](int num_iterations) {
+        for (int i = 0; i < num_iterations; ++i)
+        {
+            const auto index = i % num_inputs;
+            KeepResult((*vectors)[index].Cross((*vectors)[index + 1]));
+        }
+    }});
+    benchmarks.push_back({"Vec3::Normalize", [vectors](int num_iterations) {
+        for (int i = 0; i < num_iterations; ++i)
+        {
+            auto v = (*vectors)[i % num_inputs];
+            v.Normalize();
+            KeepResult(v);
+        }
+    }});
+    benchmarks.push_back({"Vec3::Rotate", [vectors, angles](int num_iterations) {
+        for (int i = 0; i < num_iterations; ++i)
+        {
+            const auto index = i % num_inputs;
+            auto v = (*vectors)[index];
+            v.Rotate((*angles)[index]);
+            KeepResult(v);
+        }
+    }});
+}
+
+void AddTransformBenchmarks(std::vector<MicroBenchmark>& benchmarks)
+{
+    auto random = InputRandom(2);
+    auto transforms = std::make_shared<std::vector<Transform>>(num_inputs);
+    auto points = std::make_shared<std::vector<Vec3>>();
+    for (auto& transform : *transforms)
+    {
+        transform.SetPosition(random.Point(1000.0f));
+        transform.SetRotation(random.Range(-pi, pi));
+        points->push_back(random.Point(100.0f));
+    }
+
+    benchmarks.push_back({"Transform::GlobalPosition", [transforms, points](int num_iterations) {
+        for (int i = 0; i < num_iterations; ++i)
+        {
+            const auto index = i % num_inputs;
+            KeepResult((*transforms)[index].GlobalPosition((*points)[index]));
+        }
+    }});
+    benchmarks.push_back({"Transform::LocalPosition", [transforms, points](int num_iterations) {
+        for (int i = 0; i < num_iterations; ++i)
+        {
+            const auto index = i % num_inputs;
+            KeepResult((*transforms)[index].LocalPosition((*points)[index]));
+        }
+    }});
+}
+
+void AddLineSegmentBenchmarks(std::vector<MicroBenchmark>& benchmarks)
+{
+    // Incident and reference edges as the polygon collision clips them:
+    // roughly parallel and partially overlapping.
+    auto random = InputRandom(3);
+    auto segments = std::make_shared<std::vector<LineSegment>>();
+    for (int i = 0; i < num_inputs; ++i)
+    {
+        const auto start = random.Point(100.0f);
+        const auto [sin, cos] = DeterministicSinCos(random.Range(-pi, pi));
+        const auto direction = Vec3{cos, sin};
+        segments->emplace_back(start, start + direction * random.Range(5.0f, 50.0f));
+
+        // Separate statements, since the order of evaluation within an expression is unspecified.
+        const auto shift = random.Range(-20.0f, 20.0f);
+        const auto offset = start + direction * shift + random.Point(2.0f);
+        const auto tilt = random.Range(-0.2f, 0.2f);
+        segments->emplace_back(offset, offset + direction.Rotated(tilt) * random.Range(5.0f, 50.0f));
+    }
+
+    benchmarks.push_back({"LineSegment::Clip", [segments](int num_iterations) {
+        for (int i = 0; i < num_iterations; ++i)
+        {
+            const auto index = 2 * (i % num_inputs);
+            KeepResult((*segments)[index].Clip((*segments)[index + 1]));
+        }
+    }});
+}
+
+void AddPolygonBenchmarks(std::vector<MicroBenchmark>& benchmarks)
+{
+    for (const auto num_vertices : vertex_counts)
+    {
+        auto random = InputRandom(4 + num_vertices);
+        auto polygons = std::make_shared<std::vector<std::shared_ptr<ConvexPolygon>>>();
+        auto directions = std::make_shared<std::vector<Vec3>>();
+        for (int i = 0; i < num_inputs; ++i)
+        {
+            polygons->push_back(CreateRegularPolygon(num_vertices, random.Range(5.0f, 50.0f), random));
+            const auto [sin, cos] = DeterministicSinCos(random.Range(-pi, pi));
+            directions->push_back({cos, sin});
+        }
+
+        benchmarks.push_back({ParameterName("ConvexPolygon::Projection", num_vertices),
+            [polygons, directions](int num_iterations) {
+                for (int i = 0; i < num_iterations; ++i)
+                {
+                    const auto index = i % num_inputs;
+                    KeepResult((*polygons)[index]->Projection((*directions)[index]));
+                }
+            }});
+    }
+
+    for (const auto num_vertices : vertex_counts)
+    {
+        for (const auto overlap_ratio : overlap_ratios)
+        {
+            auto random = InputRandom(100 + num_vertices);
+            auto polygons = std::make_shared<std::vector<std::shared_ptr<ConvexPolygon>>>();
+            for (int i = 0; i < num_inputs; ++i)
+            {
+                auto polygon1 = CreateRegularPolygon(num_vertices, random.Range(5.0f, 50.0f), random);
+                auto polygon2 = CreateRegularPolygon(num_vertices, random.Range(5.0f, 50.0f), random);
+                PlacePair(*polygon1, *polygon2, overlap_ratio, random);
+                polygons->push_back(std::move(polygon1));
+                polygons->push_back(std::move(polygon2));
+            }
+
+            benchmarks.push_back({OverlapName(ParameterName("ConvexPolygon::FindMinimumPenetration", num_vertices), overlap_ratio),
+                [polygons](int num_iterations) {
+                    for (int i = 0; i < num_iterations; ++i)
+                    {
+                        const auto index = 2 * (i % num_inputs);
+                        KeepResult((*polygons)[index]->FindMinimumPenetration((*polygons)[index + 1].get()));
+                    }
+                }});
+        }
+    }
+}
+
+void AddCollisionBenchmarks(std::vector<MicroBenchmark>& benchmarks)
+{
+    for (const auto overlap_ratio : overlap_ratios)
+    {
+        auto random = InputRandom(200);
+        auto circles = std::make_shared<std::vector<std::shared_ptr<Circle>>>();
+        for (int i = 0; i < num_inputs; ++i)
+        {
+            auto circle1 = std::make_shared<Circle>(random.Range(5.0f, 50.0f));
+            auto circle2 = std::make_shared<Circle>(random.Range(5.0f, 50.0f));
+            PlacePair(*circle1, *circle2, overlap_ratio, random);
+            circles->push_back(std::move(circle1));
+            circles->push_back(std::move(circle2));
+        }
+
+        benchmarks.push_back({OverlapName("Circle vs Circle", overlap_ratio), [circles](int num_iterations) {
+            for (int i = 0; i < num_iterations; ++i)
+            {
+                const auto index = 2 * (i % num_inputs);
+                KeepResult((*circles)[index]->CheckCollision((*circles)[index + 1].get()));
+            }
+        }});
+    }
+
+    for (const auto num_vertices : vertex_counts)
+    {
+        for (const auto overlap_ratio : overlap_ratios)
+        {
+            auto random = InputRandom(300 + num_vertices);
+            auto colliders = std::make_shared<std::vector<std::shared_ptr<ICollider>>>();
+            for (int i = 0; i < num_inputs; ++i)
+            {
+                auto circle = std::make_shared<Circle>(random.Range(5.0f, 50.0f));
+                auto polygon = CreateRegularPolygon(num_vertices, random.Range(5.0f, 50.0f), random);
+                PlacePair(*circle, *polygon, overlap_ratio, random);
+                colliders->push_back(std::move(circle));
+                colliders->push_back(std::move(polygon));
+            }
+
+            benchmarks.push_back({OverlapName(ParameterName("Circle vs ConvexPolygon", num_vertices), overlap_ratio),
+                [colliders](int num_iterations) {
+                    for (int i = 0; i < num_iterations; ++i)
+                    {
+                        const auto index = 2 * (i % num_inputs);
+                        KeepResult((*colliders)[index]->CheckCollision((*colliders)[index + 1].get()));
+                    }
+                }});
+        }
+    }
+}
+
+std::vector<MicroBenchmark> CreateBenchmarks()
+{
+    auto benchmarks = std::vector<MicroBenchmark>();
+    AddVec3Benchmarks(benchmarks);
+    AddTransformBenchmarks(benchmarks);
+    AddLineSegmentBenchmarks(benchmarks);
+    AddPolygonBenchmarks(benchmarks);
+    AddCollisionBenchmarks(benchmarks);
+    return benchmarks;
+}
+
+struct MicroBenchOptions
+{
+    std::string filter;
+    int min_time_ms = 100;
+    int num_repetitions = 5;
+};
+
+void PrintUsage()
+{
+    std::cout <<
+        "Usage: physics_microbench [options]\n"
+        "\n"
+        "Times the math and narrowphase kernels in isolation, on seeded random inputs.\n"
+        "Names are function/vertex count/overlap, where overlap is how deep the bounding circles\n"
+        "of a pair overlap as a fraction of the sum of their radii.\n"
+        "\n"
+        "Options:\n"
+        "  --filter TEXT      Only run the benchmarks whose name contains TEXT.\n"
+        "  --min-time MS      Run each repetition for at least this long. (default: 100)\n"
+        "  --repetitions N    Repetitions of each benchmark, whose median is reported. (default: 5)\n"
+        "  --list             Print the names of the benchmarks and exit.\n"
+        "  --help             Show this message.\n";
+}
+
+bool ParseInt(std::string_view text, int min, int& value)
+{
+    const auto end = text.data() + text.size();
+    const auto [ptr, error] = std::from_chars(text.data(), end, value);
+    return error == std::errc() && ptr == end && value >= min;
+}
+
+/**
+ * @return Nanoseconds per iteration of every repetition.
+ */
+std::vector<double> Measure(const MicroBenchmark& benchmark, const MicroBenchOptions& options, std::int64_t& num_iterations)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto min_time = std::chrono::milliseconds(options.min_time_ms);
+
+    const auto time = [&benchmark](std::int64_t iterations) {
+        const auto start = Clock::now();
+        benchmark.run(static_cast<int>(iterations));
+        return Clock::now() - start;
+    };
+
+    // Grow the iterations until a run is long enough to hide the resolution of the clock.
+    // This also warms up the caches and the branch predictor.
+    num_iterations = 1;
+    while (num_iterations < (1 << 30))
+    {
+        const auto elapsed = time(num_iterations);
+        if (elapsed >= min_time)
+        {
+            break;
+        }
+        const auto scale = elapsed.count() > 0 ? 1.4 * min_time / elapsed : 10.0;
+        num_iterations = std::max(num_iterations + 1, static_cast<std::int64_t>(num_iterations * std::min(scale, 10.0)));
+        num_iterations = std::min<std::int64_t>(num_iterations, 1 << 30);
+    }
+
+    auto results = std::vector<double>();
+    for (int repetition = 0; repetition < options.num_repetitions; ++repetition)
+    {
+        const auto elapsed = time(num_iterations);
+        results.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / num_iterations);
+    }
+    return results;
+}
+
+int main(int argc, char** argv)
+{
+    auto options = MicroBenchOptions();
+    auto list_only = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto arg = std::string_view(argv[i]);
+        if (arg == "--help" || arg == "-h")
+        {
+            PrintUsage();
+            return 0;
+        }
+        if (arg == "--list")
+        {
+            list_only = true;
+            continue;
+        }
+        if (arg != "--filter" && arg != "--min-time" && arg != "--repetitions")
+        {
+            std::cerr << "unknown option: " << arg << "\nrun with --help to see the options\n";
+            return 2;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "missing value of " << arg << "\n";
+            return 2;
+        }
+
+        const auto value = std::string_view(argv[++i]);
+        if (arg == "--filter")
+        {
+            options.filter = value;
+        }
+        else if (!ParseInt(value, 1, arg == "--min-time" ? options.min_time_ms : options.num_repetitions))
+        {
+            std::cerr << "invalid value of " << arg << ": " << value << "\n";
+            return 2;
+        }
+    }
+
+    auto benchmarks = CreateBenchmarks();
+    std::erase_if(benchmarks, [&options](const MicroBenchmark& benchmark) {
+        return benchmark.name.find(options.filter) == std::string::npos;
+    });
+    if (benchmarks.empty())
+    {
+        std::cerr << "no benchmark matches " << options.filter << "\n";
+        return 2;
+    }
+
+    if (list_only)
+    {
+        for (const auto& benchmark : benchmarks)
+        {
+            std::cout << benchmark.name << "\n";
+        }
+        return 0;
+    }
+
+    std::printf("%-48s %12s %12s %12s %14s\n", "benchmark", "median ns", "min ns", "max ns", "iterations");
+    for (const auto& benchmark : benchmarks)
+    {
+        auto num_iterations = std::int64_t();
+        auto results = Measure(benchmark, options, num_iterations);
+        std::sort(results.begin(), results.end());
+        std::printf("%-48s %12.2f %12.2f %12.2f %14lld\n",
+            benchmark.name.c_str(),
+            results[results.size() / 2],
+            results.front(),
+            results.back(),
+            static_cast<long long>(num_iterations));
+        std::fflush(stdout);
+    }
+    return 0;
+}